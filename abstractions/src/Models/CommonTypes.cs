@@ -30,7 +30,20 @@ public enum ChecksumAlgorithm
     ///     SHA256.
     /// </summary>
     [EnumMember(Value = nameof(SHA256))]
-    SHA256
+    SHA256,
+
+    /// <summary>
+    ///     BLAKE3 (256-bit output). Hashed multithreaded on large files.
+    /// </summary>
+    [EnumMember(Value = nameof(BLAKE3))]
+    BLAKE3,
+
+    /// <summary>
+    ///     XXH3 (128-bit, canonical form as printed by <c>xxhsum -H2</c>). Not a cryptographic hash, only allowed for
+    ///     <see cref="UpdateRelease.DetectionChecksum" /> and rejected as a download checksum.
+    /// </summary>
+    [EnumMember(Value = nameof(XXH3_128))]
+    XXH3_128
 }
 
 /// <summary>
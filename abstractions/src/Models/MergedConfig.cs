@@ -114,4 +114,25 @@ public sealed class MergedConfig
     ///     as fallback.
     /// </remarks>
     public string? IconBase64 { get; set; }
+
+    /// <summary>
+    ///     Download rate limit in bytes per second applied to unattended (background or silent) runs.
+    ///     Zero means unlimited. Default: 0.
+    /// </summary>
+    [Required]
+    public long BackgroundDownloadRateLimit { get; set; } = 0;
+
+    /// <summary>
+    ///     When true, the rate limited background download additionally backs off while the
+    ///     connection's round-trip time indicates congestion. Default: false.
+    /// </summary>
+    [Required]
+    public bool BackgroundDownloadAdaptive { get; set; } = false;
+
+    /// <summary>
+    ///     When true, unattended (background or autostart) runs download and verify the release before
+    ///     the user is prompted, so confirming the update starts the setup right away. Default: false.
+    /// </summary>
+    [Required]
+    public bool PrefetchRelease { get; set; } = false;
 }
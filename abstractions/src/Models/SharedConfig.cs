@@ -109,4 +109,29 @@ public sealed class SharedConfig
     ///     if the field is absent or the data cannot be decoded.
     /// </remarks>
     public string? IconBase64 { get; set; }
+
+    /// <summary>
+    ///     Download rate limit in bytes per second applied to unattended (background or silent) runs.
+    /// </summary>
+    /// <remarks>
+    ///     Zero or absent means unlimited. Interactive downloads are never throttled. The
+    ///     --background-rate-limit command line argument takes precedence.
+    /// </remarks>
+    public long? BackgroundDownloadRateLimit { get; set; }
+
+    /// <summary>
+    ///     When true, the rate limited background download additionally backs off while the
+    ///     connection's round-trip time indicates congestion.
+    /// </summary>
+    public bool? BackgroundDownloadAdaptive { get; set; }
+
+    /// <summary>
+    ///     When true, unattended (background or autostart) runs download and verify the release before
+    ///     the user is prompted, so confirming the update starts the setup right away.
+    /// </summary>
+    /// <remarks>
+    ///     The download is subject to <see cref="BackgroundDownloadRateLimit" />. The --prefetch command
+    ///     line argument enables it as well.
+    /// </remarks>
+    public bool? PrefetchRelease { get; set; }
 }
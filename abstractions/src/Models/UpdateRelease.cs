@@ -45,6 +45,58 @@ public sealed class ChecksumParameters
     /// </summary>
     [Required]
     public required ChecksumAlgorithm ChecksumAlg { get; set; }
+
+    /// <summary>
+    ///     Optional size (in bytes) of the chunks listed in <see cref="ChunkHashes" />.
+    /// </summary>
+    public long? ChunkSize { get; set; }
+
+    /// <summary>
+    ///     Optional digests of the consecutive <see cref="ChunkSize" /> sized chunks of the file, calculated with
+    ///     <see cref="ChecksumAlg" />; the last chunk may be shorter.
+    /// </summary>
+    /// <remarks>
+    ///     If set, downloads are verified chunk by chunk, so a corrupt chunk in a partial download is fetched again
+    ///     on its own instead of failing the whole file after the fact.
+    /// </remarks>
+    public List<string>? ChunkHashes { get; set; }
+}
+
+/// <summary>
+///     A binary delta that reconstructs the setup of an <see cref="UpdateRelease" /> from the installed product file.
+/// </summary>
+/// <remarks>
+///     The patch is created with <c>zstd --patch-from=&lt;installed file&gt; &lt;new setup&gt;</c>. The installed file is
+///     the one referenced by the <see cref="ProductVersionDetectionMethod.FileVersion" />,
+///     <see cref="ProductVersionDetectionMethod.FileSize" /> or <see cref="ProductVersionDetectionMethod.FileChecksum" />
+///     detection. The reconstructed file must match <see cref="UpdateRelease.Checksum" />, otherwise the client falls
+///     back to <see cref="UpdateRelease.DownloadUrl" />.
+/// </remarks>
+[SuppressMessage("ReSharper", "ClassNeverInstantiated.Global")]
+[SuppressMessage("ReSharper", "UnusedAutoPropertyAccessor.Global")]
+[SuppressMessage("ReSharper", "UnusedMember.Global")]
+public sealed class ReleasePatch
+{
+    /// <summary>
+    ///     The patch download URL.
+    /// </summary>
+    [Required]
+    public required string DownloadUrl { get; set; } = null!;
+
+    /// <summary>
+    ///     Optional size (in bytes) of the patch.
+    /// </summary>
+    public long? DownloadSize { get; set; }
+
+    /// <summary>
+    ///     The installed file version this patch applies to.
+    /// </summary>
+    public Version? DetectionVersion { get; set; }
+
+    /// <summary>
+    ///     The installed file hash this patch applies to. Takes precedence over <see cref="DetectionVersion" />.
+    /// </summary>
+    public ChecksumParameters? DetectionChecksum { get; set; }
 }
 
 /// <summary>
@@ -176,4 +228,12 @@ public sealed class UpdateRelease
     ///     to prevent a compromised server from triggering an unauthenticated UAC prompt.
     /// </remarks>
     public bool? RunAsAdmin { get; set; }
+
+    /// <summary>
+    ///     Optional binary deltas the client tries before downloading <see cref="DownloadUrl" />.
+    /// </summary>
+    /// <remarks>
+    ///     Ignored unless <see cref="Checksum" /> is set, since it is needed to verify the reconstructed setup.
+    /// </remarks>
+    public List<ReleasePatch>? Patches { get; set; }
 }
@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "BlockWriter.h"
+#include "Payload.h"
+
+#include <curl/curl.h>
+#include <benchmark/benchmark.h>
+
+//
+// Sustained download throughput from a loopback HTTP server, written to disk the way
+// DownloadRelease used to (every piece curl delivers straight into an ofstream) and through
+// BlockWriter with the final size reserved up front. The server streams from memory, so the
+// storage under --payload_dir is what's compared.
+//
+
+// the server uses Linux socket flags
+#if defined(__linux__)
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Size of the body piece the server sends over and over */
+    constexpr size_t SERVER_CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * \brief A loopback HTTP server answering every request with a body of a fixed size.
+     */
+    class StreamingServer
+    {
+        int listener{-1};
+        uint16_t port{0};
+        uint64_t bodySize;
+        std::string chunk;
+        std::jthread worker{};
+
+        static bool SendAll(const int connection, const char* data, size_t length)
+        {
+            while (length > 0)
+            {
+                const ssize_t sent = send(connection, data, length, MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (sent <= 0)
+                {
+                    return false;
+                }
+                data += sent;
+                length -= static_cast<size_t>(sent);
+            }
+
+            return true;
+        }
+
+        void Serve(const int connection) const
+        {
+            // a curl GET fits into one segment, and its content doesn't matter
+            char request[ 4096 ];
+            (void)recv(connection, request, sizeof(request), 0);
+
+            const std::string header = std::format("HTTP/1.1 200 OK\r\n"
+                                                   "Content-Type: application/octet-stream\r\n"
+                                                   "Content-Length: {}\r\n"
+                                                   "Connection: close\r\n\r\n", bodySize);
+            if (!SendAll(connection, header.data(), header.size()))
+            {
+                return;
+            }
+
+            for (uint64_t sent = 0; sent < bodySize;)
+            {
+                const auto length = static_cast<size_t>(std::min<uint64_t>(chunk.size(), bodySize - sent));
+                if (!SendAll(connection, chunk.data(), length))
+                {
+                    return;
+                }
+                sent += length;
+            }
+        }
+
+    public:
+        explicit StreamingServer(const uint64_t bodySize)
+            : bodySize(bodySize), chunk(bench::MakePayload(SERVER_CHUNK_SIZE))
+        {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+
+            if (listener < 0 ||
+                bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                listen(listener, SOMAXCONN) != 0 ||
+                getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                throw std::runtime_error("Failed to set up the loopback listener");
+            }
+            port = ntohs(address.sin_port);
+
+            worker = std::jthread([this](const std::stop_token& stopToken)
+            {
+                pollfd pending{listener, POLLIN, 0};
+                while (!stopToken.stop_requested())
+                {
+                    if (poll(&pending, 1, 50) > 0)
+                    {
+                        // one download at a time, like the updater
+                        if (const int connection = accept(listener, nullptr, nullptr); connection >= 0)
+                        {
+                            Serve(connection);
+                            close(connection);
+                        }
+                    }
+                }
+            });
+        }
+
+        StreamingServer(const StreamingServer&) = delete;
+        StreamingServer& operator=(const StreamingServer&) = delete;
+
+        ~StreamingServer()
+        {
+            worker.request_stop();
+            worker.join();
+            close(listener);
+        }
+
+        [[nodiscard]] std::string GetUrl() const { return std::format("http://127.0.0.1:{}/setup.exe", port); }
+    };
+
+    /**
+     * \brief How DownloadRelease wrote before BlockWriter: each piece goes to an ofstream as it arrives.
+     */
+    class StreamSink
+    {
+        std::ofstream file;
+
+    public:
+        bool Open(const std::filesystem::path& path, uint64_t)
+        {
+            file.open(path, std::ios::binary | std::ios::trunc);
+            return file.is_open();
+        }
+
+        bool Write(const char* data, const size_t length)
+        {
+            file.write(data, static_cast<std::streamsize>(length));
+            return file.good();
+        }
+
+        bool Close()
+        {
+            file.close();
+            return !file.fail();
+        }
+    };
+
+    /**
+     * \brief How DownloadRelease writes now, with the size known from the manifest or Content-Length.
+     */
+    class BlockWriterSink
+    {
+        io::BlockWriter writer;
+
+    public:
+        bool Open(const std::filesystem::path& path, const uint64_t size)
+        {
+            if (!writer.Open(path, false))
+            {
+                return false;
+            }
+            writer.Reserve(size);
+            return true;
+        }
+
+        bool Write(const char* data, const size_t length)
+        {
+            return writer.Write(data, length);
+        }
+
+        bool Close()
+        {
+            return writer.Close().has_value();
+        }
+    };
+
+    template <typename Sink>
+    size_t WriteToSink(char* data, const size_t size, const size_t count, void* userData)
+    {
+        return static_cast<Sink*>(userData)->Write(data, size * count) ? size * count : 0;
+    }
+
+    template <typename Sink>
+    bool Download(const std::string& url, Sink& sink)
+    {
+        CURL* handle = curl_easy_init();
+        if (handle == nullptr)
+        {
+            return false;
+        }
+        const auto handleGuard = sg::make_scope_guard([handle]() noexcept { curl_easy_cleanup(handle); });
+
+        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteToSink<Sink>);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &sink);
+
+        return curl_easy_perform(handle) == CURLE_OK;
+    }
+
+    template <typename Sink>
+    void BM_Download(benchmark::State& state)
+    {
+        const auto size = static_cast<uint64_t>(state.range(0));
+        const StreamingServer server(size);
+        const auto path = bench::GetPayloadDirectory() / "download.bin";
+        std::error_code ec;
+
+        for (auto _ : state)
+        {
+            Sink sink;
+            const bool downloaded = sink.Open(path, size) && Download(server.GetUrl(), sink);
+
+            if (!sink.Close() || !downloaded || std::filesystem::file_size(path, ec) != size)
+            {
+                state.SkipWithError("Download failed");
+                break;
+            }
+        }
+
+        std::filesystem::remove(path, ec);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+
+    void DownloadSizes(benchmark::internal::Benchmark* b)
+    {
+        b->RangeMultiplier(bench::SIZE_MULTIPLIER)
+         ->Range(bench::MAX_MEMORY_SIZE, bench::MAX_FILE_SIZE)
+         ->Unit(benchmark::kMillisecond)
+         ->UseRealTime();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Download, StreamSink)->Apply(DownloadSizes);
+BENCHMARK_TEMPLATE(BM_Download, BlockWriterSink)->Apply(DownloadSizes);
+
+#endif
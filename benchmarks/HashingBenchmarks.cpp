@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "Hashing.h"
+#include "Payload.h"
+
+#include <benchmark/benchmark.h>
+
+//
+// File checksums as computed for release verification, detection and patch selection,
+// and the building blocks they are made of
+//
+
+namespace
+{
+    void FileSizes(benchmark::internal::Benchmark* b)
+    {
+        b->RangeMultiplier(bench::SIZE_MULTIPLIER)
+         ->Range(bench::MIN_FILE_SIZE, bench::MAX_FILE_SIZE)
+         ->Unit(benchmark::kMillisecond)
+         ->UseRealTime();
+    }
+
+    void MemorySizes(benchmark::internal::Benchmark* b)
+    {
+        b->RangeMultiplier(bench::SIZE_MULTIPLIER)
+         ->Range(bench::MIN_FILE_SIZE, bench::MAX_MEMORY_SIZE)
+         ->Unit(benchmark::kMicrosecond);
+    }
+
+    /**
+     * \brief The way files used to be hashed before HashFile: 4 KiB ifstream reads, one digest per pass.
+     */
+    template <typename H>
+    std::optional<std::string> HashFileWithIfstream(const std::filesystem::path& filePath)
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return std::nullopt;
+        }
+
+        H alg;
+        std::vector<char> buffer(4096);
+
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+        {
+            alg.add(buffer.data(), static_cast<size_t>(file.gcount()));
+        }
+
+        return alg.getHash();
+    }
+
+    /**
+     * \brief HashFile with a fixed set of digests, e.g. the updater comparing its own copies.
+     */
+    template <typename... Hashes>
+    void BM_HashFile(benchmark::State& state)
+    {
+        const auto& path = bench::GetPayloadFile(state.range(0));
+
+        for (auto _ : state)
+        {
+            auto digests = hashing::HashFile<Hashes...>(path);
+            if (!digests.has_value())
+            {
+                state.SkipWithError(digests.error().c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(digests);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief HashFile with algorithms picked at runtime, the release and detection checksum path.
+     */
+    void BM_HashFileByAlgorithm(benchmark::State& state, const std::vector<models::ChecksumAlgorithm>& algorithms)
+    {
+        const auto& path = bench::GetPayloadFile(state.range(0));
+
+        for (auto _ : state)
+        {
+            auto digests = hashing::HashFile(path, algorithms);
+            if (!digests.has_value())
+            {
+                state.SkipWithError(digests.error().c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(digests);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief Baseline for BM_HashFile: the former 4 KiB read loop.
+     */
+    template <typename H>
+    void BM_HashFileWithIfstream(benchmark::State& state)
+    {
+        const auto& path = bench::GetPayloadFile(state.range(0));
+
+        for (auto _ : state)
+        {
+            auto digest = HashFileWithIfstream<H>(path);
+            if (!digest.has_value())
+            {
+                state.SkipWithError("Failed to open payload file");
+                break;
+            }
+            benchmark::DoNotOptimize(digest);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief Per-chunk verification of a complete download, as done before repairing it.
+     */
+    void BM_FindCorruptChunks(benchmark::State& state)
+    {
+        constexpr uint64_t chunkSize = 4 * 1024 * 1024;
+        const uint64_t size = static_cast<uint64_t>(state.range(0));
+        const auto& path = bench::GetPayloadFile(size);
+
+        // the expected digests are the file's own, so every chunk is read and matches
+        std::vector<std::string> digests{};
+        hashing::AcceleratedSHA256 chunk{};
+        uint64_t filled = 0;
+
+        const auto read = io::ReadSequential(path, 0, io::READ_TO_END,
+                                             [&](const uint8_t* data, size_t length)
+                                             {
+                                                 while (length > 0)
+                                                 {
+                                                     const size_t part = static_cast<size_t>(
+                                                         std::min<uint64_t>(length, chunkSize - filled));
+                                                     chunk.add(data, part);
+                                                     data += part;
+                                                     length -= part;
+                                                     filled += part;
+
+                                                     if (filled == chunkSize)
+                                                     {
+                                                         digests.push_back(chunk.getHash());
+                                                         chunk.reset();
+                                                         filled = 0;
+                                                     }
+                                                 }
+                                                 return true;
+                                             });
+        if (!read.has_value())
+        {
+            state.SkipWithError(read.error().c_str());
+            return;
+        }
+        if (filled > 0)
+        {
+            digests.push_back(chunk.getHash());
+        }
+
+        hashing::ChunkVerifier verifier(models::ChecksumAlgorithm::SHA256, chunkSize, digests);
+
+        for (auto _ : state)
+        {
+            auto corrupt = verifier.FindCorruptChunks(path, 0, size);
+            if (!corrupt.has_value())
+            {
+                state.SkipWithError(corrupt.error().c_str());
+                break;
+            }
+            if (!corrupt->empty())
+            {
+                state.SkipWithError("Intact payload reported as corrupt");
+                break;
+            }
+            benchmark::DoNotOptimize(corrupt);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief In-memory digests, compares the portable SHA code with the SHA extension backend.
+     */
+    template <typename H>
+    void BM_HashBuffer(benchmark::State& state)
+    {
+        const auto payload = bench::MakePayload(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            H alg;
+            alg.add(payload.data(), payload.size());
+            auto digest = alg.getHash();
+            benchmark::DoNotOptimize(digest);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief The cost of a resume journal checkpoint of the running download digest.
+     */
+    void BM_ExportImportState(benchmark::State& state, const models::ChecksumAlgorithm algorithm)
+    {
+        const auto payload = bench::MakePayload(1024 * 1024 + 13);
+
+        hashing::IncrementalHasher hasher(algorithm);
+        hasher.Add(payload.data(), payload.size());
+        const std::string digest = hasher.GetHash();
+
+        hashing::IncrementalHasher restored(algorithm);
+
+        for (auto _ : state)
+        {
+            const auto exported = hasher.ExportState();
+            if (!restored.ImportState(hasher.GetBytesHashed(), exported, digest))
+            {
+                state.SkipWithError("Exported state was rejected");
+                break;
+            }
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_HashFile, hashing::AcceleratedSHA256)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFile, hashing::AcceleratedSHA1)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFile, MD5)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFile, hashing::Blake3)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFile, hashing::Xxh3_128)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFile, hashing::AcceleratedSHA256, hashing::AcceleratedSHA1)->Apply(FileSizes);
+
+BENCHMARK_CAPTURE(BM_HashFileByAlgorithm, SHA256, {models::ChecksumAlgorithm::SHA256})->Apply(FileSizes);
+BENCHMARK_CAPTURE(BM_HashFileByAlgorithm, BLAKE3, {models::ChecksumAlgorithm::BLAKE3})->Apply(FileSizes);
+
+BENCHMARK_TEMPLATE(BM_HashFileWithIfstream, SHA256)->Apply(FileSizes);
+BENCHMARK_TEMPLATE(BM_HashFileWithIfstream, hashing::AcceleratedSHA256)->Apply(FileSizes);
+
+BENCHMARK(BM_FindCorruptChunks)->Apply(FileSizes);
+
+BENCHMARK_TEMPLATE(BM_HashBuffer, SHA256)->Apply(MemorySizes);
+BENCHMARK_TEMPLATE(BM_HashBuffer, hashing::AcceleratedSHA256)->Apply(MemorySizes);
+BENCHMARK_TEMPLATE(BM_HashBuffer, SHA1)->Apply(MemorySizes);
+BENCHMARK_TEMPLATE(BM_HashBuffer, hashing::AcceleratedSHA1)->Apply(MemorySizes);
+BENCHMARK_TEMPLATE(BM_HashBuffer, hashing::Blake3)->Apply(MemorySizes);
+
+BENCHMARK_CAPTURE(BM_ExportImportState, SHA256, models::ChecksumAlgorithm::SHA256);
+BENCHMARK_CAPTURE(BM_ExportImportState, BLAKE3, models::ChecksumAlgorithm::BLAKE3);
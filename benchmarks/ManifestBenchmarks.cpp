@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "ManifestParser.h"
+
+#include <benchmark/benchmark.h>
+
+//
+// Streaming manifest deserialization (SAX) against parsing a DOM first and converting it,
+// for every wire format the server may pick
+//
+
+namespace
+{
+    /**
+     * \brief Builds a manifest of the given number of releases shaped like real-world ones.
+     */
+    json MakeManifest(const int64_t releaseCount)
+    {
+        json releases = json::array();
+
+        for (int64_t i = 0; i < releaseCount; i++)
+        {
+            const std::string version = std::format("{}.{}.{}", i / 100, i / 10 % 10, i % 10);
+
+            std::string summary = std::format("# Release Notes {}\n\n", version);
+            for (int line = 0; line < 24; line++)
+            {
+                summary += std::format("- Fixed issue #{} affecting devices on resume from standby\n", i * 24 + line);
+            }
+
+            releases.push_back({
+                {"name", std::format("My Product {}", version)},
+                {"version", version},
+                {"summary", summary},
+                {"publishedAt", "2026-06-01T12:00:00Z"},
+                {"downloadUrl", std::format("https://updates.example.com/MyProduct/setup-{}.exe", version)},
+                {
+                    "checksum", {
+                        {"checksum", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+                        {"checksumAlg", "SHA256"}
+                    }
+                },
+                {"signatureStrategy", "FromConfiguration"},
+                {"signaturePolicy", "Strict"},
+                {
+                    "signature", {
+                        {"subjectName", "My Company, Inc."},
+                        {"issuerName", "DigiCert Trusted G4 Code Signing RSA4096 SHA384 2021 CA1"}
+                    }
+                },
+                {"exitCode", {{"successCodes", {0, 3010}}}},
+                {"disabled", i % 16 == 15},
+            });
+        }
+
+        return {
+            {"instance", {{"latestVersion", "1.0.0"}}},
+            {"shared", {{"windowTitle", "My Product Updater"}, {"productName", "My Product"}}},
+            {"manifestVersion", 1},
+            {"releases", std::move(releases)},
+        };
+    }
+
+    std::string Encode(const json& manifest, const manifest::Format format)
+    {
+        std::vector<uint8_t> binary{};
+
+        switch (format)
+        {
+        case manifest::Format::Json:
+            return manifest.dump();
+        case manifest::Format::Cbor:
+            binary = json::to_cbor(manifest);
+            break;
+        case manifest::Format::MessagePack:
+            binary = json::to_msgpack(manifest);
+            break;
+        }
+
+        return {binary.begin(), binary.end()};
+    }
+
+    void ReleaseCounts(benchmark::internal::Benchmark* b)
+    {
+        b->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond);
+    }
+
+    void BM_ParseManifestSax(benchmark::State& state, const manifest::Format format)
+    {
+        const std::string body = Encode(MakeManifest(state.range(0)), format);
+
+        for (auto _ : state)
+        {
+            json remainder;
+            auto response = manifest::ParseUpdateResponse(body, format, remainder);
+            benchmark::DoNotOptimize(response);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+    }
+
+    /**
+     * \brief The former path: a DOM of the whole document, converted into the models afterwards.
+     */
+    void BM_ParseManifestDom(benchmark::State& state, const manifest::Format format)
+    {
+        const std::string body = Encode(MakeManifest(state.range(0)), format);
+
+        for (auto _ : state)
+        {
+            json document;
+            switch (format)
+            {
+            case manifest::Format::Json:
+                document = json::parse(body);
+                break;
+            case manifest::Format::Cbor:
+                document = json::from_cbor(body);
+                break;
+            case manifest::Format::MessagePack:
+                document = json::from_msgpack(body);
+                break;
+            }
+
+            auto response = document.get<models::UpdateResponse>();
+            benchmark::DoNotOptimize(response);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * body.size()));
+    }
+}
+
+BENCHMARK_CAPTURE(BM_ParseManifestSax, Json, manifest::Format::Json)->Apply(ReleaseCounts);
+BENCHMARK_CAPTURE(BM_ParseManifestDom, Json, manifest::Format::Json)->Apply(ReleaseCounts);
+BENCHMARK_CAPTURE(BM_ParseManifestSax, Cbor, manifest::Format::Cbor)->Apply(ReleaseCounts);
+BENCHMARK_CAPTURE(BM_ParseManifestDom, Cbor, manifest::Format::Cbor)->Apply(ReleaseCounts);
+BENCHMARK_CAPTURE(BM_ParseManifestSax, MessagePack, manifest::Format::MessagePack)->Apply(ReleaseCounts);
+BENCHMARK_CAPTURE(BM_ParseManifestDom, MessagePack, manifest::Format::MessagePack)->Apply(ReleaseCounts);
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "Payload.h"
+
+#include <map>
+#include <ranges>
+
+
+namespace
+{
+    std::filesystem::path payloadDirectory{};
+    std::map<uint64_t, std::filesystem::path> payloadFiles{};
+
+    /**
+     * \brief Produces the payload stream in arbitrary pieces, so a file written block by block
+     *        holds exactly the bytes of MakePayload.
+     */
+    class PayloadGenerator
+    {
+        // mt19937_64 output is fully specified by the standard, unlike the distributions
+        std::mt19937_64 eng;
+
+    public:
+        explicit PayloadGenerator(const uint64_t seed) : eng(seed) { }
+
+        void Fill(uint8_t* data, const size_t length)
+        {
+            for (size_t offset = 0; offset < length; offset += sizeof(uint64_t))
+            {
+                const uint64_t value = eng();
+                // little-endian byte order regardless of the host
+                for (size_t i = 0; i < sizeof(uint64_t) && offset + i < length; i++)
+                {
+                    data[ offset + i ] = static_cast<uint8_t>(value >> (8 * i));
+                }
+            }
+        }
+    };
+}
+
+void bench::SetPayloadDirectory(const std::filesystem::path& directory)
+{
+    payloadDirectory = directory;
+}
+
+std::filesystem::path bench::GetPayloadDirectory()
+{
+    const auto directory = payloadDirectory.empty()
+                               ? std::filesystem::temp_directory_path() / "vicius-benchmarks"
+                               : payloadDirectory;
+    std::filesystem::create_directories(directory);
+
+    return directory;
+}
+
+std::string bench::MakePayload(const size_t size, const uint64_t seed)
+{
+    std::string payload(size, '\0');
+    PayloadGenerator(seed).Fill(reinterpret_cast<uint8_t*>(payload.data()), payload.size());
+    return payload;
+}
+
+const std::filesystem::path& bench::GetPayloadFile(const uint64_t size)
+{
+    if (const auto existing = payloadFiles.find(size); existing != payloadFiles.end())
+    {
+        return existing->second;
+    }
+
+    const auto path = GetPayloadDirectory() / std::format("payload-{}.bin", size);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error(std::format("Failed to create {}", path.string()));
+        }
+
+        // a multiple of 8, so the pieces line up with the generator's words
+        constexpr size_t blockSize = 4 * 1024 * 1024;
+        std::vector<uint8_t> block(blockSize);
+        PayloadGenerator generator(PAYLOAD_SEED);
+
+        for (uint64_t written = 0; written < size;)
+        {
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(blockSize, size - written));
+            generator.Fill(block.data(), length);
+            file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(length));
+            written += length;
+        }
+
+        if (!file)
+        {
+            throw std::runtime_error(std::format("Failed to write {}", path.string()));
+        }
+    }
+
+    return payloadFiles.emplace(size, path).first->second;
+}
+
+void bench::RemovePayloadFiles()
+{
+    std::error_code ec;
+    for (const auto& path : payloadFiles | std::views::values)
+    {
+        std::filesystem::remove(path, ec);
+    }
+    payloadFiles.clear();
+}
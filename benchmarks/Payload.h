@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+
+namespace bench
+{
+    /** Seed of all generated payloads, fixed so every run processes the very same bytes */
+    constexpr uint64_t PAYLOAD_SEED = 0x5669636975730001;
+
+    /** Smallest file size the file benchmarks run with */
+    constexpr int64_t MIN_FILE_SIZE = 4 * 1024; // 4 KiB
+
+    /** Largest file size the file benchmarks run with */
+    constexpr int64_t MAX_FILE_SIZE = 2LL * 1024 * 1024 * 1024; // 2 GiB
+
+    /** Largest buffer the in-memory benchmarks run with */
+    constexpr int64_t MAX_MEMORY_SIZE = 64 * 1024 * 1024; // 64 MiB
+
+    /** Step between two benchmarked sizes */
+    constexpr int SIZE_MULTIPLIER = 8;
+
+    /**
+     * \brief Sets the directory payload files are created in, the system temp directory by default.
+     * \remarks Point it at the storage of interest; a tmpfs measures memory rather than disk speed.
+     */
+    void SetPayloadDirectory(const std::filesystem::path& directory);
+
+    /**
+     * \brief Gets the directory payload files are created in, creating it if necessary.
+     */
+    std::filesystem::path GetPayloadDirectory();
+
+    /**
+     * \brief Generates size pseudo-random bytes, identical for the same size and seed on every platform.
+     */
+    std::string MakePayload(size_t size, uint64_t seed = PAYLOAD_SEED);
+
+    /**
+     * \brief Gets a file holding MakePayload(size), created on first use.
+     * \throws std::runtime_error if the file couldn't be written.
+     */
+    const std::filesystem::path& GetPayloadFile(uint64_t size);
+
+    /**
+     * \brief Deletes every payload file created so far.
+     */
+    void RemovePayloadFiles();
+}
@@ -0,0 +1,145 @@
+#include "pch.h"
+#include "Retry.h"
+
+#include <benchmark/benchmark.h>
+
+//
+// Retry schedules run in virtual time, so a schedule spanning minutes takes microseconds
+// and its outcome is checked for being identical on every run
+//
+
+namespace
+{
+    /**
+     * \brief A clock that only advances when slept on.
+     */
+    class VirtualClock final : public retry::Clock
+    {
+        std::chrono::steady_clock::time_point now{};
+
+    public:
+        [[nodiscard]] std::chrono::steady_clock::time_point Now() const override { return now; }
+
+        [[nodiscard]] std::chrono::system_clock::time_point WallNow() const override
+        {
+            // a fixed date so absolute Retry-After values resolve the same way every run
+            return std::chrono::sys_days{std::chrono::year{2026} / 6 / 1} +
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(now.time_since_epoch());
+        }
+
+        bool SleepFor(const std::chrono::milliseconds duration, const std::stop_token& stopToken) override
+        {
+            if (stopToken.stop_requested())
+            {
+                return false;
+            }
+            now += duration;
+            return true;
+        }
+
+        [[nodiscard]] std::chrono::milliseconds Elapsed() const
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
+        }
+    };
+
+    /**
+     * \brief A server that keeps failing in every way the policy distinguishes.
+     */
+    retry::Failure FailureOfAttempt(const int attempt)
+    {
+        switch (attempt % 4)
+        {
+        case 0:
+            return {503, false, "2"};
+        case 1:
+            return {0, true, {}};
+        case 2:
+            return {429, false, "Mon, 01 Jun 2026 00:00:05 GMT"};
+        default:
+            return {0, false, {}};
+        }
+    }
+
+    /**
+     * \brief Runs a schedule until the policy gives up.
+     * \return The virtual time it took.
+     */
+    std::chrono::milliseconds RunSchedule(const retry::RetryOptions& options, int& attempts)
+    {
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+
+        attempts = 1;
+        while (const auto delay = policy.NextDelay(FailureOfAttempt(attempts)))
+        {
+            if (!policy.Sleep(delay.value()))
+            {
+                break;
+            }
+            attempts++;
+        }
+
+        return clock.Elapsed();
+    }
+
+    void BM_RetrySchedule(benchmark::State& state, const retry::RetryOptions& options)
+    {
+        int expectedAttempts = 0;
+        const auto expectedElapsed = RunSchedule(options, expectedAttempts);
+
+        for (auto _ : state)
+        {
+            int attempts = 0;
+            const auto elapsed = RunSchedule(options, attempts);
+
+            if (elapsed != expectedElapsed || attempts != expectedAttempts)
+            {
+                state.SkipWithError("Seeded schedule isn't reproducible");
+                break;
+            }
+            if (options.budget.count() > 0 && elapsed >= options.budget)
+            {
+                state.SkipWithError("Schedule exceeded its budget");
+                break;
+            }
+        }
+
+        state.counters[ "attempts" ] = expectedAttempts;
+        state.counters[ "virtual_s" ] = std::chrono::duration<double>(expectedElapsed).count();
+    }
+
+    void BM_ParseRetryAfter(benchmark::State& state, const std::string& value)
+    {
+        const auto now = std::chrono::sys_days{std::chrono::year{2026} / 6 / 1};
+
+        for (auto _ : state)
+        {
+            auto delay = retry::ParseRetryAfter(value, now);
+            benchmark::DoNotOptimize(delay);
+        }
+    }
+
+    retry::RetryOptions ManifestOptions()
+    {
+        retry::RetryOptions options{};
+        options.maxAttempts = 5;
+        options.budget = std::chrono::minutes{10};
+        options.seed = 1;
+        return options;
+    }
+
+    retry::RetryOptions DownloadOptions()
+    {
+        retry::RetryOptions options{};
+        options.maxAttempts = 10;
+        options.seed = 1;
+        return options;
+    }
+}
+
+BENCHMARK_CAPTURE(BM_RetrySchedule, Manifest, ManifestOptions());
+BENCHMARK_CAPTURE(BM_RetrySchedule, Download, DownloadOptions());
+
+BENCHMARK_CAPTURE(BM_ParseRetryAfter, Seconds, std::string("120"));
+BENCHMARK_CAPTURE(BM_ParseRetryAfter, HttpDate, std::string("Mon, 01 Jun 2026 00:02:00 GMT"));
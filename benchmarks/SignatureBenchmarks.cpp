@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "Minisign.h"
+#include "Util.h"
+#include "Payload.h"
+
+#include <benchmark/benchmark.h>
+
+//
+// Manifest signature verification in both minisign formats and the base64 decoding used
+// for embedded data. Keys and signatures are derived from a fixed seed, so every run
+// verifies the very same documents.
+//
+
+namespace
+{
+    constexpr uint8_t KEY_ID[ 8 ] = {0x56, 0x69, 0x63, 0x69, 0x75, 0x73, 0x00, 0x01};
+
+    std::string ToBase64(const void* data, const size_t length)
+    {
+        std::string encoded(sodium_base64_ENCODED_LEN(length, sodium_base64_VARIANT_ORIGINAL), '\0');
+        sodium_bin2base64(encoded.data(), encoded.size(), static_cast<const unsigned char*>(data), length,
+                          sodium_base64_VARIANT_ORIGINAL);
+        encoded.resize(encoded.size() - 1); // terminator
+        return encoded;
+    }
+
+    /**
+     * \brief A minisign key pair and what `minisign -S` (or `-S -l` for legacy) would produce with it.
+     */
+    class Signer
+    {
+        unsigned char publicKey[ crypto_sign_PUBLICKEYBYTES ]{};
+        unsigned char secretKey[ crypto_sign_SECRETKEYBYTES ]{};
+
+    public:
+        Signer()
+        {
+            if (sodium_init() < 0)
+            {
+                throw std::runtime_error("Failed to initialize libsodium");
+            }
+
+            unsigned char seed[ crypto_sign_SEEDBYTES ];
+            for (size_t i = 0; i < sizeof(seed); i++)
+            {
+                seed[ i ] = static_cast<unsigned char>(i);
+            }
+            crypto_sign_seed_keypair(publicKey, secretKey, seed);
+        }
+
+        /** The second line of the .pub file */
+        [[nodiscard]] std::string GetPublicKey() const
+        {
+            std::vector<unsigned char> raw{'E', 'd'};
+            raw.insert(raw.end(), std::begin(KEY_ID), std::end(KEY_ID));
+            raw.insert(raw.end(), std::begin(publicKey), std::end(publicKey));
+            return ToBase64(raw.data(), raw.size());
+        }
+
+        /** The complete .minisig of body */
+        [[nodiscard]] std::string Sign(const std::string& body, const bool prehashed) const
+        {
+            unsigned char signature[ crypto_sign_BYTES ];
+
+            if (prehashed)
+            {
+                unsigned char digest[ crypto_generichash_BYTES_MAX ];
+                crypto_generichash(digest, sizeof(digest), reinterpret_cast<const unsigned char*>(body.data()),
+                                   body.size(), nullptr, 0);
+                crypto_sign_detached(signature, nullptr, digest, sizeof(digest), secretKey);
+            }
+            else
+            {
+                crypto_sign_detached(signature, nullptr, reinterpret_cast<const unsigned char*>(body.data()),
+                                     body.size(), secretKey);
+            }
+
+            std::vector<unsigned char> line{'E', static_cast<unsigned char>(prehashed ? 'D' : 'd')};
+            line.insert(line.end(), std::begin(KEY_ID), std::end(KEY_ID));
+            line.insert(line.end(), std::begin(signature), std::end(signature));
+
+            // the global signature covers the file signature and the trusted comment
+            const std::string trustedComment = "timestamp:0\tfile:manifest.json";
+            std::vector<unsigned char> global(std::begin(signature), std::end(signature));
+            global.insert(global.end(), trustedComment.begin(), trustedComment.end());
+
+            unsigned char globalSignature[ crypto_sign_BYTES ];
+            crypto_sign_detached(globalSignature, nullptr, global.data(), global.size(), secretKey);
+
+            return std::format("untrusted comment: signature from minisign secret key\n{}\ntrusted comment: {}\n{}\n",
+                               ToBase64(line.data(), line.size()), trustedComment,
+                               ToBase64(globalSignature, sizeof(globalSignature)));
+        }
+    };
+
+    void ManifestSizes(benchmark::internal::Benchmark* b)
+    {
+        b->RangeMultiplier(bench::SIZE_MULTIPLIER)
+         ->Range(bench::MIN_FILE_SIZE, bench::MAX_MEMORY_SIZE)
+         ->Unit(benchmark::kMicrosecond);
+    }
+
+    void BM_VerifySignature(benchmark::State& state, const bool prehashed)
+    {
+        const Signer signer;
+        const std::string publicKey = signer.GetPublicKey();
+        const std::string body = bench::MakePayload(static_cast<size_t>(state.range(0)));
+        const std::string minisig = signer.Sign(body, prehashed);
+
+        for (auto _ : state)
+        {
+            const auto result = minisign::VerifySignature(body, minisig, publicKey.c_str());
+            if (!result.has_value())
+            {
+                state.SkipWithError(result.error().c_str());
+                break;
+            }
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    }
+
+    /**
+     * \brief Decodes the base64 form of range(0) bytes, optionally wrapped into lines like a PEM body.
+     */
+    void BM_DecodeBase64(benchmark::State& state, const bool wrapped)
+    {
+        const std::string payload = bench::MakePayload(static_cast<size_t>(state.range(0)));
+        std::string encoded = ToBase64(payload.data(), payload.size());
+
+        if (wrapped)
+        {
+            std::string lines;
+            for (size_t offset = 0; offset < encoded.size(); offset += 64)
+            {
+                lines += encoded.substr(offset, 64);
+                lines += "\r\n";
+            }
+            encoded = std::move(lines);
+        }
+
+        for (auto _ : state)
+        {
+            auto decoded = util::DecodeBase64(encoded);
+            if (!decoded.has_value())
+            {
+                state.SkipWithError(decoded.error().c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(decoded);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * encoded.size()));
+    }
+}
+
+BENCHMARK_CAPTURE(BM_VerifySignature, Prehashed, true)->Apply(ManifestSizes);
+BENCHMARK_CAPTURE(BM_VerifySignature, Legacy, false)->Apply(ManifestSizes);
+
+// the input may not exceed 1 MiB once encoded
+BENCHMARK_CAPTURE(BM_DecodeBase64, Plain, false)->RangeMultiplier(bench::SIZE_MULTIPLIER)
+                                                ->Range(bench::MIN_FILE_SIZE, 512 * 1024)
+                                                ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_DecodeBase64, Wrapped, true)->RangeMultiplier(bench::SIZE_MULTIPLIER)
+                                                 ->Range(bench::MIN_FILE_SIZE, 512 * 1024)
+                                                 ->Unit(benchmark::kMicrosecond);
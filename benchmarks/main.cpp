@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "HashAccel.h"
+#include "Payload.h"
+
+#include <curl/curl.h>
+#include <benchmark/benchmark.h>
+
+//
+// Micro-benchmarks of the portable core. Every input is generated from a fixed seed and the
+// active code paths are recorded in the report context, so two JSON reports
+// (--benchmark_out=<file> --benchmark_out_format=json) can be compared with the
+// tools/compare.py shipped with Google Benchmark.
+//
+// --payload_dir=<path> chooses where the payload files (up to 2 GiB) are created.
+//
+
+int main(int argc, char** argv)
+{
+    constexpr std::string_view payloadDirectoryArg = "--payload_dir=";
+
+    std::vector<char*> arguments{};
+    for (int i = 0; i < argc; i++)
+    {
+        if (const std::string_view arg = argv[ i ]; arg.starts_with(payloadDirectoryArg))
+        {
+            bench::SetPayloadDirectory(std::string(arg.substr(payloadDirectoryArg.size())));
+            continue;
+        }
+        arguments.push_back(argv[ i ]);
+    }
+    int argumentCount = static_cast<int>(arguments.size());
+
+    // the code under test logs as it would in the updater, which isn't what's measured
+    spdlog::set_level(spdlog::level::off);
+
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    benchmark::AddCustomContext("sha_backend", hashing::GetShaBackendName());
+#if defined(BLAKE3_USE_TBB)
+    benchmark::AddCustomContext("blake3_backend", "tbb");
+#else
+    benchmark::AddCustomContext("blake3_backend", "single-threaded");
+#endif
+    benchmark::AddCustomContext("payload_seed", std::format("{:#x}", bench::PAYLOAD_SEED));
+
+    benchmark::Initialize(&argumentCount, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(argumentCount, arguments.data()))
+    {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    bench::RemovePayloadFiles();
+    curl_global_cleanup();
+
+    return 0;
+}
@@ -23,13 +23,15 @@ static std::string ConvertWideToANSI(const std::wstring& wstr)
 // Checksum helpers (BCrypt-based, no external hash library dependency)
 // ============================================================================
 
-static std::expected<std::string, std::string> ComputeFileSHA256(const std::filesystem::path& filePath)
+// Streams a file through a BCrypt hash in large blocks; algorithmId is e.g. BCRYPT_SHA256_ALGORITHM
+static std::expected<std::string, std::string> ComputeFileDigest(const std::filesystem::path& filePath,
+                                                                 LPCWSTR algorithmId)
 {
     BCRYPT_ALG_HANDLE hAlg = nullptr;
     BCRYPT_HASH_HANDLE hHash = nullptr;
     std::vector<BYTE> hashObj, hashBuf;
 
-    if (BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_SHA256_ALGORITHM, nullptr, 0) != 0)
+    if (BCryptOpenAlgorithmProvider(&hAlg, algorithmId, nullptr, 0) != 0)
         return std::unexpected("BCryptOpenAlgorithmProvider failed");
 
     auto cleanAlg = [&]{ if (hAlg) { BCryptCloseAlgorithmProvider(hAlg, 0); hAlg = nullptr; } };
@@ -48,83 +50,25 @@ static std::expected<std::string, std::string> ComputeFileSHA256(const std::file
 
     auto cleanHash = [&]{ if (hHash) { BCryptDestroyHash(hHash); hHash = nullptr; } };
 
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) { cleanHash(); cleanAlg(); return std::unexpected(std::format("Failed to open '{}' for hashing", filePath.string())); }
+    // sequential scan lets the cache manager read ahead while the previous block is hashed
+    const HANDLE hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                     nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) { cleanHash(); cleanAlg(); return std::unexpected(std::format("Failed to open '{}' for hashing", filePath.string())); }
 
-    constexpr std::size_t chunkSize = 65536;
+    constexpr DWORD chunkSize = 1024 * 1024;
     std::vector<BYTE> buf(chunkSize);
     for (;;)
     {
-        file.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(chunkSize));
-        const std::streamsize n = file.gcount();
-        if (n > 0 && BCryptHashData(hHash, buf.data(), static_cast<ULONG>(n), 0) != 0)
-        { cleanHash(); cleanAlg(); return std::unexpected("BCryptHashData failed"); }
-        if (!file)
-        {
-            if (!file.eof()) { cleanHash(); cleanAlg(); return std::unexpected("I/O error reading file for hashing"); }
+        DWORD n = 0;
+        if (!ReadFile(hFile, buf.data(), chunkSize, &n, nullptr))
+        { CloseHandle(hFile); cleanHash(); cleanAlg(); return std::unexpected("I/O error reading file for hashing"); }
+        if (n == 0)
             break;
-        }
+        if (BCryptHashData(hHash, buf.data(), n, 0) != 0)
+        { CloseHandle(hFile); cleanHash(); cleanAlg(); return std::unexpected("BCryptHashData failed"); }
     }
 
-    if (BCryptFinishHash(hHash, hashBuf.data(), hashLen, 0) != 0)
-    { cleanHash(); cleanAlg(); return std::unexpected("BCryptFinishHash failed"); }
-
-    cleanHash();
-    cleanAlg();
-
-    std::string hex;
-    hex.reserve(hashLen * 2);
-    for (DWORD i = 0; i < hashLen; ++i)
-    {
-        char nibbles[3];
-        std::snprintf(nibbles, sizeof(nibbles), "%02x", hashBuf[i]);
-        hex += nibbles;
-    }
-    return hex;
-}
-
-static std::expected<std::string, std::string> ComputeFileSHA1(const std::filesystem::path& filePath)
-{
-    BCRYPT_ALG_HANDLE hAlg = nullptr;
-    BCRYPT_HASH_HANDLE hHash = nullptr;
-    std::vector<BYTE> hashObj, hashBuf;
-
-    if (BCryptOpenAlgorithmProvider(&hAlg, BCRYPT_SHA1_ALGORITHM, nullptr, 0) != 0)
-        return std::unexpected("BCryptOpenAlgorithmProvider failed");
-
-    auto cleanAlg = [&]{ if (hAlg) { BCryptCloseAlgorithmProvider(hAlg, 0); hAlg = nullptr; } };
-
-    DWORD objLen = 0, hashLen = 0, result = 0;
-    if (BCryptGetProperty(hAlg, BCRYPT_OBJECT_LENGTH, (PUCHAR)&objLen, sizeof(DWORD), &result, 0) != 0)
-    { cleanAlg(); return std::unexpected("BCryptGetProperty(OBJECT_LENGTH) failed"); }
-    if (BCryptGetProperty(hAlg, BCRYPT_HASH_LENGTH, (PUCHAR)&hashLen, sizeof(DWORD), &result, 0) != 0)
-    { cleanAlg(); return std::unexpected("BCryptGetProperty(HASH_LENGTH) failed"); }
-
-    hashObj.resize(objLen);
-    hashBuf.resize(hashLen);
-
-    if (BCryptCreateHash(hAlg, &hHash, hashObj.data(), objLen, nullptr, 0, 0) != 0)
-    { cleanAlg(); return std::unexpected("BCryptCreateHash failed"); }
-
-    auto cleanHash = [&]{ if (hHash) { BCryptDestroyHash(hHash); hHash = nullptr; } };
-
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open()) { cleanHash(); cleanAlg(); return std::unexpected(std::format("Failed to open '{}' for hashing", filePath.string())); }
-
-    constexpr std::size_t chunkSize = 65536;
-    std::vector<BYTE> buf(chunkSize);
-    for (;;)
-    {
-        file.read(reinterpret_cast<char*>(buf.data()), static_cast<std::streamsize>(chunkSize));
-        const std::streamsize n = file.gcount();
-        if (n > 0 && BCryptHashData(hHash, buf.data(), static_cast<ULONG>(n), 0) != 0)
-        { cleanHash(); cleanAlg(); return std::unexpected("BCryptHashData failed"); }
-        if (!file)
-        {
-            if (!file.eof()) { cleanHash(); cleanAlg(); return std::unexpected("I/O error reading file for hashing"); }
-            break;
-        }
-    }
+    CloseHandle(hFile);
 
     if (BCryptFinishHash(hHash, hashBuf.data(), hashLen, 0) != 0)
     { cleanHash(); cleanAlg(); return std::unexpected("BCryptFinishHash failed"); }
@@ -450,11 +394,11 @@ EXTERN_C DLL_API void CALLBACK PerformUpdate(HWND hwnd, HINSTANCE hinst, LPSTR l
 
             if (checksumAlg == "sha256" || checksumAlg.empty())
             {
-                hashResult = ComputeFileSHA256(downloadPath);
+                hashResult = ComputeFileDigest(downloadPath, BCRYPT_SHA256_ALGORITHM);
             }
             else if (checksumAlg == "sha1")
             {
-                hashResult = ComputeFileSHA1(downloadPath);
+                hashResult = ComputeFileDigest(downloadPath, BCRYPT_SHA1_ALGORITHM);
             }
             else
             {
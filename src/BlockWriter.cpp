@@ -0,0 +1,364 @@
+#include "pch.h"
+#include "BlockWriter.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+#if defined(_WIN32)
+    using FileHandle = HANDLE;
+    const FileHandle INVALID_FILE = INVALID_HANDLE_VALUE;
+
+    std::string GetLastErrorText()
+    {
+        return std::format("{:#x}", GetLastError());
+    }
+
+    FileHandle OpenForWriting(const std::filesystem::path& path, const bool append)
+    {
+        return CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, append ? OPEN_ALWAYS : CREATE_ALWAYS,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+
+    void CloseFile(const FileHandle file)
+    {
+        CloseHandle(file);
+    }
+
+    std::optional<uint64_t> GetFileEnd(const FileHandle file)
+    {
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<uint64_t>(size.QuadPart);
+    }
+
+    bool ReserveSpace(const FileHandle file, const uint64_t totalSize)
+    {
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(totalSize);
+
+        return SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation)) != FALSE;
+    }
+
+    // positioned write, so the I/O thread doesn't depend on the file pointer
+    bool WriteAt(const FileHandle file, const uint64_t offset, const char* data, const size_t length)
+    {
+        size_t total = 0;
+        while (total < length)
+        {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset + total);
+            overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+
+            DWORD written = 0;
+            const auto count = static_cast<DWORD>(std::min<size_t>(length - total, MAXDWORD));
+
+            if (!WriteFile(file, data + total, count, &written, &overlapped) || written == 0)
+            {
+                return false;
+            }
+
+            total += written;
+        }
+
+        return true;
+    }
+#else
+    using FileHandle = int;
+    constexpr FileHandle INVALID_FILE = -1;
+
+    std::string GetLastErrorText()
+    {
+        return std::generic_category().message(errno);
+    }
+
+    FileHandle OpenForWriting(const std::filesystem::path& path, const bool append)
+    {
+        return open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC), 0666);
+    }
+
+    void CloseFile(const FileHandle file)
+    {
+        close(file);
+    }
+
+    std::optional<uint64_t> GetFileEnd(const FileHandle file)
+    {
+        const off_t end = lseek(file, 0, SEEK_END);
+        if (end < 0)
+        {
+            return std::nullopt;
+        }
+
+        return static_cast<uint64_t>(end);
+    }
+
+    bool ReserveSpace(const FileHandle file, const uint64_t totalSize)
+    {
+#if defined(__linux__)
+        // not posix_fallocate, which extends the file; its size tells a resumed download where to continue
+        return fallocate(file, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(totalSize)) == 0;
+#else
+        (void)file;
+        (void)totalSize;
+        errno = ENOTSUP;
+        return false;
+#endif
+    }
+
+    bool WriteAt(const FileHandle file, const uint64_t offset, const char* data, const size_t length)
+    {
+        size_t total = 0;
+        while (total < length)
+        {
+            const ssize_t written = pwrite(file, data + total, length - total, static_cast<off_t>(offset + total));
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            if (written == 0)
+            {
+                errno = EIO;
+                return false;
+            }
+            total += static_cast<size_t>(written);
+        }
+
+        return true;
+    }
+#endif
+}
+
+
+bool io::BlockWriter::IsOpen() const
+{
+    return file != INVALID_FILE;
+}
+
+io::BlockWriter::~BlockWriter()
+{
+    (void)Close();
+}
+
+std::expected<void, std::string> io::BlockWriter::Open(const std::filesystem::path& path, const bool append)
+{
+    if (IsOpen())
+    {
+        return std::unexpected("Writer is already open");
+    }
+
+    file = OpenForWriting(path, append);
+    if (file == INVALID_FILE)
+    {
+        return std::unexpected(std::format("Failed to open {}, error: {}", path.string(), GetLastErrorText()));
+    }
+
+    const auto end = GetFileEnd(file);
+    if (!end.has_value())
+    {
+        const std::string failure = GetLastErrorText();
+        CloseFile(file);
+        file = INVALID_FILE;
+        return std::unexpected(std::format("Failed to seek {}, error: {}", path.string(), failure));
+    }
+
+    position = end.value();
+    writeOffset = end.value();
+    // a shorter first block realigns an appended file to block boundaries
+    currentLimit = BLOCK_SIZE - position % BLOCK_SIZE;
+    current.reserve(BLOCK_SIZE);
+    error.clear();
+    hasFailed = false;
+    isReservePending = false;
+
+    worker = std::jthread([this](const std::stop_token& stopToken) { Run(stopToken); });
+
+    return {};
+}
+
+void io::BlockWriter::Reserve(const uint64_t totalSize)
+{
+    {
+        std::lock_guard guard(lock);
+        reserveSize = totalSize;
+        isReservePending = true;
+    }
+
+    changed.notify_all();
+}
+
+bool io::BlockWriter::Write(const void* data, size_t length)
+{
+    auto bytes = static_cast<const char*>(data);
+
+    while (length > 0)
+    {
+        const size_t count = std::min(currentLimit - current.size(), length);
+        current.insert(current.end(), bytes, bytes + count);
+        bytes += count;
+        length -= count;
+
+        if (current.size() == currentLimit && !Submit())
+        {
+            return false;
+        }
+    }
+
+    return !hasFailed.load(std::memory_order_relaxed);
+}
+
+bool io::BlockWriter::Submit()
+{
+    std::unique_lock guard(lock);
+
+    // only hold the producer back if the disk is this far behind
+    changed.wait(guard, [this] { return pending.size() < MAX_PENDING_BLOCKS || !error.empty(); });
+
+    if (!error.empty())
+    {
+        current.clear();
+        return false;
+    }
+
+    position += current.size();
+    pending.push_back(std::move(current));
+
+    if (!spare.empty())
+    {
+        current = std::move(spare.back());
+        spare.pop_back();
+    }
+    else
+    {
+        current = {};
+        current.reserve(BLOCK_SIZE);
+    }
+    currentLimit = BLOCK_SIZE - position % BLOCK_SIZE;
+
+    guard.unlock();
+    changed.notify_all();
+
+    return true;
+}
+
+void io::BlockWriter::Run(const std::stop_token& stopToken)
+{
+    std::unique_lock guard(lock);
+
+    while (true)
+    {
+        changed.wait(guard, stopToken, [this] { return !pending.empty() || isReservePending; });
+
+        if (isReservePending)
+        {
+            isReservePending = false;
+            const uint64_t size = reserveSize;
+
+            guard.unlock();
+            if (!ReserveSpace(file, size))
+            {
+                spdlog::debug("Failed to reserve {} bytes, error: {}", size, GetLastErrorText());
+            }
+            guard.lock();
+        }
+
+        if (pending.empty())
+        {
+            if (stopToken.stop_requested())
+            {
+                return;
+            }
+            continue;
+        }
+
+        std::vector<char> block = std::move(pending.front());
+        pending.pop_front();
+        isWriting = true;
+        guard.unlock();
+
+        std::string failure{};
+        if (WriteAt(file, writeOffset, block.data(), block.size()))
+        {
+            writeOffset += block.size();
+        }
+        else
+        {
+            failure = std::format("Failed to write {} bytes at {}, error: {}", block.size(), writeOffset,
+                                  GetLastErrorText());
+        }
+
+        block.clear();
+
+        guard.lock();
+        isWriting = false;
+        spare.push_back(std::move(block));
+
+        if (!failure.empty() && error.empty())
+        {
+            spdlog::error("Block writer: {}", failure);
+            error = failure;
+            hasFailed = true;
+            // nothing queued after a gap may end up on file
+            pending.clear();
+        }
+
+        changed.notify_all();
+    }
+}
+
+std::expected<void, std::string> io::BlockWriter::Flush()
+{
+    if (!IsOpen())
+    {
+        return {};
+    }
+
+    if (!current.empty())
+    {
+        Submit();
+    }
+
+    std::unique_lock guard(lock);
+    changed.wait(guard, [this] { return (pending.empty() && !isWriting) || !error.empty(); });
+
+    if (!error.empty())
+    {
+        return std::unexpected(error);
+    }
+
+    return {};
+}
+
+std::expected<void, std::string> io::BlockWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return {};
+    }
+
+    const auto flushed = Flush();
+
+    worker.request_stop();
+    worker.join();
+
+    CloseFile(file);
+    file = INVALID_FILE;
+
+    current.clear();
+    pending.clear();
+    spare.clear();
+
+    return flushed;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace io
+{
+    /**
+     * \brief Sequential file writer handing large blocks to a dedicated I/O thread.
+     *
+     * The small writes curl delivers (mostly 16 KiB) are coalesced into blocks of BLOCK_SIZE at file
+     * offsets aligned to it, which the I/O thread writes while the producer fills the next one. The
+     * producer only waits when MAX_PENDING_BLOCKS are queued already, which bounds the memory used if
+     * the disk can't keep up. The final size can be reserved up front so the file system allocates it
+     * in as few extents as possible; the reservation doesn't change the file size.
+     *
+     * Blocks are written at explicit offsets, through WriteFile on Windows and pwrite elsewhere.
+     */
+    class BlockWriter
+    {
+    public:
+        static constexpr size_t BLOCK_SIZE = 1024 * 1024; // 1 MiB
+        static constexpr size_t MAX_PENDING_BLOCKS = 8;
+
+    private:
+#if defined(_WIN32)
+        HANDLE file{INVALID_HANDLE_VALUE};
+#else
+        int file{-1};
+#endif
+        std::jthread worker{};
+
+        std::mutex lock;
+        std::condition_variable_any changed;
+        std::deque<std::vector<char>> pending{};
+        std::vector<std::vector<char>> spare{};
+        bool isWriting{false};
+        uint64_t reserveSize{0};
+        bool isReservePending{false};
+        std::string error{};
+        std::atomic<bool> hasFailed{false};
+
+        // producer side only
+        std::vector<char> current{};
+        size_t currentLimit{BLOCK_SIZE};
+        uint64_t position{0};
+
+        // I/O thread only
+        uint64_t writeOffset{0};
+
+        void Run(const std::stop_token& stopToken);
+
+        bool Submit();
+
+    public:
+        BlockWriter() = default;
+        BlockWriter(const BlockWriter&) = delete;
+        BlockWriter& operator=(const BlockWriter&) = delete;
+        ~BlockWriter();
+
+        /**
+         * \brief Opens a file and starts the I/O thread.
+         * \param path The file to write.
+         * \param append True to continue at the end of an existing file, false to truncate it.
+         */
+        std::expected<void, std::string> Open(const std::filesystem::path& path, bool append);
+
+        [[nodiscard]] bool IsOpen() const;
+
+        /**
+         * \brief Reserves disk space for a file of the given total size, best effort.
+         */
+        void Reserve(uint64_t totalSize);
+
+        /**
+         * \brief Queues data to be written after everything queued before.
+         * \return False if writing failed; Flush or Close tell why.
+         */
+        bool Write(const void* data, size_t length);
+
+        /**
+         * \brief Waits until everything queued so far has been handed to the file system.
+         */
+        std::expected<void, std::string> Flush();
+
+        /**
+         * \brief Flushes, stops the I/O thread and closes the file. Does nothing if not open.
+         */
+        std::expected<void, std::string> Close();
+    };
+}
@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "CancellableTransfer.h"
+
+
+CURLcode web::PerformCancellable(CURL* handle, const std::stop_token& stopToken, std::string& errorMessage)
+{
+    char errorBuffer[ CURL_ERROR_SIZE ]{};
+    curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, errorBuffer);
+
+    auto result = [&](const CURLcode code, const char* fallback) -> CURLcode
+    {
+        if (code != CURLE_OK)
+        {
+            errorMessage = errorBuffer[ 0 ] != '\0' ? errorBuffer : fallback;
+        }
+        return code;
+    };
+
+    // the buffer lives on this stack frame, so curl must not write to it later
+    const auto errorBufferGuard = sg::make_scope_guard([handle]() noexcept
+    {
+        curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, nullptr);
+    });
+
+#if LIBCURL_VERSION_NUM >= 0x075700
+    // otherwise removing a handle that is still resolving joins the threaded resolver, which
+    // blocks until the lookup finishes; now it gets detached and finishes on its own
+    curl_easy_setopt(handle, CURLOPT_QUICK_EXIT, 1L);
+#endif
+
+    CURLM* multi = curl_multi_init();
+    if (multi == nullptr)
+    {
+        return result(CURLE_OUT_OF_MEMORY, "Failed to initialize cURL multi handle");
+    }
+    const auto multiGuard = sg::make_scope_guard([multi]() noexcept { curl_multi_cleanup(multi); });
+
+    if (const CURLMcode mc = curl_multi_add_handle(multi, handle); mc != CURLM_OK)
+    {
+        return result(CURLE_FAILED_INIT, curl_multi_strerror(mc));
+    }
+    const auto handleGuard = sg::make_scope_guard([multi, handle]() noexcept
+    {
+        curl_multi_remove_handle(multi, handle);
+    });
+
+    // destroyed first, so no wakeup can hit the multi handle while it's torn down
+    const std::stop_callback wakeup(stopToken, [multi] { curl_multi_wakeup(multi); });
+
+    while (true)
+    {
+        if (stopToken.stop_requested())
+        {
+            return result(CURLE_ABORTED_BY_CALLBACK, "Transfer cancelled");
+        }
+
+        int running = 0;
+        if (const CURLMcode mc = curl_multi_perform(multi, &running); mc != CURLM_OK)
+        {
+            return result(CURLE_FAILED_INIT, curl_multi_strerror(mc));
+        }
+
+        int queued = 0;
+        while (const CURLMsg* msg = curl_multi_info_read(multi, &queued))
+        {
+            if (msg->msg == CURLMSG_DONE && msg->easy_handle == handle)
+            {
+                const CURLcode code = msg->data.result;
+                return result(code, curl_easy_strerror(code));
+            }
+        }
+
+        if (const CURLMcode mc = curl_multi_poll(multi, nullptr, 0,
+                                                 static_cast<int>(CANCEL_POLL_INTERVAL.count()), nullptr);
+            mc != CURLM_OK)
+        {
+            return result(CURLE_FAILED_INIT, curl_multi_strerror(mc));
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <chrono>
+#include <stop_token>
+#include <string>
+
+
+namespace web
+{
+    /**
+     * \brief How long the transfer loop sleeps at most between two checks of the stop token.
+     *        Only matters if the poll can't be woken up, which bounds the cancellation latency.
+     */
+    constexpr std::chrono::milliseconds CANCEL_POLL_INTERVAL{250};
+
+    /**
+     * \brief Runs a transfer to completion like curl_easy_perform, but returns as soon as stopToken
+     *        is triggered.
+     *
+     * The handle is driven by a private multi handle whose poll is woken up by curl_multi_wakeup
+     * from whichever thread requests the stop, so cancellation no longer has to wait for curl to
+     * call a progress callback. That covers connecting, TLS handshakes and name resolution (the
+     * threaded resolver is detached rather than joined), not just stalled body transfers.
+     *
+     * \param handle The configured easy handle, must not be attached to a multi handle.
+     * \param stopToken Cancels the transfer.
+     * \param errorMessage Receives curl's detailed error message on failure.
+     * \return CURLE_OK on success, CURLE_ABORTED_BY_CALLBACK if cancelled or the transfer's error.
+     */
+    CURLcode PerformCancellable(CURL* handle, const std::stop_token& stopToken, std::string& errorMessage);
+}
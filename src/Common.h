@@ -17,6 +17,10 @@
 #define NV_CLI_SILENT_UPDATE                         "--silent-update"
 #define NV_CLI_IGNORE_BUSY_STATE                     "--ignore-busy-state"
 #define NV_CLI_PARAM_LOG_TO_FILE                     "--log-to-file"
+#define NV_CLI_TIMING_REPORT                         "--timing-report"
+#define NV_CLI_PARAM_BACKGROUND_RATE_LIMIT           "--background-rate-limit"
+#define NV_CLI_BACKGROUND_RATE_ADAPTIVE              "--background-rate-adaptive"
+#define NV_CLI_PREFETCH                              "--prefetch"
 #define NV_CLI_PARAM_SERVER_URL                      "--server-url"
 #define NV_CLI_NO_SCHEDULED_TASK                     "--no-scheduled-task"
 #define NV_CLI_NO_AUTOSTART                          "--no-autostart"
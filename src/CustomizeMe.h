@@ -71,6 +71,35 @@
 //
 #define NV_SUCCESS_EXIT_CODE 0
 
+//
+// Maximum number of parallel byte-range segments a release download is split into
+// if the server advertises "Accept-Ranges: bytes"; set to 1 to always use a single stream
+//
+#define NV_DOWNLOAD_SEGMENTS 4
+
+//
+// Minimum size of each download segment in bytes; smaller payloads use fewer (or no) segments
+//
+#define NV_DOWNLOAD_SEGMENT_MIN_SIZE (8 * 1024 * 1024)
+
+//
+// Upper bound in bytes of the machine-wide download cache all updater instances on this
+// machine share (%ProgramData%\Vicius\DownloadCache); set to 0 to disable the cache
+//
+#define NV_DOWNLOAD_CACHE_MAX_SIZE (2ULL * 1024 * 1024 * 1024)
+
+//
+// Delay in milliseconds before the next fallback update server URL is raced against the
+// ones still in flight; it is started right away once all previous attempts have failed
+//
+#define NV_MANIFEST_FALLBACK_DELAY_MS 3000
+
+//
+// Offer CBOR and MessagePack besides JSON when requesting the manifest; servers picking one
+// of those must announce it via Content-Type. Comment out to always request plain JSON
+//
+#define NV_MANIFEST_ACCEPT_BINARY
+
 
 /*
  * Manifest signing (Ed25519 / minisign-compatible)
@@ -121,6 +150,12 @@
 //
 //#define NV_FLAGS_ALWAYS_RUN_INSTALL
 
+//
+// Uncomment to always use the portable SHA-1/SHA-256 implementation, even if the CPU
+// supports the SHA instruction set extensions
+//
+//#define NV_FLAGS_NO_HASH_ACCELERATION
+
 
 #if __has_include("ViciusPostCustomizeMe.h")
 #include "ViciusPostCustomizeMe.h"
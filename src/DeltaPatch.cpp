@@ -0,0 +1,239 @@
+#include "pch.h"
+#include "DeltaPatch.h"
+
+#include <zstd.h>
+
+
+namespace
+{
+    /** Largest window zstd --patch-from --long produces on 64-bit hosts (2 GiB) */
+    constexpr int MAX_PATCH_WINDOW_LOG = 31;
+
+    /**
+     * \brief Read-only memory mapping of a whole file.
+     */
+    class MappedFile
+    {
+        HANDLE file{INVALID_HANDLE_VALUE};
+        HANDLE mapping{nullptr};
+        const void* view{nullptr};
+        uint64_t size{0};
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            if (view != nullptr) UnmapViewOfFile(view);
+            if (mapping != nullptr) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        }
+
+        std::expected<void, std::string> Open(const std::filesystem::path& path)
+        {
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return std::unexpected(std::format("Failed to open base file, error: {:#x}", GetLastError()));
+            }
+
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                return std::unexpected(std::format("Failed to get base file size, error: {:#x}", GetLastError()));
+            }
+            size = static_cast<uint64_t>(fileSize.QuadPart);
+
+            // empty files can't be mapped, and don't need to be
+            if (size == 0)
+            {
+                return {};
+            }
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr)
+            {
+                return std::unexpected(std::format("Failed to map base file, error: {:#x}", GetLastError()));
+            }
+
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view == nullptr)
+            {
+                return std::unexpected(std::format("Failed to map base file view, error: {:#x}", GetLastError()));
+            }
+
+            return {};
+        }
+
+        [[nodiscard]] const void* GetData() const { return view; }
+
+        [[nodiscard]] uint64_t GetSize() const { return size; }
+    };
+}
+
+std::expected<uint64_t, std::string> delta::ApplyZstdPatch(
+    const std::filesystem::path& basePath,
+    const std::filesystem::path& patchPath,
+    const std::filesystem::path& outPath,
+    hashing::IncrementalHasher& hasher,
+    const std::optional<uint64_t> expectedSize,
+    const std::stop_token& stopToken)
+{
+    MappedFile base;
+    if (const auto opened = base.Open(basePath); !opened)
+    {
+        return std::unexpected(opened.error());
+    }
+
+    std::ifstream patch(patchPath, std::ios::binary);
+    if (!patch.is_open())
+    {
+        return std::unexpected(std::format("Failed to open patch file {}", patchPath.string()));
+    }
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+        return std::unexpected(std::format("Failed to create output file {}", outPath.string()));
+    }
+
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    if (dctx == nullptr)
+    {
+        return std::unexpected("Failed to create decompression context");
+    }
+    const auto dctxGuard = sg::make_scope_guard([dctx]() noexcept { ZSTD_freeDCtx(dctx); });
+
+    if (const size_t rc = ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, MAX_PATCH_WINDOW_LOG); ZSTD_isError(rc))
+    {
+        return std::unexpected(std::format("Failed to configure decompression: {}", ZSTD_getErrorName(rc)));
+    }
+
+    // a prefix only applies to the next frame, so it has to be referenced again for every frame
+    auto refBase = [&]() -> size_t
+    {
+        return ZSTD_DCtx_refPrefix(dctx, base.GetData(), static_cast<size_t>(base.GetSize()));
+    };
+
+    if (const size_t rc = refBase(); ZSTD_isError(rc))
+    {
+        return std::unexpected(std::format("Failed to reference base file: {}", ZSTD_getErrorName(rc)));
+    }
+
+    std::vector<char> inBuffer(ZSTD_DStreamInSize());
+    std::vector<char> outBuffer(ZSTD_DStreamOutSize());
+    uint64_t written = 0;
+    const uint64_t maxSize = expectedSize.value_or(std::numeric_limits<uint64_t>::max());
+    // non-zero while a frame is incomplete
+    size_t pending = 1;
+
+    while (true)
+    {
+        patch.read(inBuffer.data(), static_cast<std::streamsize>(inBuffer.size()));
+        const auto bytesRead = static_cast<size_t>(patch.gcount());
+
+        if (bytesRead == 0)
+        {
+            if (patch.bad())
+            {
+                return std::unexpected("Failed to read patch file");
+            }
+            break;
+        }
+
+        ZSTD_inBuffer input{inBuffer.data(), bytesRead, 0};
+
+        while (input.pos < input.size)
+        {
+            if (stopToken.stop_requested())
+            {
+                return std::unexpected("Patching cancelled");
+            }
+
+            // the previous frame is done and another one follows
+            if (pending == 0)
+            {
+                if (const size_t rc = refBase(); ZSTD_isError(rc))
+                {
+                    return std::unexpected(std::format("Failed to reference base file: {}", ZSTD_getErrorName(rc)));
+                }
+            }
+
+            ZSTD_outBuffer output{outBuffer.data(), outBuffer.size(), 0};
+            pending = ZSTD_decompressStream(dctx, &output, &input);
+
+            if (ZSTD_isError(pending))
+            {
+                return std::unexpected(std::format("Failed to apply patch: {}", ZSTD_getErrorName(pending)));
+            }
+
+            // a patch inflating beyond the release is bogus, don't let it fill up the disk
+            if (output.pos > maxSize - written)
+            {
+                return std::unexpected("Patch produces more data than the release size");
+            }
+
+            out.write(outBuffer.data(), static_cast<std::streamsize>(output.pos));
+            if (!out)
+            {
+                return std::unexpected(std::format("Failed to write output file {}", outPath.string()));
+            }
+
+            hasher.Add(outBuffer.data(), output.pos);
+            written += output.pos;
+        }
+    }
+
+    // flush whatever the decoder still holds back
+    while (pending != 0)
+    {
+        ZSTD_inBuffer input{nullptr, 0, 0};
+        ZSTD_outBuffer output{outBuffer.data(), outBuffer.size(), 0};
+        pending = ZSTD_decompressStream(dctx, &output, &input);
+
+        if (ZSTD_isError(pending))
+        {
+            return std::unexpected(std::format("Failed to apply patch: {}", ZSTD_getErrorName(pending)));
+        }
+
+        if (output.pos == 0)
+        {
+            break;
+        }
+
+        if (output.pos > maxSize - written)
+        {
+            return std::unexpected("Patch produces more data than the release size");
+        }
+
+        out.write(outBuffer.data(), static_cast<std::streamsize>(output.pos));
+        if (!out)
+        {
+            return std::unexpected(std::format("Failed to write output file {}", outPath.string()));
+        }
+
+        hasher.Add(outBuffer.data(), output.pos);
+        written += output.pos;
+    }
+
+    if (pending != 0)
+    {
+        return std::unexpected("Patch file is truncated");
+    }
+
+    if (expectedSize.has_value() && written != expectedSize.value())
+    {
+        return std::unexpected(std::format("Patch produced {} bytes instead of {}", written, expectedSize.value()));
+    }
+
+    out.close();
+    if (out.fail())
+    {
+        return std::unexpected(std::format("Failed to finalize output file {}", outPath.string()));
+    }
+
+    return written;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Hashing.h"
+
+#include <filesystem>
+#include <optional>
+#include <stop_token>
+
+
+namespace delta
+{
+    /**
+     * \brief Reconstructs a file from a base file and a zstd patch (zstd --patch-from).
+     *
+     * The base file is memory-mapped and referenced as the decompression prefix, so even
+     * payloads of several hundred megabytes don't have to be read into memory. The output is
+     * streamed to disk and fed into the hasher on the way, so the reconstructed file's checksum
+     * is known the moment the patch has been applied.
+     *
+     * \param basePath The installed file the patch was created against.
+     * \param patchPath The downloaded patch.
+     * \param outPath The file to write, replaced if it exists.
+     * \param hasher Receives the reconstructed bytes, must be reset by the caller.
+     * \param expectedSize The size of the reconstructed file if known; patching fails as soon as
+     *                     the output exceeds it, and if it comes up short.
+     * \param stopToken Cancels the reconstruction.
+     * \return The number of bytes written or an error message. On error outPath is left in an
+     *         undefined state and should be deleted.
+     */
+    std::expected<uint64_t, std::string> ApplyZstdPatch(const std::filesystem::path& basePath,
+                                                        const std::filesystem::path& patchPath,
+                                                        const std::filesystem::path& outPath,
+                                                        hashing::IncrementalHasher& hasher,
+                                                        std::optional<uint64_t> expectedSize,
+                                                        const std::stop_token& stopToken = {});
+}
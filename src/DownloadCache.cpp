@@ -0,0 +1,326 @@
+#include "pch.h"
+#include "Util.h"
+#include "DownloadCache.h"
+#include "BlockWriter.h"
+#include "SequentialReader.h"
+
+
+namespace
+{
+    /** How long to wait for another instance to release the cache */
+    constexpr std::chrono::seconds LOCK_TIMEOUT{10};
+
+    /** Leftovers of interrupted stores older than this are removed during eviction */
+    constexpr std::chrono::hours STALE_TEMP_AGE{24};
+
+    constexpr const wchar_t* LOCK_FILE_NAME = L".lock";
+
+    /**
+     * \brief Cross-process lock on the cache directory, held as long as the lock file is open.
+     */
+    class CacheLock
+    {
+        HANDLE handle{INVALID_HANDLE_VALUE};
+
+    public:
+        explicit CacheLock(const std::filesystem::path& directory)
+        {
+            const auto path = directory / LOCK_FILE_NAME;
+            const auto deadline = std::chrono::steady_clock::now() + LOCK_TIMEOUT;
+
+            while (true)
+            {
+                // no sharing at all makes the open itself the lock; read access suffices, so it
+                // works no matter which user created the file
+                handle = CreateFileW(path.c_str(), GENERIC_READ, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_HIDDEN,
+                                     nullptr);
+
+                if (handle != INVALID_HANDLE_VALUE || GetLastError() != ERROR_SHARING_VIOLATION ||
+                    std::chrono::steady_clock::now() >= deadline)
+                {
+                    break;
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+
+            if (handle == INVALID_HANDLE_VALUE)
+            {
+                spdlog::warn("Failed to lock download cache {}, error: {:#x}", directory, GetLastError());
+            }
+        }
+
+        CacheLock(const CacheLock&) = delete;
+        CacheLock& operator=(const CacheLock&) = delete;
+
+        ~CacheLock()
+        {
+            if (handle != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(handle);
+            }
+        }
+
+        [[nodiscard]] bool IsHeld() const { return handle != INVALID_HANDLE_VALUE; }
+    };
+
+    /**
+     * \brief Marks an entry as recently used; NTFS doesn't reliably maintain the last access time itself.
+     */
+    void Touch(const std::filesystem::path& path)
+    {
+        const HANDLE file = CreateFileW(path.c_str(), FILE_WRITE_ATTRIBUTES,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        // entries of other users can't be touched, they age a little faster then
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return;
+        }
+
+        FILETIME now{};
+        GetSystemTimeAsFileTime(&now);
+        SetFileTime(file, nullptr, &now, nullptr);
+        CloseHandle(file);
+    }
+}
+
+cache::DownloadCache::DownloadCache(std::filesystem::path directory, const uint64_t maxSize)
+    : directory(std::move(directory)), maxSize(maxSize)
+{
+}
+
+std::optional<cache::DownloadCache> cache::DownloadCache::OpenMachineWide()
+{
+#if NV_DOWNLOAD_CACHE_MAX_SIZE > 0
+    const auto programData = winapi::GetProgramDataPath();
+    if (!programData)
+    {
+        return std::nullopt;
+    }
+
+    // deliberately not per manufacturer/product, tenants share their redistributables
+    const std::filesystem::path directory = std::filesystem::path(*programData) / "Vicius" / "DownloadCache";
+
+    if (!nefarius::winapi::fs::DirectoryCreate(directory.string()))
+    {
+        spdlog::warn("Failed to create download cache directory {}, error: {:#x}", directory, GetLastError());
+        return std::nullopt;
+    }
+
+    return DownloadCache(directory, NV_DOWNLOAD_CACHE_MAX_SIZE);
+#else
+    return std::nullopt;
+#endif
+}
+
+std::filesystem::path cache::DownloadCache::GetEntryPath(const models::ChecksumParameters& checksum) const
+{
+    if (checksum.checksumAlg == models::ChecksumAlgorithm::Invalid || checksum.checksum.empty())
+    {
+        return {};
+    }
+
+    // the value ends up in a path, so anything but a hex digest is rejected
+    std::string digest = checksum.checksum;
+    for (char& c : digest)
+    {
+        if (!std::isxdigit(static_cast<unsigned char>(c)))
+        {
+            return {};
+        }
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return directory / std::format("{}-{}", magic_enum::enum_name(checksum.checksumAlg), digest);
+}
+
+bool cache::DownloadCache::Retrieve(const models::ChecksumParameters& checksum,
+                                    const std::filesystem::path& target,
+                                    hashing::IncrementalHasher& hasher) const
+{
+    hasher.Reset();
+
+    const auto entry = GetEntryPath(checksum);
+    if (entry.empty())
+    {
+        return false;
+    }
+
+    // keeps the entry from being evicted while it's copied
+    const CacheLock lock(directory);
+    if (!lock.IsHeld())
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(entry, ec);
+    if (ec || !std::filesystem::is_regular_file(entry, ec))
+    {
+        return false;
+    }
+
+    io::BlockWriter writer;
+    if (const auto opened = writer.Open(target, false); !opened)
+    {
+        spdlog::warn("Failed to create {}, error: {}", target, opened.error());
+        return false;
+    }
+    writer.Reserve(size);
+
+    // hashed on the way so the digest is of what lands in the user's temp directory, no matter
+    // what happens to the entry meanwhile
+    const auto copied = io::ReadSequential(entry, 0, io::READ_TO_END, [&](const uint8_t* data, const size_t length)
+    {
+        hasher.Add(data, length);
+        return writer.Write(data, length);
+    });
+    const auto closed = writer.Close();
+
+    if (!copied.has_value() || !closed.has_value())
+    {
+        spdlog::warn("Failed to copy cached payload {} to {}, error: {}", entry, target,
+                     !copied.has_value() ? copied.error() : closed.error());
+        hasher.Reset();
+        return false;
+    }
+
+    spdlog::info("Copied cached payload {} ({} bytes) to {}", entry, copied.value(), target);
+    Touch(entry);
+    return true;
+}
+
+void cache::DownloadCache::Store(const models::ChecksumParameters& checksum,
+                                 const std::filesystem::path& source) const
+{
+    const auto entry = GetEntryPath(checksum);
+    if (entry.empty())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(source, ec);
+    if (ec || size > maxSize)
+    {
+        return;
+    }
+
+    const CacheLock lock(directory);
+    if (!lock.IsHeld())
+    {
+        return;
+    }
+
+    // another instance got there first
+    if (std::filesystem::is_regular_file(entry, ec))
+    {
+        Touch(entry);
+        return;
+    }
+
+    // Copied rather than linked: a link would share the source's ACL, which for a file in the
+    // user's temp directory locks every other user out. The copy inherits the cache's ACL.
+    std::filesystem::path temp = entry;
+    temp += std::format(".{}.tmp", GetCurrentProcessId());
+
+    if (!CopyFileW(source.c_str(), temp.c_str(), FALSE))
+    {
+        spdlog::warn("Failed to copy {} into download cache, error: {:#x}", source, GetLastError());
+        DeleteFileW(temp.c_str());
+        return;
+    }
+
+    if (!MoveFileExW(temp.c_str(), entry.c_str(), 0))
+    {
+        spdlog::warn("Failed to add {} to download cache, error: {:#x}", entry, GetLastError());
+        DeleteFileW(temp.c_str());
+        return;
+    }
+
+    spdlog::info("Added {} ({} bytes) to download cache", entry, size);
+    Touch(entry);
+    Evict(entry);
+}
+
+void cache::DownloadCache::Evict(const std::filesystem::path& keep) const
+{
+    struct Entry
+    {
+        std::filesystem::path path;
+        uint64_t size;
+        uint64_t lastAccess;
+    };
+
+    std::vector<Entry> entries{};
+    uint64_t totalSize = 0;
+
+    FILETIME now{};
+    GetSystemTimeAsFileTime(&now);
+    const uint64_t nowTicks = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    // FILETIME counts 100 ns intervals
+    const uint64_t staleTicks = std::chrono::duration_cast<std::chrono::seconds>(STALE_TEMP_AGE).count() * 10'000'000ULL;
+
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(directory, ec))
+    {
+        const auto& path = item.path();
+        if (path.filename() == LOCK_FILE_NAME)
+        {
+            continue;
+        }
+
+        WIN32_FILE_ATTRIBUTE_DATA data{};
+        if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data) ||
+            (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            continue;
+        }
+
+        const uint64_t size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        const uint64_t lastAccess = (static_cast<uint64_t>(data.ftLastAccessTime.dwHighDateTime) << 32)
+                                    | data.ftLastAccessTime.dwLowDateTime;
+
+        if (path.extension() == ".tmp")
+        {
+            // all stores happen under the lock, so a temp file is left over from a crashed instance
+            if (nowTicks > lastAccess && nowTicks - lastAccess > staleTicks)
+            {
+                DeleteFileW(path.c_str());
+            }
+            continue;
+        }
+
+        entries.push_back({path, size, lastAccess});
+        totalSize += size;
+    }
+
+    if (totalSize <= maxSize)
+    {
+        return;
+    }
+
+    std::ranges::sort(entries, {}, &Entry::lastAccess);
+
+    for (const auto& entry : entries)
+    {
+        if (totalSize <= maxSize)
+        {
+            break;
+        }
+
+        if (entry.path == keep)
+        {
+            continue;
+        }
+
+        // fails for entries still opened by an installer or owned by another user, those are skipped
+        if (DeleteFileW(entry.path.c_str()))
+        {
+            spdlog::debug("Evicted {} ({} bytes) from download cache", entry.path, entry.size);
+            totalSize -= entry.size;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Hashing.h"
+#include "models/UpdateRelease.hpp"
+
+#include <filesystem>
+
+
+namespace cache
+{
+    /**
+     * \brief Content-addressed store of verified release payloads, shared by all updater instances.
+     *
+     * Entries are named after the release checksum, so every tenant on the machine that ships
+     * the same redistributable finds it regardless of the URL it was published under. Mutations
+     * and eviction are serialized across processes through an exclusively opened lock file.
+     *
+     * The cache directory is writable by every user, so its content is never trusted: Retrieve
+     * always copies an entry and hashes the bytes as it writes them, and callers verify that digest
+     * against the checksum. A hard link would let anyone granted write access to the entry alter
+     * the payload between the verification and the launch of the installer.
+     */
+    class DownloadCache
+    {
+        std::filesystem::path directory;
+        uint64_t maxSize;
+
+        [[nodiscard]] std::filesystem::path GetEntryPath(const models::ChecksumParameters& checksum) const;
+
+        void Evict(const std::filesystem::path& keep) const;
+
+    public:
+        DownloadCache(std::filesystem::path directory, uint64_t maxSize);
+
+        /**
+         * \brief Opens the cache under %ProgramData%, creating it if necessary.
+         * \return The cache or std::nullopt if it's disabled or unavailable.
+         */
+        static std::optional<DownloadCache> OpenMachineWide();
+
+        /**
+         * \brief Copies the entry matching checksum to target, replacing it.
+         * \param hasher Reset, then fed the bytes written to target, so its digest covers exactly those.
+         * \return True if target now holds the (still unverified) cached payload.
+         */
+        bool Retrieve(const models::ChecksumParameters& checksum, const std::filesystem::path& target,
+                      hashing::IncrementalHasher& hasher) const;
+
+        /**
+         * \brief Adds a verified payload, then evicts least recently used entries beyond the size limit.
+         */
+        void Store(const models::ChecksumParameters& checksum, const std::filesystem::path& source) const;
+    };
+}
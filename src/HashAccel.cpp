@@ -0,0 +1,922 @@
+#include "pch.h"
+#include "HashAccel.h"
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+
+#if !defined(NV_FLAGS_NO_HASH_ACCELERATION) && \
+    (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define NV_HASH_SHA_NI
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define NV_TARGET_SHA
+#else
+#include <cpuid.h>
+#define NV_TARGET_SHA __attribute__((target("sha,sse4.1,ssse3")))
+#endif
+#endif
+
+
+namespace
+{
+    /** Compresses count consecutive 64-byte blocks into the big-endian state words */
+    using CompressFn = void (*)(uint32_t* state, const uint8_t* blocks, size_t count);
+
+    struct ShaFunctions
+    {
+        CompressFn sha1;
+        CompressFn sha256;
+        const char* name;
+    };
+
+    constexpr uint32_t SHA1_INIT[ 5 ] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+    constexpr uint32_t SHA256_INIT[ 8 ] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    alignas(16) constexpr uint32_t SHA256_K[ 64 ] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t Rotl(const uint32_t value, const int bits)
+    {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    uint32_t Rotr(const uint32_t value, const int bits)
+    {
+        return (value >> bits) | (value << (32 - bits));
+    }
+
+    uint32_t LoadBigEndian(const uint8_t* bytes)
+    {
+        return static_cast<uint32_t>(bytes[ 0 ]) << 24 | static_cast<uint32_t>(bytes[ 1 ]) << 16 |
+            static_cast<uint32_t>(bytes[ 2 ]) << 8 | static_cast<uint32_t>(bytes[ 3 ]);
+    }
+
+    void CompressSha1Portable(uint32_t* state, const uint8_t* blocks, size_t count)
+    {
+        for (; count > 0; --count, blocks += 64)
+        {
+            uint32_t w[ 80 ];
+            for (int i = 0; i < 16; i++)
+            {
+                w[ i ] = LoadBigEndian(blocks + i * 4);
+            }
+            for (int i = 16; i < 80; i++)
+            {
+                w[ i ] = Rotl(w[ i - 3 ] ^ w[ i - 8 ] ^ w[ i - 14 ] ^ w[ i - 16 ], 1);
+            }
+
+            uint32_t a = state[ 0 ], b = state[ 1 ], c = state[ 2 ], d = state[ 3 ], e = state[ 4 ];
+
+            for (int i = 0; i < 80; i++)
+            {
+                uint32_t f, k;
+                if (i < 20)
+                {
+                    f = (b & c) | (~b & d);
+                    k = 0x5a827999;
+                }
+                else if (i < 40)
+                {
+                    f = b ^ c ^ d;
+                    k = 0x6ed9eba1;
+                }
+                else if (i < 60)
+                {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8f1bbcdc;
+                }
+                else
+                {
+                    f = b ^ c ^ d;
+                    k = 0xca62c1d6;
+                }
+
+                const uint32_t temp = Rotl(a, 5) + f + e + k + w[ i ];
+                e = d;
+                d = c;
+                c = Rotl(b, 30);
+                b = a;
+                a = temp;
+            }
+
+            state[ 0 ] += a;
+            state[ 1 ] += b;
+            state[ 2 ] += c;
+            state[ 3 ] += d;
+            state[ 4 ] += e;
+        }
+    }
+
+    void CompressSha256Portable(uint32_t* state, const uint8_t* blocks, size_t count)
+    {
+        for (; count > 0; --count, blocks += 64)
+        {
+            uint32_t w[ 64 ];
+            for (int i = 0; i < 16; i++)
+            {
+                w[ i ] = LoadBigEndian(blocks + i * 4);
+            }
+            for (int i = 16; i < 64; i++)
+            {
+                const uint32_t s0 = Rotr(w[ i - 15 ], 7) ^ Rotr(w[ i - 15 ], 18) ^ (w[ i - 15 ] >> 3);
+                const uint32_t s1 = Rotr(w[ i - 2 ], 17) ^ Rotr(w[ i - 2 ], 19) ^ (w[ i - 2 ] >> 10);
+                w[ i ] = w[ i - 16 ] + s0 + w[ i - 7 ] + s1;
+            }
+
+            uint32_t a = state[ 0 ], b = state[ 1 ], c = state[ 2 ], d = state[ 3 ];
+            uint32_t e = state[ 4 ], f = state[ 5 ], g = state[ 6 ], h = state[ 7 ];
+
+            for (int i = 0; i < 64; i++)
+            {
+                const uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+                const uint32_t ch = (e & f) ^ (~e & g);
+                const uint32_t temp1 = h + s1 + ch + SHA256_K[ i ] + w[ i ];
+                const uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+                const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+                const uint32_t temp2 = s0 + maj;
+
+                h = g;
+                g = f;
+                f = e;
+                e = d + temp1;
+                d = c;
+                c = b;
+                b = a;
+                a = temp1 + temp2;
+            }
+
+            state[ 0 ] += a;
+            state[ 1 ] += b;
+            state[ 2 ] += c;
+            state[ 3 ] += d;
+            state[ 4 ] += e;
+            state[ 5 ] += f;
+            state[ 6 ] += g;
+            state[ 7 ] += h;
+        }
+    }
+
+#if defined(NV_HASH_SHA_NI)
+    bool HasShaExtensions()
+    {
+        constexpr uint32_t SSSE3 = 1u << 9;
+        constexpr uint32_t SSE41 = 1u << 19;
+        constexpr uint32_t SHA = 1u << 29;
+
+#if defined(_MSC_VER)
+        int regs[ 4 ]{};
+        __cpuid(regs, 0);
+        if (regs[ 0 ] < 7)
+        {
+            return false;
+        }
+
+        __cpuid(regs, 1);
+        const auto leaf1Ecx = static_cast<uint32_t>(regs[ 2 ]);
+        __cpuidex(regs, 7, 0);
+        const auto leaf7Ebx = static_cast<uint32_t>(regs[ 1 ]);
+#else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (__get_cpuid_max(0, nullptr) < 7)
+        {
+            return false;
+        }
+
+        __cpuid(1, eax, ebx, ecx, edx);
+        const uint32_t leaf1Ecx = ecx;
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        const uint32_t leaf7Ebx = ebx;
+#endif
+
+        return (leaf1Ecx & SSSE3) != 0 && (leaf1Ecx & SSE41) != 0 && (leaf7Ebx & SHA) != 0;
+    }
+
+    // message schedule, w0..w3 hold the last 16 words oldest first and w0 receives the next four
+    NV_TARGET_SHA inline void Sha1Schedule(__m128i& w0, const __m128i w1, const __m128i w2, const __m128i w3)
+    {
+        w0 = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w0, w1), w2), w3);
+    }
+
+    // four rounds, e is consumed and replaced by the E input of the next four rounds
+    template <int Function>
+    NV_TARGET_SHA inline void Sha1Rounds(__m128i& abcd, __m128i& e, const __m128i next)
+    {
+        const __m128i previous = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e, Function);
+        e = _mm_sha1nexte_epu32(previous, next);
+    }
+
+    NV_TARGET_SHA void CompressSha1ShaNi(uint32_t* state, const uint8_t* blocks, size_t count)
+    {
+        const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+        __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+        __m128i e0 = _mm_set_epi32(static_cast<int>(state[ 4 ]), 0, 0, 0);
+
+        for (; count > 0; --count, blocks += 64)
+        {
+            const __m128i abcdSave = abcd;
+            const __m128i e0Save = e0;
+
+            const auto* words = reinterpret_cast<const __m128i*>(blocks);
+            __m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128(words + 0), byteSwap);
+            __m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128(words + 1), byteSwap);
+            __m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128(words + 2), byteSwap);
+            __m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128(words + 3), byteSwap);
+
+            __m128i e = _mm_add_epi32(e0, w0);
+
+            Sha1Rounds<0>(abcd, e, w1);
+            Sha1Rounds<0>(abcd, e, w2);
+            Sha1Rounds<0>(abcd, e, w3);
+            Sha1Schedule(w0, w1, w2, w3);
+            Sha1Rounds<0>(abcd, e, w0);
+            Sha1Schedule(w1, w2, w3, w0);
+            Sha1Rounds<0>(abcd, e, w1);
+
+            Sha1Schedule(w2, w3, w0, w1);
+            Sha1Rounds<1>(abcd, e, w2);
+            Sha1Schedule(w3, w0, w1, w2);
+            Sha1Rounds<1>(abcd, e, w3);
+            Sha1Schedule(w0, w1, w2, w3);
+            Sha1Rounds<1>(abcd, e, w0);
+            Sha1Schedule(w1, w2, w3, w0);
+            Sha1Rounds<1>(abcd, e, w1);
+            Sha1Schedule(w2, w3, w0, w1);
+            Sha1Rounds<1>(abcd, e, w2);
+
+            Sha1Schedule(w3, w0, w1, w2);
+            Sha1Rounds<2>(abcd, e, w3);
+            Sha1Schedule(w0, w1, w2, w3);
+            Sha1Rounds<2>(abcd, e, w0);
+            Sha1Schedule(w1, w2, w3, w0);
+            Sha1Rounds<2>(abcd, e, w1);
+            Sha1Schedule(w2, w3, w0, w1);
+            Sha1Rounds<2>(abcd, e, w2);
+            Sha1Schedule(w3, w0, w1, w2);
+            Sha1Rounds<2>(abcd, e, w3);
+
+            Sha1Schedule(w0, w1, w2, w3);
+            Sha1Rounds<3>(abcd, e, w0);
+            Sha1Schedule(w1, w2, w3, w0);
+            Sha1Rounds<3>(abcd, e, w1);
+            Sha1Schedule(w2, w3, w0, w1);
+            Sha1Rounds<3>(abcd, e, w2);
+            Sha1Schedule(w3, w0, w1, w2);
+            Sha1Rounds<3>(abcd, e, w3);
+            // the last E input is the saved E, which adds it back for the feed-forward
+            Sha1Rounds<3>(abcd, e, e0Save);
+
+            e0 = e;
+            abcd = _mm_add_epi32(abcd, abcdSave);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+        state[ 4 ] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+    }
+
+    // message schedule, w0..w3 hold the last 16 words oldest first and w0 receives the next four
+    NV_TARGET_SHA inline void Sha256Schedule(__m128i& w0, const __m128i w1, const __m128i w2, const __m128i w3)
+    {
+        w0 = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w0, w1), _mm_alignr_epi8(w3, w2, 4)), w3);
+    }
+
+    NV_TARGET_SHA inline void Sha256Rounds(__m128i& abef, __m128i& cdgh, const __m128i w, const uint32_t* k)
+    {
+        __m128i message = _mm_add_epi32(w, _mm_load_si128(reinterpret_cast<const __m128i*>(k)));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+        message = _mm_shuffle_epi32(message, 0x0e);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+    }
+
+    NV_TARGET_SHA void CompressSha256ShaNi(uint32_t* state, const uint8_t* blocks, size_t count)
+    {
+        const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        // the round instructions want the state as ABEF/CDGH
+        const __m128i dcba = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+        const __m128i hgfe = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+        __m128i abef = _mm_alignr_epi8(dcba, hgfe, 8);
+        __m128i cdgh = _mm_blend_epi16(hgfe, dcba, 0xf0);
+
+        for (; count > 0; --count, blocks += 64)
+        {
+            const __m128i abefSave = abef;
+            const __m128i cdghSave = cdgh;
+
+            const auto* words = reinterpret_cast<const __m128i*>(blocks);
+            __m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128(words + 0), byteSwap);
+            __m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128(words + 1), byteSwap);
+            __m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128(words + 2), byteSwap);
+            __m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128(words + 3), byteSwap);
+
+            Sha256Rounds(abef, cdgh, w0, SHA256_K + 0);
+            Sha256Rounds(abef, cdgh, w1, SHA256_K + 4);
+            Sha256Rounds(abef, cdgh, w2, SHA256_K + 8);
+            Sha256Rounds(abef, cdgh, w3, SHA256_K + 12);
+
+            for (int i = 16; i < 64; i += 16)
+            {
+                Sha256Schedule(w0, w1, w2, w3);
+                Sha256Rounds(abef, cdgh, w0, SHA256_K + i);
+                Sha256Schedule(w1, w2, w3, w0);
+                Sha256Rounds(abef, cdgh, w1, SHA256_K + i + 4);
+                Sha256Schedule(w2, w3, w0, w1);
+                Sha256Rounds(abef, cdgh, w2, SHA256_K + i + 8);
+                Sha256Schedule(w3, w0, w1, w2);
+                Sha256Rounds(abef, cdgh, w3, SHA256_K + i + 12);
+            }
+
+            abef = _mm_add_epi32(abef, abefSave);
+            cdgh = _mm_add_epi32(cdgh, cdghSave);
+        }
+
+        const __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+        const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xf0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+    }
+#endif
+
+    constexpr ShaFunctions PORTABLE_FUNCTIONS{CompressSha1Portable, CompressSha256Portable, "portable"};
+#if defined(NV_HASH_SHA_NI)
+    constexpr ShaFunctions SHA_NI_FUNCTIONS{CompressSha1ShaNi, CompressSha256ShaNi, "SHA-NI"};
+#endif
+
+    const ShaFunctions* FindBackend(const hashing::ShaBackend backend)
+    {
+        switch (backend)
+        {
+        case hashing::ShaBackend::Auto:
+#if defined(NV_HASH_SHA_NI)
+            return HasShaExtensions() ? &SHA_NI_FUNCTIONS : &PORTABLE_FUNCTIONS;
+#else
+            return &PORTABLE_FUNCTIONS;
+#endif
+        case hashing::ShaBackend::Portable:
+            return &PORTABLE_FUNCTIONS;
+        case hashing::ShaBackend::ShaNi:
+#if defined(NV_HASH_SHA_NI)
+            return HasShaExtensions() ? &SHA_NI_FUNCTIONS : nullptr;
+#else
+            return nullptr;
+#endif
+        }
+
+        return nullptr;
+    }
+
+    std::atomic<const ShaFunctions*>& GetActiveBackend()
+    {
+        static std::atomic<const ShaFunctions*> active{FindBackend(hashing::ShaBackend::Auto)};
+        return active;
+    }
+
+    const ShaFunctions& GetBackend()
+    {
+        return *GetActiveBackend().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Feeds data through the 64-byte block buffer, compressing full blocks straight from the
+     * caller's memory where possible.
+     */
+    void Absorb(uint32_t* state, uint8_t* buffer, size_t& bufferSize, uint64_t& numBytes,
+                const CompressFn compress, const void* data, size_t length)
+    {
+        auto current = static_cast<const uint8_t*>(data);
+        numBytes += length;
+
+        if (bufferSize > 0)
+        {
+            const size_t take = std::min(length, 64 - bufferSize);
+            std::memcpy(buffer + bufferSize, current, take);
+            bufferSize += take;
+            current += take;
+            length -= take;
+
+            if (bufferSize < 64)
+            {
+                return;
+            }
+
+            compress(state, buffer, 1);
+            bufferSize = 0;
+        }
+
+        if (const size_t blocks = length / 64; blocks > 0)
+        {
+            compress(state, current, blocks);
+            current += blocks * 64;
+            length -= blocks * 64;
+        }
+
+        if (length > 0)
+        {
+            std::memcpy(buffer, current, length);
+            bufferSize = length;
+        }
+    }
+
+    /**
+     * Applies the Merkle-Damgård padding (shared by SHA-1 and SHA-256) to a copy of the state
+     * and writes the big-endian digest.
+     */
+    void Finish(const uint32_t* state, const size_t words, const uint8_t* buffer, const size_t bufferSize,
+                const uint64_t numBytes, const CompressFn compress, unsigned char* digest)
+    {
+        uint32_t copy[ 8 ];
+        std::memcpy(copy, state, words * sizeof(uint32_t));
+
+        uint8_t tail[ 128 ]{};
+        std::memcpy(tail, buffer, bufferSize);
+        tail[ bufferSize ] = 0x80;
+
+        const size_t tailSize = bufferSize + 1 + 8 <= 64 ? 64 : 128;
+        const uint64_t numBits = numBytes * 8;
+        for (int i = 0; i < 8; i++)
+        {
+            tail[ tailSize - 1 - i ] = static_cast<uint8_t>(numBits >> (i * 8));
+        }
+
+        compress(copy, tail, tailSize / 64);
+
+        for (size_t i = 0; i < words; i++)
+        {
+            digest[ i * 4 + 0 ] = static_cast<unsigned char>(copy[ i ] >> 24);
+            digest[ i * 4 + 1 ] = static_cast<unsigned char>(copy[ i ] >> 16);
+            digest[ i * 4 + 2 ] = static_cast<unsigned char>(copy[ i ] >> 8);
+            digest[ i * 4 + 3 ] = static_cast<unsigned char>(copy[ i ]);
+        }
+    }
+
+    /**
+     * Writes hasher states in a fixed little-endian encoding, independent of how the compiler
+     * lays out the objects holding them.
+     */
+    class StateWriter
+    {
+        std::string out;
+
+    public:
+        template <std::unsigned_integral T>
+        void Value(const T value)
+        {
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                out.push_back(static_cast<char>(static_cast<uint8_t>(value >> (i * 8))));
+            }
+        }
+
+        template <std::unsigned_integral T>
+        void Values(const T* values, const size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                Value(values[ i ]);
+            }
+        }
+
+        void Bytes(const void* data, const size_t length)
+        {
+            out.append(static_cast<const char*>(data), length);
+        }
+
+        [[nodiscard]] std::string Take() { return std::move(out); }
+    };
+
+    /**
+     * Reads what StateWriter wrote, failing on anything running past the end.
+     */
+    class StateReader
+    {
+        std::string_view in;
+
+    public:
+        explicit StateReader(const std::string_view in) : in(in)
+        {
+        }
+
+        template <std::unsigned_integral T>
+        bool Value(T& value)
+        {
+            if (in.size() < sizeof(T))
+            {
+                return false;
+            }
+
+            value = 0;
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                value |= static_cast<T>(static_cast<T>(static_cast<uint8_t>(in[ i ])) << (i * 8));
+            }
+
+            in.remove_prefix(sizeof(T));
+            return true;
+        }
+
+        template <std::unsigned_integral T>
+        bool Values(T* values, const size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!Value(values[ i ]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool Bytes(void* data, const size_t length)
+        {
+            if (in.size() < length)
+            {
+                return false;
+            }
+
+            std::memcpy(data, in.data(), length);
+            in.remove_prefix(length);
+            return true;
+        }
+
+        [[nodiscard]] bool IsAtEnd() const { return in.empty(); }
+    };
+
+    // the buffer always holds the bytes past the last full block, so numBytes implies its size
+    std::string SaveShaState(const uint64_t numBytes, const uint32_t* words, const size_t wordCount,
+                             const uint8_t* buffer)
+    {
+        StateWriter writer;
+        writer.Value(numBytes);
+        writer.Values(words, wordCount);
+        writer.Bytes(buffer, numBytes % 64);
+        return writer.Take();
+    }
+
+    bool LoadShaState(const std::string_view saved, const uint64_t numBytes, uint32_t* words, const size_t wordCount,
+                      uint8_t* buffer)
+    {
+        StateReader reader(saved);
+        uint64_t savedBytes = 0;
+
+        return reader.Value(savedBytes) && savedBytes == numBytes && reader.Values(words, wordCount) &&
+            reader.Bytes(buffer, numBytes % 64) && reader.IsAtEnd();
+    }
+
+    std::string ToHex(const unsigned char* digest, const size_t length)
+    {
+        static constexpr char dec2hex[ 16 + 1 ] = "0123456789abcdef";
+
+        std::string result;
+        result.reserve(length * 2);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            result += dec2hex[ (digest[ i ] >> 4) & 15 ];
+            result += dec2hex[ digest[ i ] & 15 ];
+        }
+
+        return result;
+    }
+}
+
+const char* hashing::GetShaBackendName()
+{
+    return GetBackend().name;
+}
+
+bool hashing::SetShaBackend(const ShaBackend backend)
+{
+    const ShaFunctions* functions = FindBackend(backend);
+    if (functions == nullptr)
+    {
+        return false;
+    }
+
+    GetActiveBackend().store(functions, std::memory_order_relaxed);
+    return true;
+}
+
+#pragma region SHA-256
+
+hashing::AcceleratedSHA256::AcceleratedSHA256()
+{
+    reset();
+}
+
+std::string hashing::AcceleratedSHA256::operator()(const void* data, const size_t numBytes)
+{
+    reset();
+    add(data, numBytes);
+    return getHash();
+}
+
+std::string hashing::AcceleratedSHA256::operator()(const std::string& text)
+{
+    return operator()(text.data(), text.size());
+}
+
+void hashing::AcceleratedSHA256::add(const void* data, const size_t numBytes)
+{
+    Absorb(hash, buffer, bufferSize, this->numBytes, GetBackend().sha256, data, numBytes);
+}
+
+std::string hashing::AcceleratedSHA256::getHash()
+{
+    unsigned char digest[ HashBytes ];
+    getHash(digest);
+    return ToHex(digest, HashBytes);
+}
+
+void hashing::AcceleratedSHA256::getHash(unsigned char buffer[ HashBytes ])
+{
+    Finish(hash, HashBytes / 4, this->buffer, bufferSize, numBytes, GetBackend().sha256, buffer);
+}
+
+void hashing::AcceleratedSHA256::reset()
+{
+    numBytes = 0;
+    bufferSize = 0;
+    std::memcpy(hash, SHA256_INIT, sizeof(hash));
+}
+
+std::string hashing::AcceleratedSHA256::saveState() const
+{
+    return SaveShaState(numBytes, hash, HashBytes / 4, buffer);
+}
+
+bool hashing::AcceleratedSHA256::loadState(const std::string_view saved, const uint64_t numBytes)
+{
+    if (!LoadShaState(saved, numBytes, hash, HashBytes / 4, buffer))
+    {
+        reset();
+        return false;
+    }
+
+    this->numBytes = numBytes;
+    bufferSize = numBytes % BlockSize;
+    return true;
+}
+
+#pragma endregion
+
+#pragma region SHA-1
+
+hashing::AcceleratedSHA1::AcceleratedSHA1()
+{
+    reset();
+}
+
+std::string hashing::AcceleratedSHA1::operator()(const void* data, const size_t numBytes)
+{
+    reset();
+    add(data, numBytes);
+    return getHash();
+}
+
+std::string hashing::AcceleratedSHA1::operator()(const std::string& text)
+{
+    return operator()(text.data(), text.size());
+}
+
+void hashing::AcceleratedSHA1::add(const void* data, const size_t numBytes)
+{
+    Absorb(hash, buffer, bufferSize, this->numBytes, GetBackend().sha1, data, numBytes);
+}
+
+std::string hashing::AcceleratedSHA1::getHash()
+{
+    unsigned char digest[ HashBytes ];
+    getHash(digest);
+    return ToHex(digest, HashBytes);
+}
+
+void hashing::AcceleratedSHA1::getHash(unsigned char buffer[ HashBytes ])
+{
+    Finish(hash, HashBytes / 4, this->buffer, bufferSize, numBytes, GetBackend().sha1, buffer);
+}
+
+void hashing::AcceleratedSHA1::reset()
+{
+    numBytes = 0;
+    bufferSize = 0;
+    std::memcpy(hash, SHA1_INIT, sizeof(hash));
+}
+
+std::string hashing::AcceleratedSHA1::saveState() const
+{
+    return SaveShaState(numBytes, hash, HashBytes / 4, buffer);
+}
+
+bool hashing::AcceleratedSHA1::loadState(const std::string_view saved, const uint64_t numBytes)
+{
+    if (!LoadShaState(saved, numBytes, hash, HashBytes / 4, buffer))
+    {
+        reset();
+        return false;
+    }
+
+    this->numBytes = numBytes;
+    bufferSize = numBytes % BlockSize;
+    return true;
+}
+
+#pragma endregion
+
+#pragma region BLAKE3
+
+hashing::Blake3::Blake3()
+{
+    reset();
+}
+
+std::string hashing::Blake3::operator()(const void* data, const size_t numBytes)
+{
+    reset();
+    add(data, numBytes);
+    return getHash();
+}
+
+std::string hashing::Blake3::operator()(const std::string& text)
+{
+    return operator()(text.data(), text.size());
+}
+
+void hashing::Blake3::add(const void* data, const size_t numBytes)
+{
+#if defined(BLAKE3_USE_TBB)
+    if (numBytes >= BLAKE3_PARALLEL_MIN_SIZE)
+    {
+        blake3_hasher_update_tbb(&hasher, data, numBytes);
+        return;
+    }
+#endif
+
+    blake3_hasher_update(&hasher, data, numBytes);
+}
+
+std::string hashing::Blake3::getHash()
+{
+    unsigned char digest[ HashBytes ];
+    blake3_hasher_finalize(&hasher, digest, HashBytes);
+    return ToHex(digest, HashBytes);
+}
+
+void hashing::Blake3::reset()
+{
+    blake3_hasher_init(&hasher);
+}
+
+std::string hashing::Blake3::saveState() const
+{
+    const auto& chunk = hasher.chunk;
+
+    StateWriter writer;
+    writer.Values(chunk.cv, std::size(chunk.cv));
+    writer.Value(chunk.chunk_counter);
+    writer.Value(chunk.blocks_compressed);
+    writer.Value(chunk.buf_len);
+    writer.Bytes(chunk.buf, chunk.buf_len);
+    writer.Value(hasher.cv_stack_len);
+    writer.Bytes(hasher.cv_stack, static_cast<size_t>(hasher.cv_stack_len) * BLAKE3_OUT_LEN);
+    return writer.Take();
+}
+
+bool hashing::Blake3::loadState(const std::string_view saved, const uint64_t numBytes)
+{
+    constexpr uint64_t blocksPerChunk = BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN;
+
+    // the key and flags of the default hash mode, the rest is overwritten
+    reset();
+    auto& chunk = hasher.chunk;
+    StateReader reader(saved);
+
+    const bool isRead = reader.Values(chunk.cv, std::size(chunk.cv)) && reader.Value(chunk.chunk_counter) &&
+        reader.Value(chunk.blocks_compressed) && reader.Value(chunk.buf_len) &&
+        chunk.buf_len <= BLAKE3_BLOCK_LEN && reader.Bytes(chunk.buf, chunk.buf_len) &&
+        reader.Value(hasher.cv_stack_len) && hasher.cv_stack_len <= BLAKE3_MAX_DEPTH + 1 &&
+        reader.Bytes(hasher.cv_stack, static_cast<size_t>(hasher.cv_stack_len) * BLAKE3_OUT_LEN) &&
+        reader.IsAtEnd();
+
+    if (!isRead)
+    {
+        reset();
+        return false;
+    }
+
+    // A full block stays buffered until more input arrives, it may be the chunk's last one.
+    const uint64_t chunkLength = chunk.blocks_compressed * BLAKE3_BLOCK_LEN + chunk.buf_len;
+
+    // Updating and finalizing index into the subtree stack, which must hold what an update leaves
+    // behind: one chaining value per set bit of the chunk counter if input is left in the current
+    // chunk, at least an unmerged pair if the update ended on a subtree boundary.
+    const bool isStackValid = chunkLength > 0
+                                  ? hasher.cv_stack_len == std::popcount(chunk.chunk_counter)
+                                  : chunk.chunk_counter == 0
+                                  ? hasher.cv_stack_len == 0
+                                  : hasher.cv_stack_len >= 2;
+
+    if (chunk.blocks_compressed >= blocksPerChunk || !isStackValid ||
+        chunk.chunk_counter > numBytes / BLAKE3_CHUNK_LEN ||
+        chunk.chunk_counter * BLAKE3_CHUNK_LEN + chunkLength != numBytes)
+    {
+        reset();
+        return false;
+    }
+
+    return true;
+}
+
+#pragma endregion
+
+#pragma region XXH3-128
+
+hashing::Xxh3_128::Xxh3_128()
+{
+    // the seed fields must be defined before the first reset of a state that isn't heap allocated
+    std::memset(&state, 0, sizeof(state));
+    reset();
+}
+
+std::string hashing::Xxh3_128::operator()(const void* data, const size_t numBytes)
+{
+    reset();
+    add(data, numBytes);
+    return getHash();
+}
+
+std::string hashing::Xxh3_128::operator()(const std::string& text)
+{
+    return operator()(text.data(), text.size());
+}
+
+void hashing::Xxh3_128::add(const void* data, const size_t numBytes)
+{
+    XXH3_128bits_update(&state, data, numBytes);
+}
+
+std::string hashing::Xxh3_128::getHash()
+{
+    XXH128_canonical_t canonical;
+    XXH128_canonicalFromHash(&canonical, XXH3_128bits_digest(&state));
+    return ToHex(canonical.digest, HashBytes);
+}
+
+void hashing::Xxh3_128::reset()
+{
+    XXH3_128bits_reset(&state);
+}
+
+std::string hashing::Xxh3_128::saveState() const
+{
+    StateWriter writer;
+    writer.Values(state.acc, std::size(state.acc));
+    // the whole buffer, the last stripe may be taken from before the buffered bytes
+    writer.Bytes(state.buffer, sizeof(state.buffer));
+    writer.Value(state.bufferedSize);
+    writer.Value(static_cast<uint64_t>(state.nbStripesSoFar));
+    writer.Value(state.totalLen);
+    return writer.Take();
+}
+
+bool hashing::Xxh3_128::loadState(const std::string_view saved, const uint64_t numBytes)
+{
+    // the default secret and seed, the running values are overwritten
+    reset();
+    StateReader reader(saved);
+    uint64_t stripes = 0;
+
+    const bool isRead = reader.Values(state.acc, std::size(state.acc)) &&
+        reader.Bytes(state.buffer, sizeof(state.buffer)) && reader.Value(state.bufferedSize) &&
+        reader.Value(stripes) && reader.Value(state.totalLen) && reader.IsAtEnd();
+
+    // short input is only ever buffered, longer input always leaves some buffered
+    if (!isRead || state.totalLen != numBytes || state.bufferedSize > sizeof(state.buffer) ||
+        state.bufferedSize > numBytes || (numBytes > 0 && state.bufferedSize == 0) ||
+        (numBytes <= sizeof(state.buffer) && state.bufferedSize != numBytes) ||
+        stripes >= state.nbStripesPerBlock)
+    {
+        reset();
+        return false;
+    }
+
+    state.nbStripesSoFar = static_cast<size_t>(stripes);
+    return true;
+}
+
+#pragma endregion
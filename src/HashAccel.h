@@ -0,0 +1,215 @@
+#pragma once
+
+#include <hash-library/hash.h>
+#include <blake3.h>
+#ifndef XXH_STATIC_LINKING_ONLY
+#define XXH_STATIC_LINKING_ONLY
+#endif
+#include <xxhash.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+namespace hashing
+{
+    /**
+     * \brief Name of the SHA block function picked for this CPU, e.g. for the log.
+     */
+    const char* GetShaBackendName();
+
+    /**
+     * \brief Implementations of the SHA block functions, see AcceleratedSHA256.
+     */
+    enum class ShaBackend
+    {
+        /** The fastest one this CPU supports, the default */
+        Auto,
+        Portable,
+        /** x86/x64 SHA extensions */
+        ShaNi,
+    };
+
+    /**
+     * \brief Replaces the block functions picked for this CPU, so tests can cover each backend.
+     * \return False if this build or CPU doesn't support the backend, nothing changes then.
+     * \remarks All backends produce identical states, so running hashers may switch midway.
+     */
+    bool SetShaBackend(ShaBackend backend);
+
+    /**
+     * \brief SHA-256 with the same interface as hash-library's SHA256, using the CPU's SHA
+     *        extensions when available.
+     *
+     * The block function is selected once per process (unless SetShaBackend overrides it): SHA-NI
+     * on x86/x64 CPUs that have it (Intel Goldmont/Ice Lake and newer, AMD Zen), the portable
+     * implementation otherwise. saveState and loadState carry the running state over to another
+     * process, e.g. to resume a download.
+     */
+    class AcceleratedSHA256 : public Hash
+    {
+    public:
+        enum { BlockSize = 512 / 8, HashBytes = 32 };
+
+        AcceleratedSHA256();
+
+        std::string operator()(const void* data, size_t numBytes) override;
+        std::string operator()(const std::string& text) override;
+
+        void add(const void* data, size_t numBytes) override;
+
+        /** Lower-case hex digest of the data added so far, the running state is not altered */
+        std::string getHash() override;
+        void getHash(unsigned char buffer[ HashBytes ]);
+
+        void reset() override;
+
+        /**
+         * \brief Encodes the running state: byte count, chaining words and buffered bytes, little-endian.
+         */
+        [[nodiscard]] std::string saveState() const;
+
+        /**
+         * \brief Continues from a state encoded by saveState, possibly in another process.
+         * \return False if the encoding is malformed or isn't a state numBytes bytes of input lead
+         *         to; the instance is reset then.
+         */
+        [[nodiscard]] bool loadState(std::string_view saved, uint64_t numBytes);
+
+    private:
+        uint64_t numBytes;
+        size_t bufferSize;
+        uint8_t buffer[ BlockSize ];
+        uint32_t hash[ HashBytes / 4 ];
+    };
+
+    /**
+     * \brief SHA-1 with the same interface as hash-library's SHA1, using the CPU's SHA
+     *        extensions when available. See AcceleratedSHA256.
+     */
+    class AcceleratedSHA1 : public Hash
+    {
+    public:
+        enum { BlockSize = 512 / 8, HashBytes = 20 };
+
+        AcceleratedSHA1();
+
+        std::string operator()(const void* data, size_t numBytes) override;
+        std::string operator()(const std::string& text) override;
+
+        void add(const void* data, size_t numBytes) override;
+
+        /** Lower-case hex digest of the data added so far, the running state is not altered */
+        std::string getHash() override;
+        void getHash(unsigned char buffer[ HashBytes ]);
+
+        void reset() override;
+
+        /**
+         * \brief Encodes the running state: byte count, chaining words and buffered bytes, little-endian.
+         */
+        [[nodiscard]] std::string saveState() const;
+
+        /**
+         * \brief Continues from a state encoded by saveState, possibly in another process.
+         * \return False if the encoding is malformed or isn't a state numBytes bytes of input lead
+         *         to; the instance is reset then.
+         */
+        [[nodiscard]] bool loadState(std::string_view saved, uint64_t numBytes);
+
+    private:
+        uint64_t numBytes;
+        size_t bufferSize;
+        uint8_t buffer[ BlockSize ];
+        uint32_t hash[ HashBytes / 4 ];
+    };
+
+    /**
+     * \brief Blocks fed to Blake3 at once from this size on are hashed multithreaded; below that,
+     *        handing the work to other threads costs more than it saves.
+     */
+    constexpr size_t BLAKE3_PARALLEL_MIN_SIZE = 1024 * 1024;
+
+    /**
+     * \brief BLAKE3 with the hash-library interface and the default 256-bit output.
+     *
+     * Uses the widest SIMD instruction set the CPU offers. If the library was built with TBB
+     * support, blocks of at least BLAKE3_PARALLEL_MIN_SIZE bytes are split into subtrees that
+     * are hashed on all cores.
+     */
+    class Blake3 : public Hash
+    {
+    public:
+        enum { HashBytes = BLAKE3_OUT_LEN };
+
+        Blake3();
+
+        std::string operator()(const void* data, size_t numBytes) override;
+        std::string operator()(const std::string& text) override;
+
+        void add(const void* data, size_t numBytes) override;
+
+        /** Lower-case hex digest of the data added so far, the running state is not altered */
+        std::string getHash() override;
+
+        void reset() override;
+
+        /**
+         * \brief Encodes the running state: the current chunk's chaining value, counter and buffered
+         *        bytes and the subtree chaining values, little-endian.
+         */
+        [[nodiscard]] std::string saveState() const;
+
+        /**
+         * \brief Continues from a state encoded by saveState, possibly in another process.
+         * \return False if the encoding is malformed or isn't a state numBytes bytes of input lead
+         *         to; the instance is reset then.
+         */
+        [[nodiscard]] bool loadState(std::string_view saved, uint64_t numBytes);
+
+    private:
+        blake3_hasher hasher;
+    };
+
+    /**
+     * \brief 128-bit XXH3 with the hash-library interface. The digest is the canonical
+     *        (big-endian) form, as printed by xxhsum -H2.
+     *
+     * Not a cryptographic hash, so it's only accepted for change detection and never to verify
+     * a download.
+     */
+    class Xxh3_128 : public Hash
+    {
+    public:
+        enum { HashBytes = 16 };
+
+        Xxh3_128();
+
+        std::string operator()(const void* data, size_t numBytes) override;
+        std::string operator()(const std::string& text) override;
+
+        void add(const void* data, size_t numBytes) override;
+
+        /** Lower-case hex digest of the data added so far, the running state is not altered */
+        std::string getHash() override;
+
+        void reset() override;
+
+        /**
+         * \brief Encodes the running state: accumulators, input buffer, stripe count and length,
+         *        little-endian. The default secret and seed aren't part of it.
+         */
+        [[nodiscard]] std::string saveState() const;
+
+        /**
+         * \brief Continues from a state encoded by saveState, possibly in another process.
+         * \return False if the encoding is malformed or isn't a state numBytes bytes of input lead
+         *         to; the instance is reset then.
+         */
+        [[nodiscard]] bool loadState(std::string_view saved, uint64_t numBytes);
+
+    private:
+        XXH3_state_t state;
+    };
+}
@@ -0,0 +1,397 @@
+#include "pch.h"
+#include "Util.h"
+#include "Hashing.h"
+
+#include <charconv>
+
+
+namespace
+{
+    std::string ToHex(const uint8_t* data, const size_t length)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+
+        std::string hex(length * 2, '\0');
+        for (size_t i = 0; i < length; i++)
+        {
+            hex[ i * 2 ] = digits[ data[ i ] >> 4 ];
+            hex[ i * 2 + 1 ] = digits[ data[ i ] & 0x0F ];
+        }
+
+        return hex;
+    }
+
+    bool FromHex(const std::string& hex, std::vector<uint8_t>& out)
+    {
+        if (hex.size() % 2 != 0)
+        {
+            return false;
+        }
+
+        out.resize(hex.size() / 2);
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            const auto [ptr, ec] = std::from_chars(hex.data() + i * 2, hex.data() + i * 2 + 2, out[ i ], 16);
+            if (ec != std::errc{} || ptr != hex.data() + i * 2 + 2)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /** Leads every exported state, bumped whenever any algorithm's encoding changes */
+    constexpr uint8_t STATE_FORMAT_VERSION = 1;
+
+    /*
+     * hash-library keeps MD5's state private, so an MD5 download can't be resumed from a journal
+     * and re-hashes the downloaded part instead, see CatchUpWithFile.
+     */
+    template <typename T>
+    concept ResumableHash = requires(T alg, const T constAlg, std::string_view saved, uint64_t length)
+    {
+        { constAlg.saveState() } -> std::same_as<std::string>;
+        { alg.loadState(saved, length) } -> std::same_as<bool>;
+    };
+
+    /** Identifies the algorithm of an exported state, values are part of the format */
+    template <typename T>
+    constexpr uint8_t STATE_TAG = 0;
+
+    template <>
+    constexpr uint8_t STATE_TAG<hashing::AcceleratedSHA1> = 1;
+
+    template <>
+    constexpr uint8_t STATE_TAG<hashing::AcceleratedSHA256> = 2;
+
+    template <>
+    constexpr uint8_t STATE_TAG<hashing::Blake3> = 3;
+
+    template <>
+    constexpr uint8_t STATE_TAG<hashing::Xxh3_128> = 4;
+}
+
+namespace hashing
+{
+    IncrementalHasher::IncrementalHasher(const models::ChecksumAlgorithm alg) : algorithm(alg)
+    {
+        Reset();
+    }
+
+    void IncrementalHasher::Add(const void* data, const size_t length)
+    {
+        if (length == 0)
+        {
+            return;
+        }
+
+        std::visit([data, length]<typename T>(T& alg)
+        {
+            if constexpr (!std::is_same_v<T, std::monostate>)
+            {
+                alg.add(data, length);
+            }
+        }, state);
+
+        bytesHashed += length;
+    }
+
+    bool IncrementalHasher::CatchUpWithFile(const std::filesystem::path& filePath, const uint64_t length)
+    {
+        if (bytesHashed >= length) return bytesHashed == length;
+
+        const uint64_t start = bytesHashed;
+        const auto read = io::ReadSequential(filePath, start, length, [this](const uint8_t* data, const size_t size)
+        {
+            Add(data, size);
+            return true;
+        });
+
+        return read.has_value() && read.value() == length - start;
+    }
+
+    std::string IncrementalHasher::GetHash() const
+    {
+        // hash-library finalizes on a scratch copy internally but isn't const-correct
+        auto snapshot = state;
+
+        return std::visit([]<typename T>(T& alg) -> std::string
+        {
+            if constexpr (std::is_same_v<T, std::monostate>)
+            {
+                return {};
+            }
+            else
+            {
+                return alg.getHash();
+            }
+        }, snapshot);
+    }
+
+    void IncrementalHasher::Reset()
+    {
+        switch (algorithm)
+        {
+            case models::ChecksumAlgorithm::MD5:
+                state.emplace<MD5>();
+                break;
+            case models::ChecksumAlgorithm::SHA1:
+                state.emplace<AcceleratedSHA1>();
+                break;
+            case models::ChecksumAlgorithm::SHA256:
+                state.emplace<AcceleratedSHA256>();
+                break;
+            case models::ChecksumAlgorithm::BLAKE3:
+                state.emplace<Blake3>();
+                break;
+            case models::ChecksumAlgorithm::XXH3_128:
+                state.emplace<Xxh3_128>();
+                break;
+            case models::ChecksumAlgorithm::Invalid:
+                state.emplace<std::monostate>();
+                break;
+        }
+
+        bytesHashed = 0;
+    }
+
+    std::string IncrementalHasher::ExportState() const
+    {
+        return std::visit([]<typename T>(const T& alg) -> std::string
+        {
+            if constexpr (ResumableHash<T>)
+            {
+                static_assert(STATE_TAG<T> != 0);
+
+                std::string raw{static_cast<char>(STATE_FORMAT_VERSION), static_cast<char>(STATE_TAG<T>)};
+                raw += alg.saveState();
+                return ToHex(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+            }
+            else
+            {
+                return {};
+            }
+        }, state);
+    }
+
+    bool IncrementalHasher::ImportState(const uint64_t length, const std::string& exported, const std::string& digest)
+    {
+        Reset();
+
+        std::vector<uint8_t> raw{};
+        if (!FromHex(exported, raw))
+        {
+            return false;
+        }
+
+        /*
+         * loadState rejects states its finalization can't safely continue from, the digest check
+         * then catches states that are well-formed but don't belong to this download.
+         */
+        const bool restored = std::visit([&raw, length]<typename T>(T& alg) -> bool
+        {
+            if constexpr (ResumableHash<T>)
+            {
+                if (raw.size() < 2 || raw[ 0 ] != STATE_FORMAT_VERSION || raw[ 1 ] != STATE_TAG<T>)
+                {
+                    return false;
+                }
+
+                return alg.loadState(
+                    std::string_view(reinterpret_cast<const char*>(raw.data()) + 2, raw.size() - 2), length);
+            }
+            else
+            {
+                return false;
+            }
+        }, state);
+
+        if (!restored || GetHash() != digest)
+        {
+            Reset();
+            return false;
+        }
+
+        bytesHashed = length;
+        return true;
+    }
+
+    std::expected<std::vector<std::string>, std::string> HashFile(
+        const std::filesystem::path& filePath, const std::vector<models::ChecksumAlgorithm>& algorithms)
+    {
+        std::vector<IncrementalHasher> hashers{};
+        hashers.reserve(algorithms.size());
+
+        for (const auto alg : algorithms)
+        {
+            if (!hashers.emplace_back(alg).IsValid())
+            {
+                return std::unexpected(std::format("Unsupported checksum algorithm {}", magic_enum::enum_name(alg)));
+            }
+        }
+
+        const auto read = io::ReadSequential(filePath, 0, io::READ_TO_END,
+                                             [&hashers](const uint8_t* data, const size_t length)
+                                             {
+                                                 for (auto& hasher : hashers)
+                                                 {
+                                                     hasher.Add(data, length);
+                                                 }
+                                                 return true;
+                                             });
+
+        if (!read.has_value())
+        {
+            return std::unexpected(read.error());
+        }
+
+        std::vector<std::string> digests{};
+        digests.reserve(hashers.size());
+
+        for (const auto& hasher : hashers)
+        {
+            digests.push_back(hasher.GetHash());
+        }
+
+        return digests;
+    }
+
+    ChunkVerifier::ChunkVerifier(const models::ChecksumAlgorithm alg, const uint64_t chunkSize,
+                                 std::vector<std::string> digests)
+        : algorithm(alg), chunkSize(chunkSize), digests(std::move(digests)), current(alg)
+    {
+    }
+
+    void ChunkVerifier::Seek(const uint64_t chunkOffset)
+    {
+        offset = chunkSize > 0 ? chunkOffset - chunkOffset % chunkSize : 0;
+        current.Reset();
+    }
+
+    bool ChunkVerifier::Add(const void* data, const size_t length)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        size_t remaining = length;
+
+        while (remaining > 0)
+        {
+            const auto index = static_cast<size_t>(offset / chunkSize);
+
+            // more data than the digests describe
+            if (index >= digests.size())
+            {
+                Seek(offset);
+                return false;
+            }
+
+            const auto take = static_cast<size_t>(std::min<uint64_t>(remaining, chunkSize - offset % chunkSize));
+            current.Add(bytes, take);
+            bytes += take;
+            remaining -= take;
+            offset += take;
+
+            if (offset % chunkSize != 0)
+            {
+                continue;
+            }
+
+            const bool matches = util::icompare(current.GetHash(), digests[ index ]);
+            current.Reset();
+
+            if (!matches)
+            {
+                Seek(offset - chunkSize);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool ChunkVerifier::Finish()
+    {
+        const auto index = static_cast<size_t>(offset / chunkSize);
+
+        if (offset % chunkSize == 0)
+        {
+            // every chunk has been verified by Add already, unless the payload came up short
+            return index == digests.size();
+        }
+
+        const bool matches = index + 1 == digests.size() && util::icompare(current.GetHash(), digests[ index ]);
+
+        if (!matches)
+        {
+            Seek(offset);
+        }
+
+        return matches;
+    }
+
+    bool ChunkVerifier::VerifyChunk(const size_t index, const void* data, const size_t length) const
+    {
+        if (index >= digests.size())
+        {
+            return false;
+        }
+
+        IncrementalHasher hasher(algorithm);
+        hasher.Add(data, length);
+        return util::icompare(hasher.GetHash(), digests[ index ]);
+    }
+
+    std::expected<std::vector<size_t>, std::string> ChunkVerifier::FindCorruptChunks(
+        const std::filesystem::path& filePath, const uint64_t begin, const uint64_t end) const
+    {
+        std::vector<size_t> corrupt{};
+        IncrementalHasher hasher(algorithm);
+        uint64_t position = begin;
+
+        const auto read = io::ReadSequential(filePath, begin, end, [&](const uint8_t* data, size_t length)
+        {
+            while (length > 0)
+            {
+                const uint64_t chunkEnd = std::min(position - position % chunkSize + chunkSize, end);
+                const auto take = static_cast<size_t>(std::min<uint64_t>(length, chunkEnd - position));
+
+                hasher.Add(data, take);
+                data += take;
+                length -= take;
+                position += take;
+
+                if (position < chunkEnd)
+                {
+                    continue;
+                }
+
+                const uint64_t chunkLength = hasher.GetBytesHashed();
+                const auto index = static_cast<size_t>((position - chunkLength) / chunkSize);
+
+                // a short trailing chunk can only be the final one
+                const bool isPartial = chunkLength < chunkSize;
+                if (index >= digests.size() || (isPartial && index + 1 != digests.size()) ||
+                    !util::icompare(hasher.GetHash(), digests[ index ]))
+                {
+                    corrupt.push_back(index);
+                }
+
+                hasher.Reset();
+            }
+
+            return true;
+        });
+
+        if (!read.has_value())
+        {
+            return std::unexpected(read.error());
+        }
+
+        if (position < end)
+        {
+            return std::unexpected(std::format("Failed to read {}", filePath.string()));
+        }
+
+        return corrupt;
+    }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "models/CommonTypes.hpp"
+#include "HashAccel.h"
+#include "SequentialReader.h"
+
+#include <array>
+#include <tuple>
+
+
+namespace hashing
+{
+    /**
+     * \brief Incremental digest over one of the supported checksum algorithms.
+     *
+     * Fed from the download write path so the payload checksum is available the moment the
+     * transfer ends. The number of consumed bytes is tracked so a resumed transfer can tell
+     * whether the digest still matches the on-disk prefix it appends to.
+     */
+    class IncrementalHasher
+    {
+        std::variant<std::monostate, MD5, AcceleratedSHA1, AcceleratedSHA256, Blake3, Xxh3_128> state{};
+        models::ChecksumAlgorithm algorithm{models::ChecksumAlgorithm::Invalid};
+        uint64_t bytesHashed{0};
+
+    public:
+        IncrementalHasher() = default;
+        explicit IncrementalHasher(models::ChecksumAlgorithm alg);
+
+        /** True if a supported algorithm has been selected */
+        [[nodiscard]] bool IsValid() const { return !std::holds_alternative<std::monostate>(state); }
+
+        [[nodiscard]] models::ChecksumAlgorithm GetAlgorithm() const { return algorithm; }
+
+        /** Number of bytes fed into the digest so far */
+        [[nodiscard]] uint64_t GetBytesHashed() const { return bytesHashed; }
+
+        /**
+         * \brief Feeds a block of data into the digest.
+         */
+        void Add(const void* data, size_t length);
+
+        /**
+         * \brief Feeds the part of a file not yet covered by the digest, i.e. the bytes from
+         *        GetBytesHashed() up to length, so the digest matches the file's first length bytes.
+         * \param filePath The file to read.
+         * \param length The total number of leading file bytes the digest should cover.
+         * \return False if the file couldn't be opened or is shorter than length.
+         */
+        bool CatchUpWithFile(const std::filesystem::path& filePath, uint64_t length);
+
+        /**
+         * \brief Returns the lower-case hex digest of all data fed so far.
+         *        The running state is not altered, more data may be added afterwards.
+         */
+        [[nodiscard]] std::string GetHash() const;
+
+        /**
+         * \brief Discards all fed data, keeping the selected algorithm.
+         */
+        void Reset();
+
+        /**
+         * \brief Serializes the running state, so a later process can continue the digest.
+         * \return The state as hex string or an empty string if the algorithm's state can't be saved
+         *         (MD5, whose state hash-library keeps private) or no algorithm is selected.
+         * \remarks The encoding is versioned and independent of the build and the SHA backend.
+         */
+        [[nodiscard]] std::string ExportState() const;
+
+        /**
+         * \brief Restores a running state saved by ExportState.
+         * \param length The number of bytes the state covers; a state covering another number is rejected.
+         * \param exported The exported state.
+         * \param digest The value GetHash() returned when the state was exported; a damaged state or
+         *               one of another download doesn't reproduce it and is rejected.
+         * \return False if the state was rejected, the hasher is reset then.
+         */
+        bool ImportState(uint64_t length, const std::string& exported, const std::string& digest);
+    };
+
+    /**
+     * \brief Computes the digests of a whole file with a fixed set of hash types in one read pass.
+     * \return The lower-case hex digests in the order of the types or an error message if the file
+     *         couldn't be read.
+     */
+    template <typename... Hashes>
+        requires (sizeof...(Hashes) > 0 && (std::is_base_of_v<Hash, Hashes> && ...))
+    std::expected<std::array<std::string, sizeof...(Hashes)>, std::string> HashFile(
+        const std::filesystem::path& filePath)
+    {
+        std::tuple<Hashes...> hashes{};
+
+        const auto read = io::ReadSequential(filePath, 0, io::READ_TO_END,
+                                             [&hashes](const uint8_t* data, const size_t length)
+                                             {
+                                                 std::apply([data, length](auto&... alg)
+                                                 {
+                                                     (alg.add(data, length), ...);
+                                                 }, hashes);
+                                                 return true;
+                                             });
+
+        if (!read.has_value())
+        {
+            return std::unexpected(read.error());
+        }
+
+        return std::apply([](auto&... alg)
+        {
+            return std::array<std::string, sizeof...(Hashes)>{alg.getHash()...};
+        }, hashes);
+    }
+
+    /**
+     * \brief Computes the digests of a whole file for checksum algorithms picked at runtime, e.g. from
+     *        a manifest, in one read pass.
+     * \return The digests in the order of algorithms or an error message if the file couldn't be
+     *         read or an algorithm isn't supported.
+     */
+    std::expected<std::vector<std::string>, std::string> HashFile(
+        const std::filesystem::path& filePath, const std::vector<models::ChecksumAlgorithm>& algorithms);
+
+    /**
+     * \brief Checks a payload against per-chunk digests while it's written front to back.
+     *
+     * The payload is split into consecutive chunks of a fixed size (the last one may be shorter),
+     * each with its own digest. A corrupt block is detected as soon as its chunk is complete rather
+     * than after the whole transfer, and a partial file left on disk can be checked chunk by chunk
+     * so only the bad chunks have to be fetched again.
+     */
+    class ChunkVerifier
+    {
+        models::ChecksumAlgorithm algorithm{models::ChecksumAlgorithm::Invalid};
+        uint64_t chunkSize{0};
+        std::vector<std::string> digests{};
+        IncrementalHasher current{};
+        uint64_t offset{0};
+
+    public:
+        ChunkVerifier() = default;
+        ChunkVerifier(models::ChecksumAlgorithm alg, uint64_t chunkSize, std::vector<std::string> digests);
+
+        /** True if there's anything to verify against */
+        [[nodiscard]] bool IsEnabled() const { return chunkSize > 0 && !digests.empty() && current.IsValid(); }
+
+        [[nodiscard]] uint64_t GetChunkSize() const { return chunkSize; }
+
+        [[nodiscard]] size_t GetChunkCount() const { return digests.size(); }
+
+        /** Offset of the next byte expected by Add */
+        [[nodiscard]] uint64_t GetOffset() const { return offset; }
+
+        /** Number of leading bytes fed and verified, i.e. the start of the chunk currently being fed */
+        [[nodiscard]] uint64_t GetVerifiedLength() const { return chunkSize > 0 ? offset - offset % chunkSize : 0; }
+
+        /**
+         * \brief Continues verification at the given chunk boundary, dropping a partially fed chunk.
+         */
+        void Seek(uint64_t chunkOffset);
+
+        /**
+         * \brief Feeds the next block of the payload, verifying every chunk it completes.
+         * \return False if a chunk didn't match; the verifier is then positioned at the start of that chunk.
+         */
+        bool Add(const void* data, size_t length);
+
+        /**
+         * \brief Verifies the final chunk once the payload has been fed completely.
+         * \return False if the final chunk didn't match or chunks are missing; the verifier is then
+         *         positioned at the start of the first chunk that needs to be fetched again.
+         */
+        bool Finish();
+
+        /**
+         * \brief Verifies a single complete chunk.
+         */
+        [[nodiscard]] bool VerifyChunk(size_t index, const void* data, size_t length) const;
+
+        /**
+         * \brief Checks the chunks of a file between two offsets.
+         * \param filePath The file to read.
+         * \param begin The offset to start at, must be a chunk boundary.
+         * \param end The offset to stop at; if it doesn't fall onto a chunk boundary the trailing bytes
+         *            are checked as the payload's final chunk.
+         * \return The indexes of the chunks that didn't match or an error message if reading failed.
+         */
+        [[nodiscard]] std::expected<std::vector<size_t>, std::string> FindCorruptChunks(
+            const std::filesystem::path& filePath, uint64_t begin, uint64_t end) const;
+    };
+}
@@ -1,13 +1,282 @@
 #include "pch.h"
 #include "Http.h"
+#include "CancellableTransfer.h"
 
 #include <curlpp/cURLpp.hpp>
 #include <curlpp/Easy.hpp>
+#include <curlpp/Exception.hpp>
 #include <curlpp/Options.hpp>
 
 
 namespace web
 {
+    void PooledEasyDeleter::operator()(curlpp::Easy* easy) const
+    {
+        TransferContext::Instance().Release(easy);
+    }
+
+    TransferContext::TransferContext()
+    {
+        share = curl_share_init();
+        if (share == nullptr)
+        {
+            spdlog::warn("Failed to create cURL share handle, transfers won't share DNS and TLS sessions");
+            return;
+        }
+
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &TransferContext::OnShareLock);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &TransferContext::OnShareUnlock);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        // not CURL_LOCK_DATA_CONNECT: libcurl doesn't support a shared connection cache used by
+        // concurrent transfers, which the manifest race, signature fetch and segments are
+    }
+
+    TransferContext::~TransferContext()
+    {
+        Shutdown();
+    }
+
+    TransferContext& TransferContext::Instance()
+    {
+        static TransferContext instance;
+        return instance;
+    }
+
+    void TransferContext::OnShareLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr)
+    {
+        UNREFERENCED_PARAMETER(handle);
+        UNREFERENCED_PARAMETER(access);
+        static_cast<TransferContext*>(userptr)->shareLocks[ data ].lock();
+    }
+
+    void TransferContext::OnShareUnlock(CURL* handle, curl_lock_data data, void* userptr)
+    {
+        UNREFERENCED_PARAMETER(handle);
+        static_cast<TransferContext*>(userptr)->shareLocks[ data ].unlock();
+    }
+
+    EasyHandle TransferContext::Acquire()
+    {
+        std::unique_ptr<curlpp::Easy> easy{};
+
+        {
+            std::lock_guard lock(poolLock);
+            if (!pool.empty())
+            {
+                easy = std::move(pool.back());
+                pool.pop_back();
+            }
+        }
+
+        if (!easy)
+        {
+            easy = std::make_unique<curlpp::Easy>();
+        }
+
+        Attach(*easy);
+        return EasyHandle(easy.release());
+    }
+
+    void TransferContext::Release(curlpp::Easy* easy)
+    {
+        std::unique_ptr<curlpp::Easy> owned(easy);
+        if (!owned)
+        {
+            return;
+        }
+
+        // drops all options and callbacks (which may reference the caller's stack) but keeps
+        // the handle's own connection and caches alive for the next user
+        owned->reset();
+
+        std::lock_guard lock(poolLock);
+        if (!isShutDown && pool.size() < MAX_POOLED_HANDLES)
+        {
+            pool.push_back(std::move(owned));
+        }
+    }
+
+    void TransferContext::Attach(curlpp::Easy& easy) const
+    {
+        CURL* handle = easy.getHandle();
+
+        if (share != nullptr)
+        {
+            curl_easy_setopt(handle, CURLOPT_SHARE, share);
+        }
+
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+    }
+
+    TransferTiming TransferContext::RecordTransfer(curlpp::Easy& easy)
+    {
+        CURL* handle = easy.getHandle();
+        TransferTiming timing{};
+
+        auto getTime = [handle](const CURLINFO info) -> std::chrono::microseconds
+        {
+            curl_off_t value = 0;
+            curl_easy_getinfo(handle, info, &value);
+            return std::chrono::microseconds{value};
+        };
+
+        auto getSize = [handle](const CURLINFO info) -> uint64_t
+        {
+            curl_off_t value = 0;
+            curl_easy_getinfo(handle, info, &value);
+            return static_cast<uint64_t>(std::max<curl_off_t>(value, 0));
+        };
+
+        const char* effectiveUrl = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &effectiveUrl);
+        timing.url = effectiveUrl != nullptr ? effectiveUrl : "";
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &timing.httpCode);
+        curl_easy_getinfo(handle, CURLINFO_REDIRECT_COUNT, &timing.redirectCount);
+
+        timing.nameLookup = getTime(CURLINFO_NAMELOOKUP_TIME_T);
+        timing.connect = getTime(CURLINFO_CONNECT_TIME_T);
+        timing.appConnect = getTime(CURLINFO_APPCONNECT_TIME_T);
+        timing.startTransfer = getTime(CURLINFO_STARTTRANSFER_TIME_T);
+        timing.total = getTime(CURLINFO_TOTAL_TIME_T);
+        timing.bytesDownloaded = getSize(CURLINFO_SIZE_DOWNLOAD_T);
+        timing.averageSpeed = getSize(CURLINFO_SPEED_DOWNLOAD_T);
+
+        long connects = 0;
+        char* primaryIp = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_getinfo(handle, CURLINFO_PRIMARY_IP, &primaryIp);
+
+        // no new connection but a peer address means an existing connection was picked up
+        timing.connectionReused = connects == 0 && primaryIp != nullptr && *primaryIp != '\0';
+
+        transfers.fetch_add(1, std::memory_order_relaxed);
+
+        if (timing.connectionReused)
+        {
+            reusedConnections.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            newConnections.fetch_add(static_cast<uint64_t>(connects), std::memory_order_relaxed);
+        }
+
+        auto toMs = [](const std::chrono::microseconds us) { return static_cast<double>(us.count()) / 1000.0; };
+
+        // info, not debug: the default log level of a user reporting a slow update must capture it
+        spdlog::info("Transfer timing: url={} status={} dns_ms={:.1f} connect_ms={:.1f} tls_ms={:.1f} "
+                     "ttfb_ms={:.1f} total_ms={:.1f} bytes={} speed_bps={} redirects={} reused={}",
+                     timing.url, timing.httpCode, toMs(timing.nameLookup), toMs(timing.connect),
+                     toMs(timing.appConnect), toMs(timing.startTransfer), toMs(timing.total),
+                     timing.bytesDownloaded, timing.averageSpeed, timing.redirectCount, timing.connectionReused);
+
+        std::lock_guard lock(reportLock);
+        if (report.is_open())
+        {
+            const nlohmann::json entry = {
+                {"timestamp", std::format("{:%FT%TZ}", std::chrono::floor<std::chrono::milliseconds>(
+                                              std::chrono::system_clock::now()))},
+                {"url", timing.url},
+                {"status", timing.httpCode},
+                {"nameLookupUs", timing.nameLookup.count()},
+                {"connectUs", timing.connect.count()},
+                {"appConnectUs", timing.appConnect.count()},
+                {"startTransferUs", timing.startTransfer.count()},
+                {"totalUs", timing.total.count()},
+                {"bytesDownloaded", timing.bytesDownloaded},
+                {"averageSpeed", timing.averageSpeed},
+                {"redirectCount", timing.redirectCount},
+                {"connectionReused", timing.connectionReused},
+            };
+
+            // URLs may carry arbitrary bytes; never let the report break a transfer
+            report << entry.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+            report.flush();
+        }
+
+        return timing;
+    }
+
+    void TransferContext::EnableTimingReport(const std::filesystem::path& reportPath)
+    {
+        std::lock_guard lock(reportLock);
+
+        report.close();
+        report.clear();
+        report.open(reportPath, std::ios::out | std::ios::app);
+
+        if (!report.is_open())
+        {
+            spdlog::warn("Failed to open timing report {}", reportPath.string());
+            return;
+        }
+
+        spdlog::info("Writing transfer timing report to {}", reportPath.string());
+    }
+
+    TransferStats TransferContext::GetStats() const
+    {
+        return {
+            .transfers = transfers.load(std::memory_order_relaxed),
+            .reusedConnections = reusedConnections.load(std::memory_order_relaxed),
+            .newConnections = newConnections.load(std::memory_order_relaxed),
+        };
+    }
+
+    void TransferContext::Shutdown()
+    {
+        {
+            std::lock_guard lock(poolLock);
+            if (isShutDown)
+            {
+                return;
+            }
+            isShutDown = true;
+            pool.clear();
+        }
+
+        const auto stats = GetStats();
+        spdlog::debug("Transfer stats: {} transfer(s), {} reused connection(s), {} new connection(s)",
+                      stats.transfers, stats.reusedConnections, stats.newConnections);
+
+        if (share != nullptr)
+        {
+            // fails if a handle is still attached (e.g. a detached image download); leak it then
+            if (const CURLSHcode rc = curl_share_cleanup(share); rc != CURLSHE_OK)
+            {
+                spdlog::warn("Failed to clean up cURL share handle: {}", curl_share_strerror(rc));
+            }
+            share = nullptr;
+        }
+    }
+
+    static int OnTransferInfo(void* clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                              curl_off_t ulnow)
+    {
+        UNREFERENCED_PARAMETER(ultotal);
+        UNREFERENCED_PARAMETER(ulnow);
+        return (*static_cast<TransferInfoCallback*>(clientp))(dltotal, dlnow);
+    }
+
+    void SetTransferInfoFunction(curlpp::Easy& easy, TransferInfoCallback& callback)
+    {
+        CURL* handle = easy.getHandle();
+        curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, &OnTransferInfo);
+        curl_easy_setopt(handle, CURLOPT_XFERINFODATA, &callback);
+        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+    }
+
+    void PerformCancellable(curlpp::Easy& easy, const std::stop_token& stopToken)
+    {
+        std::string errorMessage{};
+        if (const CURLcode code = PerformCancellable(easy.getHandle(), stopToken, errorMessage); code != CURLE_OK)
+        {
+            throw curlpp::LibcurlRuntimeError(errorMessage, code);
+        }
+    }
+
     std::expected<HttpResult, std::string> HttpGet(const std::string& url, const HttpGetOptions& opts)
     {
         HttpResult result{};
@@ -52,16 +321,40 @@ namespace web
 
             if (!key.empty()) result.headers[key] = value;
 
+            // The final body size is usually known up front; reserve it to avoid repeated regrowth.
+            // With a content encoding this is the compressed size, which still makes a fine lower bound.
+            if (result.httpCode == httplib::OK_200 && _stricmp(key.c_str(), "Content-Length") == 0)
+            {
+                try
+                {
+                    const size_t length = std::stoull(value);
+                    if (opts.maxBodySize == 0 || length <= opts.maxBodySize)
+                    {
+                        result.body.reserve(length);
+                    }
+                }
+                catch (...) {}
+            }
+
             return bytes;
         };
 
         // ----------------------------------------------------------------
         // Body collection
         // ----------------------------------------------------------------
+        bool bodyTooLarge = false;
         auto writeCallback = [&](char* ptr, size_t size, size_t nmemb) -> size_t
         {
             const size_t bytes = size * nmemb;
             if (ptr == nullptr || bytes == 0) return bytes;
+
+            // Data arrives already decoded, so this caps the decompressed size
+            if (opts.maxBodySize > 0 && result.body.size() + bytes > opts.maxBodySize)
+            {
+                bodyTooLarge = true;
+                return 0; // abort transfer
+            }
+
             result.body.append(ptr, bytes);
             return bytes;
         };
@@ -71,27 +364,45 @@ namespace web
         // ----------------------------------------------------------------
         try
         {
-            curlpp::Easy req;
-            req.setOpt(curlpp::options::Url(url));
+            auto& context = TransferContext::Instance();
+            const EasyHandle req = context.Acquire();
+            // failed transfers are the interesting ones, so record on every exit path
+            const auto timingGuard = sg::make_scope_guard([&] { result.timing = context.RecordTransfer(*req); });
+            req->setOpt(curlpp::options::Url(url));
             if (!opts.userAgent.empty())
-                req.setOpt(curlpp::options::UserAgent(opts.userAgent));
-            req.setOpt(curlpp::options::FollowLocation(true));
-            req.setOpt(curlpp::options::MaxRedirs(opts.maxRedirects));
+                req->setOpt(curlpp::options::UserAgent(opts.userAgent));
+            req->setOpt(curlpp::options::FollowLocation(true));
+            req->setOpt(curlpp::options::MaxRedirs(opts.maxRedirects));
             if (!opts.headers.empty())
-                req.setOpt(curlpp::options::HttpHeader(opts.headers));
-            req.setOpt(curlpp::options::ConnectTimeout(opts.connectTimeoutSecs));
+                req->setOpt(curlpp::options::HttpHeader(opts.headers));
+            req->setOpt(curlpp::options::ConnectTimeout(opts.connectTimeoutSecs));
             if (opts.timeoutSecs > 0)
             {
-                req.setOpt(curlpp::options::LowSpeedLimit(1));
-                req.setOpt(curlpp::options::LowSpeedTime(opts.timeoutSecs));
+                req->setOpt(curlpp::options::LowSpeedLimit(1));
+                req->setOpt(curlpp::options::LowSpeedTime(opts.timeoutSecs));
+            }
+            req->setOpt(curlpp::options::WriteFunction(writeCallback));
+            req->setOpt(curlpp::options::HeaderFunction(headerCallback));
+            if (opts.acceptCompressed)
+            {
+                // empty string lets libcurl offer exactly the encodings it was built with
+                req->setOpt(curlpp::options::Encoding(""));
+            }
+            if (opts.maxBodySize > 0)
+            {
+                // rejects an oversized Content-Length before any data is transferred
+                req->setOpt(curlpp::options::MaxFileSizeLarge(static_cast<curl_off_t>(opts.maxBodySize)));
             }
-            req.setOpt(curlpp::options::WriteFunction(writeCallback));
-            req.setOpt(curlpp::options::HeaderFunction(headerCallback));
 
-            req.perform();
+            PerformCancellable(*req, opts.stopToken);
         }
         catch (const curlpp::RuntimeError& e)
         {
+            if (bodyTooLarge)
+            {
+                return std::unexpected(std::format("Response body exceeds the limit of {} bytes", opts.maxBodySize));
+            }
+
             return std::unexpected(std::string(e.what()));
         }
         catch (const curlpp::LogicError& e)
@@ -5,10 +5,176 @@
 #include <list>
 #include <unordered_map>
 #include <expected>
+#include <stop_token>
+#include <memory>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <functional>
 
 
+namespace curlpp
+{
+    class Easy;
+}
+
 namespace web
 {
+    /**
+     * \brief Returns a pooled easy handle to the TransferContext instead of destroying it.
+     */
+    struct PooledEasyDeleter
+    {
+        void operator()(curlpp::Easy* easy) const;
+    };
+
+    /**
+     * \brief An easy handle borrowed from the TransferContext pool.
+     */
+    using EasyHandle = std::unique_ptr<curlpp::Easy, PooledEasyDeleter>;
+
+    /**
+     * \brief Per-phase timing and volume of a single transfer as reported by curl.
+     *        Phase times are cumulative, each one measured from the start of the transfer.
+     */
+    struct TransferTiming
+    {
+        /** The last URL used, after following redirects */
+        std::string url;
+        /** The final HTTP status code, 0 if no response was received */
+        long httpCode{0};
+        /** Until name resolution completed */
+        std::chrono::microseconds nameLookup{0};
+        /** Until the TCP connection was established */
+        std::chrono::microseconds connect{0};
+        /** Until the TLS handshake completed */
+        std::chrono::microseconds appConnect{0};
+        /** Until the first response byte arrived (time to first byte) */
+        std::chrono::microseconds startTransfer{0};
+        /** The whole transfer */
+        std::chrono::microseconds total{0};
+        /** Body bytes received */
+        uint64_t bytesDownloaded{0};
+        /** Average download speed in bytes per second */
+        uint64_t averageSpeed{0};
+        /** Number of redirects followed */
+        long redirectCount{0};
+        /** True if an already established connection was reused */
+        bool connectionReused{false};
+    };
+
+    /**
+     * \brief Connection reuse counters of the TransferContext.
+     */
+    struct TransferStats
+    {
+        /** Completed transfers */
+        uint64_t transfers{0};
+        /** Transfers served over an already established connection */
+        uint64_t reusedConnections{0};
+        /** Connections that had to be newly established (TCP and TLS handshake) */
+        uint64_t newConnections{0};
+    };
+
+    /**
+     * \brief Process-wide transfer state shared by every request.
+     *
+     * The DNS cache and TLS session cache are shared across all easy handles through a curl share
+     * handle, so requests to the same host (manifest, signature, changelog images, the release
+     * itself) skip name resolution and resume TLS sessions instead of full handshakes. Connections
+     * aren't shared, transfers run concurrently; a pooled easy handle keeps its own open connection
+     * for its next use. Easy handles are reset between uses. Shutdown must be called before curl's
+     * global cleanup.
+     */
+    class TransferContext
+    {
+        CURLSH* share{nullptr};
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> shareLocks{};
+
+        std::mutex poolLock;
+        std::vector<std::unique_ptr<curlpp::Easy>> pool;
+        bool isShutDown{false};
+
+        std::atomic<uint64_t> transfers{0};
+        std::atomic<uint64_t> reusedConnections{0};
+        std::atomic<uint64_t> newConnections{0};
+
+        std::mutex reportLock;
+        std::ofstream report;
+
+        static constexpr size_t MAX_POOLED_HANDLES = 8;
+
+        TransferContext();
+
+        static void OnShareLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+        static void OnShareUnlock(CURL* handle, curl_lock_data data, void* userptr);
+
+        friend struct PooledEasyDeleter;
+        void Release(curlpp::Easy* easy);
+
+    public:
+        TransferContext(const TransferContext&) = delete;
+        TransferContext& operator=(const TransferContext&) = delete;
+        ~TransferContext();
+
+        static TransferContext& Instance();
+
+        /**
+         * \brief Borrows a reset easy handle that is already attached to the shared state.
+         */
+        [[nodiscard]] EasyHandle Acquire();
+
+        /**
+         * \brief Attaches an easy handle to the shared state and applies the keep-alive options.
+         *        Handles from Acquire() are already attached; re-attach after resetting one.
+         */
+        void Attach(curlpp::Easy& easy) const;
+
+        /**
+         * \brief Collects the timing of a finished (or failed) transfer, updates the connection
+         *        reuse counters, logs it and appends it to the timing report, if enabled.
+         */
+        TransferTiming RecordTransfer(curlpp::Easy& easy);
+
+        /**
+         * \brief Appends the timing of every following transfer as one JSON object per line to a file.
+         */
+        void EnableTimingReport(const std::filesystem::path& reportPath);
+
+        [[nodiscard]] TransferStats GetStats() const;
+
+        /**
+         * \brief Releases the share handle and all pooled handles. Later transfers still work,
+         *        just without any sharing.
+         */
+        void Shutdown();
+    };
+
+    /**
+     * \brief Progress callback with 64-bit byte counters, see CURLOPT_XFERINFOFUNCTION.
+     *        Receives the download total (0 if unknown) and the bytes received so far.
+     * \return Non-zero to abort the transfer.
+     */
+    using TransferInfoCallback = std::function<int(curl_off_t dlTotal, curl_off_t dlNow)>;
+
+    /**
+     * \brief Installs a CURLOPT_XFERINFOFUNCTION progress callback, which curlpp doesn't wrap.
+     * \param easy The handle, its progress meter gets enabled.
+     * \param callback Invoked on the transferring thread, must outlive the transfer.
+     */
+    void SetTransferInfoFunction(curlpp::Easy& easy, TransferInfoCallback& callback);
+
+    /**
+     * \brief Drop-in replacement of curlpp::Easy::perform that returns as soon as stopToken is triggered.
+     * \throws curlpp::LibcurlRuntimeError On transfer failure or cancellation (CURLE_ABORTED_BY_CALLBACK).
+     * \remarks See PerformCancellable in CancellableTransfer.h for how the transfer is interrupted.
+     */
+    void PerformCancellable(curlpp::Easy& easy, const std::stop_token& stopToken);
+
     /**
      * \brief Payload returned by a successful HttpGet call.
      *
@@ -21,6 +187,7 @@ namespace web
         long httpCode{0};
         std::string body;
         std::unordered_map<std::string, std::string> headers;
+        TransferTiming timing;
     };
 
     /**
@@ -36,6 +203,12 @@ namespace web
         long timeoutSecs{0};
         long connectTimeoutSecs{60};
         long maxRedirects{5};
+        /** If stop is requested, the transfer is aborted and reported as a transport failure */
+        std::stop_token stopToken{};
+        /** Offer every content encoding libcurl can decode (gzip, deflate, zstd, ...) */
+        bool acceptCompressed{true};
+        /** Upper bound of the (decompressed) body in bytes, larger responses fail the request; 0 disables the limit */
+        size_t maxBodySize{32 * 1024 * 1024};
         // future: std::optional<std::string> proxy;
     };
 
@@ -49,7 +222,8 @@ namespace web
      * the caller can apply its own retry / fallback logic.
      *
      * Timeout failures include the word "timeout" in the error string, which
-     * callers can test to apply exponential back-off.
+     * callers can test to apply exponential back-off. A body exceeding
+     * HttpGetOptions::maxBodySize is reported as a transport failure as well.
      */
     std::expected<HttpResult, std::string> HttpGet(const std::string& url, const HttpGetOptions& opts);
 }
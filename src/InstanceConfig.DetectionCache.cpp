@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "Util.h"
+#include "Hashing.h"
+#include "InstanceConfig.hpp"
+
+//
+// The detection checksum cache is a single small JSON file in the per-user tenant directory
+// remembering the digests of files hashed for FileChecksum detection, so an unchanged product
+// binary isn't read again on every run. An entry is only used if the file still has the exact
+// identity it had when it was hashed: same volume and file index, size, last write time and
+// change time. The latter is maintained by the file system on every write or attribute change
+// and can't be set through the regular APIs, so restoring the last write time after altering
+// the file doesn't produce a stale hit. Each tenant keeps at most DETECTION_CACHE_MAX_ENTRIES
+// entries, the least recently used ones are dropped.
+//
+
+namespace
+{
+    /**
+     * \brief Everything that has to stay unchanged for a cached digest to remain valid.
+     */
+    struct FileIdentity
+    {
+        uint32_t volumeSerial{0};
+        uint64_t fileIndex{0};
+        uint64_t size{0};
+        uint64_t lastWriteTime{0};
+        uint64_t changeTime{0};
+
+        bool operator==(const FileIdentity&) const = default;
+    };
+
+    std::optional<FileIdentity> GetFileIdentity(const std::filesystem::path& filePath)
+    {
+        // no access to the content is required for querying attributes
+        const HANDLE file = CreateFileW(filePath.c_str(), FILE_READ_ATTRIBUTES,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return std::nullopt;
+        }
+        const auto fileGuard = sg::make_scope_guard([file]() noexcept { CloseHandle(file); });
+
+        BY_HANDLE_FILE_INFORMATION info{};
+        FILE_BASIC_INFO basicInfo{};
+
+        if (!GetFileInformationByHandle(file, &info) ||
+            !GetFileInformationByHandleEx(file, FileBasicInfo, &basicInfo, sizeof(basicInfo)))
+        {
+            return std::nullopt;
+        }
+
+        FileIdentity identity{};
+        identity.volumeSerial = info.dwVolumeSerialNumber;
+        identity.fileIndex = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        identity.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        identity.lastWriteTime = static_cast<uint64_t>(basicInfo.LastWriteTime.QuadPart);
+        identity.changeTime = static_cast<uint64_t>(basicInfo.ChangeTime.QuadPart);
+
+        return identity;
+    }
+
+    uint64_t GetTimestamp()
+    {
+        FILETIME now{};
+        GetSystemTimeAsFileTime(&now);
+        return (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+    }
+
+    json LoadEntries(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return json::array();
+        }
+
+        try
+        {
+            json cache = json::parse(file);
+            if (cache.contains("entries") && cache[ "entries" ].is_array())
+            {
+                return std::move(cache[ "entries" ]);
+            }
+        }
+        catch (const json::exception& e)
+        {
+            spdlog::warn("Failed to parse detection checksum cache {}, error {}", path, e.what());
+        }
+
+        return json::array();
+    }
+
+    /**
+     * \brief Writes the entries, keeping only the most recently used ones.
+     */
+    void StoreEntries(const std::filesystem::path& path, json entries, const size_t maxEntries)
+    {
+        if (entries.size() > maxEntries)
+        {
+            std::sort(entries.begin(), entries.end(), [](const json& lhs, const json& rhs)
+            {
+                return lhs.value("lastUsed", uint64_t{0}) > rhs.value("lastUsed", uint64_t{0});
+            });
+            entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(maxEntries), entries.end());
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec)
+        {
+            spdlog::warn("Failed to create detection checksum cache directory {}, error {}", path.parent_path(),
+                         ec.message());
+            return;
+        }
+
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+            {
+                spdlog::warn("Failed to write detection checksum cache {}", path);
+                return;
+            }
+
+            file << json{{"entries", std::move(entries)}}.dump();
+            if (!file)
+            {
+                spdlog::warn("Failed to write detection checksum cache {}", path);
+                return;
+            }
+        }
+
+        // replaced as a whole so concurrent runs never read a half-written cache
+        if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            spdlog::warn("Failed to replace detection checksum cache {}, error: {:#x}", path, GetLastError());
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    bool Matches(const json& entry, const std::string& filePath, const models::ChecksumAlgorithm algorithm)
+    {
+        return entry.value("path", std::string{}) == filePath &&
+            entry.value("algorithm", models::ChecksumAlgorithm::Invalid) == algorithm;
+    }
+
+    FileIdentity GetEntryIdentity(const json& entry)
+    {
+        FileIdentity identity{};
+        identity.volumeSerial = entry.value("volumeSerial", uint32_t{0});
+        identity.fileIndex = entry.value("fileIndex", uint64_t{0});
+        identity.size = entry.value("size", uint64_t{0});
+        identity.lastWriteTime = entry.value("lastWriteTime", uint64_t{0});
+        identity.changeTime = entry.value("changeTime", uint64_t{0});
+        return identity;
+    }
+}
+
+std::filesystem::path models::InstanceConfig::GetDetectionCachePath() const
+{
+    const auto dataDirectory = GetLocalDataDirectory();
+    if (dataDirectory.empty())
+    {
+        return {};
+    }
+
+    return dataDirectory / "DetectionCache.json";
+}
+
+std::expected<std::string, std::string> models::InstanceConfig::GetDetectionChecksum(
+    const std::filesystem::path& filePath, const ChecksumAlgorithm algorithm) const
+{
+    const auto cachePath = GetDetectionCachePath();
+    // the path as given is the key; different spellings of the same file merely produce separate entries
+    const std::string key = filePath.string();
+    const auto identity = GetFileIdentity(filePath);
+
+    json entries = (cachePath.empty() || !identity.has_value()) ? json::array() : LoadEntries(cachePath);
+
+    const auto cached = std::find_if(entries.begin(), entries.end(), [&key, algorithm](const json& entry)
+    {
+        return Matches(entry, key, algorithm);
+    });
+
+    if (cached != entries.end())
+    {
+        const auto digest = cached->value("digest", std::string{});
+
+        if (!digest.empty() && GetEntryIdentity(*cached) == identity.value())
+        {
+            spdlog::debug("Using cached {} checksum of {}", magic_enum::enum_name(algorithm), filePath);
+
+            (*cached)[ "lastUsed" ] = GetTimestamp();
+            StoreEntries(cachePath, std::move(entries), DETECTION_CACHE_MAX_ENTRIES);
+
+            return digest;
+        }
+
+        spdlog::debug("Cached {} checksum of {} is outdated", magic_enum::enum_name(algorithm), filePath);
+        entries.erase(cached);
+    }
+
+    const auto digests = hashing::HashFile(filePath, {algorithm});
+    if (!digests.has_value())
+    {
+        return std::unexpected(digests.error());
+    }
+
+    const auto& digest = digests.value().front();
+
+    // a file modified while being hashed may have produced a digest of neither version
+    if (identity.has_value() && !cachePath.empty() && GetFileIdentity(filePath) == identity)
+    {
+        entries.push_back({
+            {"path", key},
+            {"algorithm", algorithm},
+            {"digest", digest},
+            {"volumeSerial", identity->volumeSerial},
+            {"fileIndex", identity->fileIndex},
+            {"size", identity->size},
+            {"lastWriteTime", identity->lastWriteTime},
+            {"changeTime", identity->changeTime},
+            {"lastUsed", GetTimestamp()},
+        });
+
+        StoreEntries(cachePath, std::move(entries), DETECTION_CACHE_MAX_ENTRIES);
+    }
+
+    return digest;
+}
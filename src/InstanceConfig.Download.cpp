@@ -2,7 +2,7 @@
 #include "InstanceConfig.hpp"
 
 
-bool models::InstanceConfig::DownloadReleaseAsync(int releaseIndex, curl_progress_callback progressFn)
+bool models::InstanceConfig::DownloadReleaseAsync(int releaseIndex, std::function<void()> onCompleted)
 {
     // fail if already in-progress
     if (downloadTask.has_value())
@@ -11,7 +11,28 @@ bool models::InstanceConfig::DownloadReleaseAsync(int releaseIndex, curl_progres
     }
 
     abortDownloadRequested.store(false, std::memory_order_relaxed);
-    downloadTask = std::async(std::launch::async, &InstanceConfig::DownloadRelease, this, progressFn, releaseIndex);
+    downloadStopSource = std::stop_source{};
+    // published before the task exists, so no reader ever sees the previous download's completion
+    downloadProgress.Reset();
+    downloadProgress.SetPhase(web::DownloadPhase::Starting);
+
+    downloadTask = std::async(std::launch::async,
+                              [this, releaseIndex, onCompleted = std::move(onCompleted)]()
+                              {
+                                  // also signalled if the download throws, or the UI would wait forever
+                                  std::expected<int, std::string> result = std::unexpected("Download failed unexpectedly");
+                                  const auto completionGuard = sg::make_scope_guard([&]() noexcept
+                                  {
+                                      downloadProgress.Complete(result.has_value());
+                                      if (onCompleted)
+                                      {
+                                          onCompleted();
+                                      }
+                                  });
+
+                                  result = DownloadRelease(releaseIndex);
+                                  return result;
+                              });
 
     return true;
 }
@@ -23,11 +44,14 @@ bool models::InstanceConfig::DownloadReleaseAsync(int releaseIndex, curl_progres
         return std::nullopt;
     }
 
-    const std::future_status futureStatus = downloadTask->wait_for(std::chrono::milliseconds(1));
+    // The completion flag is an atomic load, unlike querying the future. It is raised moments
+    // before the task returns its result, so the future is only asked without waiting once it's up.
+    const bool isComplete = downloadProgress.GetSnapshot().IsComplete() &&
+                            downloadTask->wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
 
     DownloadStatus status{};
-    status.isDownloading = futureStatus == std::future_status::timeout;
-    status.hasFinished = futureStatus == std::future_status::ready;
+    status.isDownloading = !isComplete;
+    status.hasFinished = isComplete;
 
     if (status.hasFinished)
     {
@@ -42,6 +66,7 @@ void models::InstanceConfig::ResetReleaseDownloadState() { downloadTask.reset();
 void models::InstanceConfig::RequestAbortDownload()
 {
     const bool was = abortDownloadRequested.exchange(true, std::memory_order_relaxed);
+    downloadStopSource.request_stop();
     if (!was)
     {
         spdlog::info("Download abort requested");
@@ -0,0 +1,478 @@
+#include "pch.h"
+#include "Util.h"
+#include "InstanceConfig.hpp"
+
+#include <atomic>
+#include <bcrypt.h>
+#include <hash-library/hmac.h>
+
+//
+// Each cached manifest consists of these files sharing a base name derived from the request URL:
+//   <base>.body         the raw manifest bytes exactly as received (signature covers these), any format
+//   <base>.minisig      the raw .minisig sidecar (only with NV_MANIFEST_PUBLIC_KEY)
+//   <base>.parsed.cbor  the parse result (filtered and sorted releases plus the rest of the document)
+//   <base>.meta.json    the request URL, content type, HTTP validators and the digests of the other
+//                       files, authenticated with an HMAC; written last, marks the entry complete
+//
+// The cache lives in a user-writable location, so without a compiled-in public key nothing but the
+// HMAC vouches for an entry. Its key is a random secret stored in the same directory (cache.key),
+// encrypted with DPAPI for the current user, so an entry altered on disk (e.g. to point a release
+// elsewhere) isn't accepted unless whoever altered it could also decrypt the key as this user.
+//
+
+namespace
+{
+    std::optional<std::string> ReadWholeFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return std::nullopt;
+
+        std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        if (file.bad()) return std::nullopt;
+
+        return content;
+    }
+
+    /**
+     * \brief Writes content to a temporary sibling of path, unique to this process and call.
+     * \return The temporary file, empty on failure.
+     */
+    std::filesystem::path WriteTempFile(const std::filesystem::path& path, const std::string& content)
+    {
+        static std::atomic<uint32_t> counter{0};
+
+        // concurrent writers (the manifest URL race, other instances) never share a temporary file
+        std::filesystem::path tempPath = path;
+        tempPath += std::format(".{}.{}.tmp", GetCurrentProcessId(), counter.fetch_add(1));
+
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return {};
+
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (file) return tempPath;
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        return {};
+    }
+
+    /**
+     * \brief Writes to a sibling temporary file first so readers never observe a half-written file.
+     */
+    bool WriteWholeFile(const std::filesystem::path& path, const std::string& content)
+    {
+        const auto tempPath = WriteTempFile(path, content);
+        if (tempPath.empty()) return false;
+
+        if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Compares two MACs in time independent of where they differ.
+     */
+    bool IsSameMac(const std::string& lhs, const std::string& rhs)
+    {
+        if (lhs.size() != rhs.size()) return false;
+
+        volatile unsigned char difference = 0;
+        for (size_t i = 0; i < lhs.size(); i++)
+        {
+            difference |= static_cast<unsigned char>(lhs[ i ] ^ rhs[ i ]);
+        }
+
+        return difference == 0;
+    }
+
+    std::filesystem::path WithSuffix(std::filesystem::path base, const char* suffix)
+    {
+        base += suffix;
+        return base;
+    }
+
+    constexpr size_t CACHE_KEY_SIZE = 32;
+
+    // binds the encrypted key to this purpose, other DPAPI blobs of the user can't be swapped in
+    constexpr char CACHE_KEY_ENTROPY[] = "Vicius manifest cache key";
+
+    DATA_BLOB ToBlob(const std::string& data)
+    {
+        return {static_cast<DWORD>(data.size()), reinterpret_cast<BYTE*>(const_cast<char*>(data.data()))};
+    }
+
+    DATA_BLOB GetKeyEntropy()
+    {
+        return {sizeof(CACHE_KEY_ENTROPY) - 1, reinterpret_cast<BYTE*>(const_cast<char*>(CACHE_KEY_ENTROPY))};
+    }
+
+    std::optional<std::string> ProtectKey(const std::string& key)
+    {
+        DATA_BLOB input = ToBlob(key);
+        DATA_BLOB entropy = GetKeyEntropy();
+        DATA_BLOB output{};
+
+        if (!CryptProtectData(&input, L"Vicius manifest cache key", &entropy, nullptr, nullptr,
+                              CRYPTPROTECT_UI_FORBIDDEN, &output))
+        {
+            spdlog::warn("Failed to encrypt manifest cache key, error: {:#x}", GetLastError());
+            return std::nullopt;
+        }
+        const auto outputGuard = sg::make_scope_guard([&output]() noexcept { LocalFree(output.pbData); });
+
+        return std::string(reinterpret_cast<const char*>(output.pbData), output.cbData);
+    }
+
+    std::optional<std::string> UnprotectKey(const std::string& protectedKey)
+    {
+        DATA_BLOB input = ToBlob(protectedKey);
+        DATA_BLOB entropy = GetKeyEntropy();
+        DATA_BLOB output{};
+
+        if (!CryptUnprotectData(&input, nullptr, &entropy, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &output))
+        {
+            return std::nullopt;
+        }
+        const auto outputGuard = sg::make_scope_guard([&output]() noexcept
+        {
+            SecureZeroMemory(output.pbData, output.cbData);
+            LocalFree(output.pbData);
+        });
+
+        if (output.cbData != CACHE_KEY_SIZE)
+        {
+            return std::nullopt;
+        }
+
+        return std::string(reinterpret_cast<const char*>(output.pbData), output.cbData);
+    }
+
+    /**
+     * \brief Gets the HMAC key of the current user's cache in directory.
+     * \param directory The cache directory.
+     * \param create Create a new key if there's no usable one; every existing entry becomes invalid then.
+     */
+    std::optional<std::string> GetCacheKey(const std::filesystem::path& directory, const bool create)
+    {
+        // the manifest URL race stores entries concurrently, they must all end up with the same key
+        static std::mutex keyLock;
+        std::lock_guard lock(keyLock);
+
+        const auto keyPath = directory / "cache.key";
+
+        const auto readKey = [&keyPath]() -> std::optional<std::string>
+        {
+            if (const auto stored = ReadWholeFile(keyPath); stored.has_value())
+            {
+                if (auto key = UnprotectKey(stored.value()); key.has_value())
+                {
+                    return key;
+                }
+
+                spdlog::warn("Manifest cache key {} can't be decrypted", keyPath);
+            }
+
+            return std::nullopt;
+        };
+
+        if (auto key = readKey(); key.has_value() || !create)
+        {
+            return key;
+        }
+
+        std::string key(CACHE_KEY_SIZE, '\0');
+        if (!BCRYPT_SUCCESS(BCryptGenRandom(nullptr, reinterpret_cast<PUCHAR>(key.data()),
+            static_cast<ULONG>(key.size()), BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+        {
+            spdlog::warn("Failed to generate manifest cache key");
+            return std::nullopt;
+        }
+
+        const auto protectedKey = ProtectKey(key);
+        const auto tempPath = protectedKey.has_value()
+                                  ? WriteTempFile(keyPath, protectedKey.value())
+                                  : std::filesystem::path{};
+        if (tempPath.empty())
+        {
+            spdlog::warn("Failed to write manifest cache key {}", keyPath);
+            return std::nullopt;
+        }
+
+        // an undecryptable key is replaced; a key another instance created meanwhile never is
+        std::error_code ec;
+        if (std::filesystem::exists(keyPath, ec) && !readKey().has_value())
+        {
+            std::filesystem::remove(keyPath, ec);
+        }
+
+        // no MOVEFILE_REPLACE_EXISTING: fails if another instance stored its key first
+        if (!MoveFileExW(tempPath.c_str(), keyPath.c_str(), 0))
+        {
+            std::filesystem::remove(tempPath, ec);
+
+            if (auto raced = readKey(); raced.has_value())
+            {
+                return raced;
+            }
+
+            spdlog::warn("Failed to write manifest cache key {}", keyPath);
+            return std::nullopt;
+        }
+
+        return key;
+    }
+
+    std::string GetDigest(const std::string& data)
+    {
+        SHA256 alg;
+        return alg(data);
+    }
+
+    std::string GetMac(const json& meta, const std::string& key)
+    {
+        // object members are kept sorted, so the serialization is canonical
+        const std::string canonical = meta.dump();
+        return hmac<SHA256>(canonical.data(), canonical.size(), key.data(), key.size());
+    }
+}
+
+std::filesystem::path models::InstanceConfig::GetManifestCachePath(const std::string& requestUrl) const
+{
+    const auto dataDirectory = GetLocalDataDirectory();
+    if (dataDirectory.empty())
+    {
+        return {};
+    }
+
+    const std::filesystem::path directory = dataDirectory / "ManifestCache";
+
+    SHA256 alg;
+    alg.add(requestUrl.data(), requestUrl.size());
+
+    return directory / alg.getHash().substr(0, 16);
+}
+
+std::optional<models::InstanceConfig::CachedManifest> models::InstanceConfig::LoadCachedManifest(
+    const std::string& requestUrl) const
+{
+    const auto base = GetManifestCachePath(requestUrl);
+    if (base.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto meta = ReadWholeFile(WithSuffix(base, ".meta.json"));
+    if (!meta.has_value())
+    {
+        return std::nullopt;
+    }
+
+    const auto key = GetCacheKey(base.parent_path(), false);
+    if (!key.has_value())
+    {
+        spdlog::debug("No manifest cache key, ignoring cache entry {}", base);
+        return std::nullopt;
+    }
+
+    CachedManifest entry{};
+    json metaJson;
+
+    try
+    {
+        metaJson = json::parse(meta.value());
+
+        const auto mac = metaJson.value("mac", std::string{});
+        metaJson.erase("mac");
+
+        if (mac.empty() || !IsSameMac(mac, GetMac(metaJson, key.value())))
+        {
+            spdlog::warn("Manifest cache entry {} failed authentication, ignoring", base);
+            return std::nullopt;
+        }
+
+        if (metaJson.value("url", std::string{}) != requestUrl)
+        {
+            spdlog::debug("Manifest cache entry {} belongs to a different URL, ignoring", base);
+            return std::nullopt;
+        }
+
+        entry.etag = metaJson.value("etag", std::string{});
+        entry.lastModified = metaJson.value("lastModified", std::string{});
+        entry.contentType = metaJson.value("contentType", std::string{});
+    }
+    catch (const json::exception& e)
+    {
+        spdlog::warn("Failed to parse manifest cache metadata {}, error {}", base, e.what());
+        return std::nullopt;
+    }
+
+    if (entry.etag.empty() && entry.lastModified.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto body = ReadWholeFile(WithSuffix(base, ".body"));
+    if (!body.has_value() || body->empty() || GetDigest(body.value()) != metaJson.value("body", std::string{}))
+    {
+        spdlog::warn("Manifest cache body {} is missing or doesn't match its metadata", base);
+        return std::nullopt;
+    }
+    entry.body = body.value();
+
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+    const auto signature = ReadWholeFile(WithSuffix(base, ".minisig"));
+    if (!signature.has_value() || signature->empty() ||
+        GetDigest(signature.value()) != metaJson.value("signature", std::string{}))
+    {
+        return std::nullopt;
+    }
+    entry.signature = signature.value();
+#endif
+
+    // the models may differ between updater versions, the body is parsed again then
+    const auto parsedDigest = metaJson.value("parsed", std::string{});
+    if (parsedDigest.empty() || metaJson.value("updaterVersion", std::string{}) != appVersion.str())
+    {
+        return entry;
+    }
+
+    const auto parsed = ReadWholeFile(WithSuffix(base, ".parsed.cbor"));
+    if (!parsed.has_value() || GetDigest(parsed.value()) != parsedDigest)
+    {
+        spdlog::debug("Manifest cache parse result {} is missing or doesn't match its metadata", base);
+        return entry;
+    }
+
+    try
+    {
+        const json parsedJson = json::from_cbor(parsed.value());
+
+        ManifestCandidate candidate{};
+        // mirrors manifest::ParseUpdateResponse, the reply holds everything but the releases
+        candidate.reply = parsedJson.at("reply");
+        candidate.response = candidate.reply.get<UpdateResponse>();
+        candidate.response.releases = parsedJson.at("releases").get<std::vector<UpdateRelease>>();
+
+        entry.parsed = std::move(candidate);
+    }
+    catch (const json::exception& e)
+    {
+        spdlog::warn("Failed to restore manifest cache parse result {}, error {}", base, e.what());
+    }
+
+    return entry;
+}
+
+void models::InstanceConfig::StoreCachedManifest(const std::string& requestUrl, const CachedManifest& entry) const
+{
+    // without validators the server can't ever answer 304, so there's no point in caching
+    if (entry.etag.empty() && entry.lastModified.empty())
+    {
+        PurgeCachedManifest(requestUrl);
+        return;
+    }
+
+    const auto base = GetManifestCachePath(requestUrl);
+    if (base.empty())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(base.parent_path(), ec);
+    if (ec)
+    {
+        spdlog::warn("Failed to create manifest cache directory {}, error {}", base.parent_path(), ec.message());
+        return;
+    }
+
+    const auto key = GetCacheKey(base.parent_path(), true);
+    if (!key.has_value())
+    {
+        return;
+    }
+
+    // invalidate first so a failure halfway through never pairs old metadata with a new body
+    std::filesystem::remove(WithSuffix(base, ".meta.json"), ec);
+
+    if (!WriteWholeFile(WithSuffix(base, ".body"), entry.body))
+    {
+        spdlog::warn("Failed to write manifest cache body {}", base);
+        return;
+    }
+
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+    if (!WriteWholeFile(WithSuffix(base, ".minisig"), entry.signature))
+    {
+        spdlog::warn("Failed to write manifest cache signature {}", base);
+        return;
+    }
+#endif
+
+    std::string parsedDigest{};
+    if (entry.parsed.has_value())
+    {
+        std::string parsed{};
+        json::to_cbor(json{
+                          {"reply", entry.parsed->reply},
+                          {"releases", entry.parsed->response.releases},
+                      }, parsed);
+
+        if (WriteWholeFile(WithSuffix(base, ".parsed.cbor"), parsed))
+        {
+            parsedDigest = GetDigest(parsed);
+        }
+        else
+        {
+            spdlog::warn("Failed to write manifest cache parse result {}", base);
+        }
+    }
+    else
+    {
+        std::filesystem::remove(WithSuffix(base, ".parsed.cbor"), ec);
+    }
+
+    json metaJson = {
+        {"url", requestUrl},
+        {"etag", entry.etag},
+        {"lastModified", entry.lastModified},
+        {"contentType", entry.contentType},
+        {"body", GetDigest(entry.body)},
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+        {"signature", GetDigest(entry.signature)},
+#endif
+        {"parsed", parsedDigest},
+        {"updaterVersion", appVersion.str()},
+    };
+    metaJson[ "mac" ] = GetMac(metaJson, key.value());
+
+    if (!WriteWholeFile(WithSuffix(base, ".meta.json"), metaJson.dump()))
+    {
+        spdlog::warn("Failed to write manifest cache metadata {}", base);
+        return;
+    }
+
+    spdlog::debug("Cached manifest of {} (ETag: {}, Last-Modified: {})", requestUrl, entry.etag, entry.lastModified);
+}
+
+void models::InstanceConfig::PurgeCachedManifest(const std::string& requestUrl) const
+{
+    const auto base = GetManifestCachePath(requestUrl);
+    if (base.empty())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(WithSuffix(base, ".meta.json"), ec);
+    std::filesystem::remove(WithSuffix(base, ".body"), ec);
+    std::filesystem::remove(WithSuffix(base, ".minisig"), ec);
+    std::filesystem::remove(WithSuffix(base, ".parsed.cbor"), ec);
+}
@@ -0,0 +1,70 @@
+#include "pch.h"
+#include "InstanceConfig.hpp"
+
+
+bool models::InstanceConfig::IsPrefetchEnabled() const
+{
+    // interactive runs start downloading the moment the user asks for it anyway
+    return isSilent && (cliPrefetch || merged.prefetchRelease);
+}
+
+bool models::InstanceConfig::PrefetchRelease()
+{
+    spdlog::info("Prefetching release before prompting the user");
+
+    // unattended, so CreateDownloadThrottle applies the background rate limit
+    if (!DownloadReleaseAsync(GetSelectedReleaseId()))
+    {
+        spdlog::warn("Prefetch skipped, a download is already in progress");
+        return false;
+    }
+
+    WaitForDownloadToFinish();
+
+    const auto status = GetReleaseDownloadStatus();
+    ResetReleaseDownloadState();
+
+    if (!status.has_value() || !status->result.has_value() || !status->result->has_value())
+    {
+        const std::string error = (status.has_value() && status->result.has_value())
+                                      ? status->result->error()
+                                      : "Download did not complete";
+        spdlog::warn("Prefetch failed, downloading on demand: {}", error);
+        return false;
+    }
+
+    if (const auto verified = VerifyReleaseIntegrity(); !verified)
+    {
+        spdlog::warn("Prefetched release failed verification, discarding it: {}", verified.error());
+
+        std::error_code ec;
+        std::filesystem::remove(GetLocalReleaseTempFilePath(GetSelectedReleaseId()), ec);
+        return false;
+    }
+
+    spdlog::info("Release prefetched and verified");
+    isReleasePrefetched = true;
+    return true;
+}
+
+bool models::InstanceConfig::TakePrefetchedRelease()
+{
+    if (!std::exchange(isReleasePrefetched, false))
+    {
+        return false;
+    }
+
+    // the temp directory may have been cleaned up while the prompt was shown
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(GetLocalReleaseTempFilePath(GetSelectedReleaseId()), ec))
+    {
+        spdlog::warn("Prefetched release vanished, downloading it again");
+        return false;
+    }
+
+    // the file sat on disk since it was verified, so the digest of the download stream no longer
+    // vouches for it; without one, VerifyReleaseIntegrity hashes what setup will actually run
+    GetSelectedRelease().payloadHasher.Reset();
+
+    return true;
+}
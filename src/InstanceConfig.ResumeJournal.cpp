@@ -0,0 +1,211 @@
+#include "pch.h"
+#include "Util.h"
+#include "InstanceConfig.hpp"
+
+//
+// A resume journal is a small JSON file per release download URL, kept in the per-user tenant
+// directory, so unlike the partial file itself (which may live in a shared download location)
+// no other user can alter it. It is updated every RESUME_JOURNAL_INTERVAL bytes and whenever
+// an attempt ends, and deleted once the download completed.
+//
+
+std::filesystem::path models::InstanceConfig::GetResumeJournalPath(const std::string& downloadUrl) const
+{
+    const auto dataDirectory = GetLocalDataDirectory();
+    if (dataDirectory.empty())
+    {
+        return {};
+    }
+
+    SHA256 alg;
+    alg.add(downloadUrl.data(), downloadUrl.size());
+
+    return dataDirectory / "ResumeJournal" / std::format("{}.json", alg.getHash().substr(0, 16));
+}
+
+std::optional<models::InstanceConfig::ResumeJournal> models::InstanceConfig::LoadResumeJournal(
+    const std::string& downloadUrl) const
+{
+    const auto path = GetResumeJournalPath(downloadUrl);
+    if (path.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+
+    ResumeJournal journal{};
+
+    try
+    {
+        const json journalJson = json::parse(file);
+
+        if (journalJson.value("url", std::string{}) != downloadUrl)
+        {
+            spdlog::debug("Resume journal {} belongs to a different URL, ignoring", path);
+            return std::nullopt;
+        }
+
+        journal.url = downloadUrl;
+        journal.tempFile = journalJson.value("tempFile", std::string{});
+        journal.etag = journalJson.value("etag", std::string{});
+        journal.lastModified = journalJson.value("lastModified", std::string{});
+        journal.bytesCommitted = journalJson.value("bytesCommitted", uint64_t{0});
+        journal.attachmentName = journalJson.value("attachmentName", std::string{});
+        journal.hashAlgorithm = journalJson.value("hashAlgorithm", ChecksumAlgorithm::Invalid);
+        journal.hashState = journalJson.value("hashState", std::string{});
+        journal.hashDigest = journalJson.value("hashDigest", std::string{});
+    }
+    catch (const json::exception& e)
+    {
+        spdlog::warn("Failed to parse resume journal {}, error {}", path, e.what());
+        file.close();
+        PurgeResumeJournal(downloadUrl);
+        return std::nullopt;
+    }
+
+    file.close();
+
+    std::error_code ec;
+    const auto fileSize = journal.tempFile.empty() ? 0 : std::filesystem::file_size(journal.tempFile, ec);
+
+    // nothing left to continue
+    if (ec || fileSize == 0)
+    {
+        spdlog::debug("Partial download {} of resume journal {} is gone", journal.tempFile, path);
+        PurgeResumeJournal(downloadUrl);
+        return std::nullopt;
+    }
+
+    // data that never made it to disk before the process died; the bytes are still worth
+    // resuming from, but the digest state is ahead of them
+    if (fileSize < journal.bytesCommitted)
+    {
+        spdlog::warn("Partial download {} is shorter than journaled ({} < {} bytes)", journal.tempFile, fileSize,
+                     journal.bytesCommitted);
+        journal.bytesCommitted = fileSize;
+        journal.hashState.clear();
+        journal.hashDigest.clear();
+    }
+
+    return journal;
+}
+
+void models::InstanceConfig::StoreResumeJournal(const ResumeJournal& journal) const
+{
+    const auto path = GetResumeJournalPath(journal.url);
+    if (path.empty())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    if (ec)
+    {
+        spdlog::warn("Failed to create resume journal directory {}, error {}", path.parent_path(), ec.message());
+        return;
+    }
+
+    const json journalJson = {
+        {"url", journal.url},
+        {"tempFile", journal.tempFile.string()},
+        {"etag", journal.etag},
+        {"lastModified", journal.lastModified},
+        {"bytesCommitted", journal.bytesCommitted},
+        {"attachmentName", journal.attachmentName},
+        {"hashAlgorithm", journal.hashAlgorithm},
+        {"hashState", journal.hashState},
+        {"hashDigest", journal.hashDigest},
+    };
+    const std::string content = journalJson.dump();
+
+    // written to a sibling first so a crash never leaves a half-written journal behind
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            spdlog::warn("Failed to write resume journal {}", path);
+            return;
+        }
+
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+        if (!file)
+        {
+            spdlog::warn("Failed to write resume journal {}", path);
+            return;
+        }
+    }
+
+    if (!MoveFileExA(tempPath.string().c_str(), path.string().c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        spdlog::warn("Failed to replace resume journal {}, error: {:#x}", path, GetLastError());
+        return;
+    }
+
+    spdlog::debug("Journaled {} bytes of {} to {}", journal.bytesCommitted, journal.tempFile, path);
+}
+
+void models::InstanceConfig::PurgeResumeJournal(const std::string& downloadUrl) const
+{
+    const auto path = GetResumeJournalPath(downloadUrl);
+    if (path.empty())
+    {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+void models::InstanceConfig::PurgeStaleResumeJournals(const std::string& keepUrl) const
+{
+    const auto keep = GetResumeJournalPath(keepUrl);
+    if (keep.empty())
+    {
+        return;
+    }
+
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator(keep.parent_path(), ec))
+    {
+        const auto& path = item.path();
+        if (path == keep || path.extension() != ".json")
+        {
+            continue;
+        }
+
+        const auto lastWrite = std::filesystem::last_write_time(path, ec);
+        if (ec || now - lastWrite < RESUME_JOURNAL_MAX_AGE)
+        {
+            continue;
+        }
+
+        try
+        {
+            std::ifstream file(path, std::ios::binary);
+            const json journalJson = json::parse(file);
+
+            if (const auto tempFile = journalJson.value("tempFile", std::string{}); !tempFile.empty())
+            {
+                spdlog::info("Deleting abandoned partial download {}", tempFile);
+                DeleteFileA(tempFile.c_str());
+            }
+        }
+        catch (const json::exception& e)
+        {
+            spdlog::debug("Failed to parse resume journal {}, error {}", path, e.what());
+        }
+
+        std::filesystem::remove(path, ec);
+    }
+}
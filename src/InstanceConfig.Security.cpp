@@ -2,6 +2,7 @@
 #include "Util.h"
 #include "InstanceConfig.hpp"
 #include "NAuthenticode.h"
+#include "Minisign.h"
 
 // ============================================================================
 // Helpers
@@ -9,60 +10,6 @@
 
 namespace
 {
-    /**
-     * \brief Hash a file with MD5 and return the hex digest.
-     */
-    std::string HashFileMD5(const std::string& filePath)
-    {
-        MD5 alg;
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) return {};
-
-        constexpr std::size_t chunkSize = 4 * 1024;
-        std::vector<char> buf(chunkSize);
-        while (!file.eof())
-        {
-            file.read(buf.data(), buf.size());
-            const std::streamsize n = file.gcount();
-            if (n > 0) alg.add(buf.data(), n);
-        }
-        return alg.getHash();
-    }
-
-    std::string HashFileSHA1(const std::string& filePath)
-    {
-        SHA1 alg;
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) return {};
-
-        constexpr std::size_t chunkSize = 4 * 1024;
-        std::vector<char> buf(chunkSize);
-        while (!file.eof())
-        {
-            file.read(buf.data(), buf.size());
-            const std::streamsize n = file.gcount();
-            if (n > 0) alg.add(buf.data(), n);
-        }
-        return alg.getHash();
-    }
-
-    std::string HashFileSHA256(const std::string& filePath)
-    {
-        SHA256 alg;
-        std::ifstream file(filePath, std::ios::binary);
-        if (!file.is_open()) return {};
-
-        constexpr std::size_t chunkSize = 4 * 1024;
-        std::vector<char> buf(chunkSize);
-        while (!file.eof())
-        {
-            file.read(buf.data(), buf.size());
-            const std::streamsize n = file.gcount();
-            if (n > 0) alg.add(buf.data(), n);
-        }
-        return alg.getHash();
-    }
-
     /**
      * \brief Convert a LPCWSTR (may be nullptr) to a UTF-8 std::string for comparison.
      *        Works for both LPWSTR and LPTSTR (which = LPWSTR when CharacterSet=Unicode).
@@ -257,6 +204,19 @@ std::expected<void, std::string> models::InstanceConfig::VerifyReleaseIntegrity(
     {
         const auto& hashCfg = release.checksum.value();
 
+        if (hashCfg.checksumAlg == ChecksumAlgorithm::Invalid)
+        {
+            spdlog::error("Checksum verification: invalid algorithm specified in manifest");
+            return std::unexpected("Invalid checksum algorithm specified in manifest");
+        }
+
+        if (hashCfg.checksumAlg == ChecksumAlgorithm::XXH3_128)
+        {
+            spdlog::error("Checksum verification: XXH3_128 is not a cryptographic hash, "
+                          "it's only supported for product detection");
+            return std::unexpected("XXH3_128 can't be used to verify a download, use SHA256 or BLAKE3");
+        }
+
         if (!std::filesystem::exists(tempFile))
         {
             spdlog::error("Checksum verification: downloaded file not found at {}", tempFile.string());
@@ -264,23 +224,30 @@ std::expected<void, std::string> models::InstanceConfig::VerifyReleaseIntegrity(
         }
 
         std::string computed;
-        switch (hashCfg.checksumAlg)
+
+        // The download write path hashes the payload as it arrives; accept that digest if it
+        // covers exactly the bytes on disk, otherwise fall back to reading the file again.
+        std::error_code ec;
+        const auto fileSize = std::filesystem::file_size(tempFile, ec);
+        const auto& hasher = release.payloadHasher;
+
+        if (!ec && hasher.IsValid() && hasher.GetAlgorithm() == hashCfg.checksumAlg && hasher.GetBytesHashed() == fileSize)
+        {
+            spdlog::debug("Checksum verification: using digest computed during download ({} bytes)", fileSize);
+            computed = hasher.GetHash();
+        }
+        else
         {
-            case ChecksumAlgorithm::MD5:
-                spdlog::debug("Checksum verification: hashing with MD5");
-                computed = HashFileMD5(tempFile.string());
-                break;
-            case ChecksumAlgorithm::SHA1:
-                spdlog::debug("Checksum verification: hashing with SHA1");
-                computed = HashFileSHA1(tempFile.string());
-                break;
-            case ChecksumAlgorithm::SHA256:
-                spdlog::debug("Checksum verification: hashing with SHA256");
-                computed = HashFileSHA256(tempFile.string());
-                break;
-            case ChecksumAlgorithm::Invalid:
-                spdlog::error("Checksum verification: invalid algorithm specified in manifest");
-                return std::unexpected("Invalid checksum algorithm specified in manifest");
+            spdlog::debug("Checksum verification: hashing with {}", magic_enum::enum_name(hashCfg.checksumAlg));
+
+            if (const auto digests = hashing::HashFile(tempFile, {hashCfg.checksumAlg}); digests.has_value())
+            {
+                computed = digests.value().front();
+            }
+            else
+            {
+                spdlog::error("Checksum verification: {}", digests.error());
+            }
         }
 
         if (computed.empty())
@@ -315,10 +282,17 @@ std::expected<void, std::string> models::InstanceConfig::VerifyReleaseIntegrity(
     //
     const auto verificationMode = merged.signatureVerificationMode;
 
+    // Only a payload that passed verification may be shared with the other instances on this machine
+    auto accept = [this, &tempFile]() -> std::expected<void, std::string>
+    {
+        AddToDownloadCache(tempFile);
+        return {};
+    };
+
     if (verificationMode == SignatureVerificationMode::Disabled)
     {
         spdlog::info("Authenticode verification is disabled by configuration");
-        return {};
+        return accept();
     }
 
     // Resolve effective policy and strategy (release-level overrides global)
@@ -339,12 +313,12 @@ std::expected<void, std::string> models::InstanceConfig::VerifyReleaseIntegrity(
             sigResult.error().find("not signed") != std::string::npos)
         {
             spdlog::warn("Authenticode verification: file is unsigned, accepting (WhenPresent mode)");
-            return {};
+            return accept();
         }
         return std::unexpected(sigResult.error());
     }
 
-    return {};
+    return accept();
 }
 
 // ============================================================================
@@ -518,174 +492,11 @@ std::expected<void, std::string> models::InstanceConfig::VerifySetupSignature(
 
 #if defined(NV_MANIFEST_PUBLIC_KEY)
 
-/**
- * \brief Parse a minisign .minisig file and extract the raw Ed25519 signature bytes.
- *
- * The minisign .minisig format is:
- *   Line 0: comment ("untrusted comment: ...")
- *   Line 1: base64-encoded  "signature_algorithm (2 bytes) || key_id (8 bytes) || signature (64 bytes)"
- *   Line 2: trusted comment ("trusted comment: ...")
- *   Line 3: base64-encoded global signature (covers trusted comment + file signature)
- *
- * We only need line 1 to verify the file body.
- */
-static bool ParseMinisigFile(const std::string& minisigBody,
-                             std::string& outKeyId,
-                             std::vector<unsigned char>& outSig,
-                             bool& outPrehashed)
-{
-    // Split into lines
-    std::vector<std::string> lines;
-    std::istringstream ss(minisigBody);
-    std::string line;
-    while (std::getline(ss, line))
-    {
-        // Strip CR
-        if (!line.empty() && line.back() == '\r') line.pop_back();
-        if (!line.empty()) lines.push_back(line);
-    }
-
-    if (lines.size() < 2) return false;
-
-    // Decode line 1 (base64)
-    const auto& b64 = lines[1];
-    const size_t decodedLen = b64.size(); // base64 text is always longer than its decoded form
-    std::vector<unsigned char> decoded(decodedLen);
-    size_t actualLen = 0;
-
-    if (sodium_base642bin(decoded.data(), decodedLen, b64.c_str(), b64.size(),
-                          nullptr, &actualLen, nullptr, sodium_base64_VARIANT_ORIGINAL) != 0)
-    {
-        return false;
-    }
-
-    // Layout: 2 bytes algo + 8 bytes key id + 64 bytes Ed25519 sig = 74 bytes total
-    if (actualLen < 74) return false;
-
-    // First 2 bytes: algorithm tag.
-    //   "Ed" = legacy   : pure Ed25519 over the raw message
-    //   "ED" = prehashed : Ed25519 over BLAKE2b-512 of the message
-    // minisign has defaulted to the prehashed ("ED") format since 0.6, so we
-    // must accept both and verify accordingly (see VerifyManifestSignature).
-    if (decoded[0] != 'E') return false;
-    if (decoded[1] == 'd')      outPrehashed = false;
-    else if (decoded[1] == 'D') outPrehashed = true;
-    else                        return false;
-
-    // Bytes 2-9: key id (we store as hex string for logging)
-    std::string keyId;
-    keyId.reserve(16);
-    for (int i = 2; i < 10; ++i)
-    {
-        char buf[3];
-        std::snprintf(buf, sizeof(buf), "%02x", decoded[i]);
-        keyId += buf;
-    }
-    outKeyId = keyId;
-
-    // Bytes 10-73: Ed25519 signature
-    outSig.assign(decoded.begin() + 10, decoded.begin() + 10 + crypto_sign_BYTES);
-    return true;
-}
-
-/**
- * \brief Decode the base64 public key from the NV_MANIFEST_PUBLIC_KEY string.
- *        The key string is the second line of a minisign .pub file.
- *        Layout: 2 bytes algo + 8 bytes key id + 32 bytes public key = 42 bytes.
- */
-static bool ParseMinisignPublicKey(const char* pubKeyStr,
-                                   std::vector<unsigned char>& outPubKey)
-{
-    const size_t maxLen = strlen(pubKeyStr); // base64 text is always longer than its decoded form
-    std::vector<unsigned char> decoded(maxLen);
-    size_t actualLen = 0;
-
-    if (sodium_base642bin(decoded.data(), maxLen, pubKeyStr, strlen(pubKeyStr),
-                          nullptr, &actualLen, nullptr, sodium_base64_VARIANT_ORIGINAL) != 0)
-    {
-        return false;
-    }
-
-    if (actualLen < 42) return false;                    // 2 + 8 + 32
-    if (decoded[0] != 'E' || decoded[1] != 'd') return false;
-
-    outPubKey.assign(decoded.begin() + 10, decoded.begin() + 10 + crypto_sign_PUBLICKEYBYTES);
-    return true;
-}
-
 std::expected<void, std::string> models::InstanceConfig::VerifyManifestSignature(
     const std::string& manifestBody,
     const std::string& minisigBody)
 {
-    if (sodium_init() < 0)
-    {
-        return std::unexpected("Failed to initialize libsodium");
-    }
-
-    // Parse the .minisig sidecar
-    std::string keyId;
-    std::vector<unsigned char> sig;
-    bool prehashed = false;
-    if (!ParseMinisigFile(minisigBody, keyId, sig, prehashed))
-    {
-        return std::unexpected("Failed to parse manifest signature file (.minisig)");
-    }
-
-    spdlog::debug("VerifyManifestSignature: key id from .minisig = {}", keyId);
-
-    if (sig.size() != crypto_sign_BYTES)
-    {
-        return std::unexpected(std::format("Invalid signature length: expected {}, got {}",
-                                           crypto_sign_BYTES, sig.size()));
-    }
-
-    // Decode the compiled-in public key
-    std::vector<unsigned char> pubKey;
-    if (!ParseMinisignPublicKey(NV_MANIFEST_PUBLIC_KEY, pubKey))
-    {
-        return std::unexpected("Failed to decode the compiled-in manifest public key (NV_MANIFEST_PUBLIC_KEY)");
-    }
-
-    if (pubKey.size() != crypto_sign_PUBLICKEYBYTES)
-    {
-        return std::unexpected("Invalid compiled-in public key length");
-    }
-
-    // Verify the detached Ed25519 signature. In prehashed ("ED") mode the
-    // signature covers BLAKE2b-512 of the body (minisign's default), so we must
-    // hash the manifest first and verify over the 64-byte digest; in legacy
-    // ("Ed") mode the signature covers the raw body directly.
-    int result;
-    if (prehashed)
-    {
-        unsigned char digest[crypto_generichash_BYTES_MAX];
-        crypto_generichash(
-            digest, sizeof digest,
-            reinterpret_cast<const unsigned char*>(manifestBody.data()),
-            manifestBody.size(),
-            nullptr, 0
-        );
-        result = crypto_sign_verify_detached(sig.data(), digest, sizeof digest, pubKey.data());
-    }
-    else
-    {
-        result = crypto_sign_verify_detached(
-            sig.data(),
-            reinterpret_cast<const unsigned char*>(manifestBody.data()),
-            manifestBody.size(),
-            pubKey.data()
-        );
-    }
-
-    if (result != 0)
-    {
-        spdlog::error("VerifyManifestSignature: Ed25519 signature verification FAILED ({} mode)",
-                      prehashed ? "prehashed" : "legacy");
-        return std::unexpected("Manifest signature is invalid - the update manifest may have been tampered with");
-    }
-
-    spdlog::info("VerifyManifestSignature: manifest signature valid");
-    return {};
+    return minisign::VerifySignature(manifestBody, minisigBody, NV_MANIFEST_PUBLIC_KEY);
 }
 
 bool models::InstanceConfig::CheckAndUpdateManifestVersion(const uint64_t signedVersion) const
@@ -1,12 +1,160 @@
 #include "pch.h"
+#include "BlockWriter.h"
+#include "DeltaPatch.h"
+#include "DownloadCache.h"
 #include "Http.h"
+#include "ManifestParser.h"
+#include "Retry.h"
+#include "Throttle.h"
 #include "Util.h"
 #include "InstanceConfig.hpp"
 
 #include <curlpp/Easy.hpp>
+#include <curlpp/Infos.hpp>
 #include <curlpp/Options.hpp>
 
 
+namespace
+{
+    /**
+     * \brief Returns true if the URL uses HTTPS (or, in debug builds, HTTP localhost).
+     * Rejects http://, file://, and any other non-HTTPS scheme.
+     */
+    bool IsAllowedDownloadUrl(const std::string& url)
+    {
+        if (url.empty()) return false;
+
+        // HTTPS is always allowed
+        if (url.rfind("https://", 0) == 0) return true;
+
+#if !defined(NDEBUG) || defined(NV_FLAGS_ALLOW_HTTP_DOWNLOAD)
+        // In debug builds, allow plain HTTP for local test servers
+        if (url.rfind("http://localhost", 0) == 0 ||
+            url.rfind("http://127.0.0.1", 0) == 0 ||
+            url.rfind("http://[::1]", 0) == 0)
+        {
+            return true;
+        }
+#endif
+
+        return false;
+    }
+
+    /**
+     * \brief Looks up a response header value, tolerating stacks that lowercase header names.
+     */
+    std::string TryGetHeader(const std::unordered_map<std::string, std::string>& headers, const std::string& key)
+    {
+        if (const auto it = headers.find(key); it != headers.end())
+        {
+            return it->second;
+        }
+
+        // Some stacks may lowercase header names.
+        std::string lowerKey = key;
+        for (auto& ch : lowerKey)
+        {
+            ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+        if (const auto it2 = headers.find(lowerKey); it2 != headers.end())
+        {
+            return it2->second;
+        }
+
+        return {};
+    }
+
+    /**
+     * \brief Extracts the attachment file name from a Content-Disposition header value.
+     */
+    std::optional<std::filesystem::path> TryExtractFilenameFromContentDisposition(const std::string& cdHeader)
+    {
+        if (cdHeader.empty())
+        {
+            return std::nullopt;
+        }
+
+        std::vector<std::string> arguments;
+        char dl = ';';
+        size_t start = 0, end = 0;
+
+        while ((start = cdHeader.find_first_not_of(dl, end)) != std::string::npos)
+        {
+            end = cdHeader.find(dl, start);
+            arguments.push_back(cdHeader.substr(start, end - start));
+        }
+
+        if (arguments.size() < 2)
+        {
+            return std::nullopt;
+        }
+
+        const auto& filename = arguments[ 1 ];
+        std::regex productRegex("filename=(.*)", std::regex_constants::icase);
+        auto matchesBegin = std::sregex_iterator(filename.begin(), filename.end(), productRegex);
+        auto matchesEnd = std::sregex_iterator();
+
+        if (matchesBegin == matchesEnd)
+        {
+            return std::nullopt;
+        }
+
+        const std::smatch& match = *matchesBegin;
+        return std::filesystem::path(match[ 1 ].str());
+    }
+
+    /**
+     * \brief Checks whether a partial download sits in the current user's temp directory, and neither
+     *        grants anyone but the user and admins write access.
+     * \remarks The profile above the temp directory is private to the user by default.
+     */
+    bool IsInPrivateTemporaryDirectory(const std::filesystem::path& filePath)
+    {
+        const auto tempDir = winapi::GetUserTemporaryDirectory();
+        if (!tempDir.has_value())
+        {
+            return false;
+        }
+
+        std::error_code ec;
+        if (!std::filesystem::equivalent(filePath.parent_path(), tempDir.value(), ec) || ec)
+        {
+            return false;
+        }
+
+        return winapi::IsPrivateToCurrentUser(tempDir.value()) && winapi::IsPrivateToCurrentUser(filePath);
+    }
+
+    /**
+     * \brief Stores a raw "Key: Value" header line; a new status line (redirect) starts over.
+     */
+    void CollectHeaderLine(const char* buffer, const size_t bytes, std::unordered_map<std::string, std::string>& fields)
+    {
+        const std::string line(buffer, buffer + bytes);
+
+        if (line.rfind("HTTP/", 0) == 0)
+        {
+            fields.clear();
+            return;
+        }
+
+        const auto colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            return;
+        }
+
+        std::string key = util::trim(line.substr(0, colon), " \t");
+        std::string value = util::trim(line.substr(colon + 1), " \t\r\n");
+
+        if (!key.empty())
+        {
+            fields[ key ] = value;
+        }
+    }
+}
+
+
 std::list<std::string> models::InstanceConfig::BuildCommonHeaders() const
 {
     std::list<std::string> lines;
@@ -44,7 +192,180 @@ std::list<std::string> models::InstanceConfig::BuildCommonHeaders() const
     return lines;
 }
 
-std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_progress_callback progressFn, const int releaseIndex)
+std::unique_ptr<web::BandwidthThrottle> models::InstanceConfig::CreateDownloadThrottle() const
+{
+    // never hold back a user watching the progress bar
+    if (!isSilent)
+    {
+        return nullptr;
+    }
+
+    const uint64_t rateLimit = cliBackgroundRateLimit.value_or(merged.backgroundDownloadRateLimit);
+    if (rateLimit == 0)
+    {
+        return nullptr;
+    }
+
+    const bool adaptive = cliBackgroundRateAdaptive || merged.backgroundDownloadAdaptive;
+
+    spdlog::info("Limiting background download to {} B/s{}", rateLimit, adaptive ? " (adaptive)" : "");
+
+    return std::make_unique<web::BandwidthThrottle>(rateLimit, adaptive);
+}
+
+std::expected<void, std::string> models::InstanceConfig::RepairCorruptChunks(
+    const hashing::ChunkVerifier& verifier,
+    const std::vector<size_t>& chunks,
+    const std::string& userAgent)
+{
+    auto& release = GetSelectedRelease();
+    const uint64_t chunkSize = verifier.GetChunkSize();
+
+    // each chunk is verified in memory before it's written
+    if (chunkSize > MAX_REPAIR_CHUNK_SIZE)
+    {
+        return std::unexpected(std::format("Chunks of {} bytes are too large to repair individually", chunkSize));
+    }
+
+    std::fstream file(release.localTempFilePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open())
+    {
+        return std::unexpected(std::format("Failed to open {} for repair", release.localTempFilePath.string()));
+    }
+
+    const std::list<std::string> headerLines = BuildCommonHeaders();
+
+    for (const size_t index : chunks)
+    {
+        if (abortDownloadRequested.load(std::memory_order_relaxed))
+        {
+            return std::unexpected("Download cancelled.");
+        }
+
+        if (index >= verifier.GetChunkCount())
+        {
+            return std::unexpected(std::format("Chunk {} is beyond the end of the release", index));
+        }
+
+        const uint64_t begin = index * chunkSize;
+        // the final chunk's length isn't known up front
+        const auto range = index + 1 == verifier.GetChunkCount()
+                               ? std::format("{}-", begin)
+                               : std::format("{}-{}", begin, begin + chunkSize - 1);
+
+        std::string body{};
+        body.reserve(static_cast<size_t>(chunkSize));
+
+        try
+        {
+            auto writeCallback = [&body, chunkSize](char* ptr, size_t size, size_t nmemb) -> size_t
+            {
+                const size_t bytes = size * nmemb;
+                if (body.size() + bytes > chunkSize)
+                {
+                    return 0; // abort transfer
+                }
+
+                body.append(ptr, bytes);
+                return bytes;
+            };
+
+            auto& transferContext = web::TransferContext::Instance();
+            const web::EasyHandle req = transferContext.Acquire();
+            const auto timingGuard = sg::make_scope_guard([&] { transferContext.RecordTransfer(*req); });
+            req->setOpt(curlpp::options::Url(release.downloadUrl));
+            req->setOpt(curlpp::options::UserAgent(userAgent));
+            req->setOpt(curlpp::options::FollowLocation(true));
+            req->setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
+            req->setOpt(curlpp::options::HttpHeader(headerLines));
+            req->setOpt(curlpp::options::ConnectTimeout(60));
+            req->setOpt(curlpp::options::LowSpeedLimit(1));
+            req->setOpt(curlpp::options::LowSpeedTime(MAX_TIMEOUT_SECS));
+            req->setOpt(curlpp::options::Range(range));
+            req->setOpt(curlpp::options::WriteFunction(writeCallback));
+            web::PerformCancellable(*req, downloadStopSource.get_token());
+
+            if (const auto code = curlpp::infos::ResponseCode::get(*req); code != httplib::PartialContent_206)
+            {
+                return std::unexpected(std::format("Re-fetching chunk {} returned HTTP {}", index, code));
+            }
+        }
+        catch (const curlpp::RuntimeError& e)
+        {
+            return std::unexpected(std::format("Re-fetching chunk {} failed: {}", index, e.what()));
+        }
+        catch (const curlpp::LogicError& e)
+        {
+            return std::unexpected(std::format("Re-fetching chunk {} failed: {}", index, e.what()));
+        }
+
+        if (!verifier.VerifyChunk(index, body.data(), body.size()))
+        {
+            return std::unexpected(std::format("Re-fetched chunk {} doesn't match its digest", index));
+        }
+
+        file.seekp(static_cast<std::streamoff>(begin));
+        file.write(body.data(), static_cast<std::streamsize>(body.size()));
+        if (!file)
+        {
+            return std::unexpected(std::format("Failed to write repaired chunk {}", index));
+        }
+
+        spdlog::info("Repaired chunk {} ({} bytes at offset {})", index, body.size(), begin);
+    }
+
+    return {};
+}
+
+bool models::InstanceConfig::TryRestoreFromDownloadCache()
+{
+    auto& release = GetSelectedRelease();
+
+    if (!release.checksum.has_value())
+    {
+        return false;
+    }
+
+    // any user on the machine can put files into the cache, so nothing but the digest counts
+    auto& hasher = release.payloadHasher;
+    hasher = hashing::IncrementalHasher(release.checksum->checksumAlg);
+
+    const auto downloadCache = cache::DownloadCache::OpenMachineWide();
+    if (!downloadCache.has_value() ||
+        !downloadCache->Retrieve(release.checksum.value(), release.localTempFilePath, hasher))
+    {
+        return false;
+    }
+
+    if (util::icompare(hasher.GetHash(), release.checksum->checksum))
+    {
+        spdlog::info("Using cached payload ({} bytes), skipping download", hasher.GetBytesHashed());
+        return true;
+    }
+
+    spdlog::warn("Cached payload doesn't match the release checksum, downloading it instead");
+    hasher.Reset();
+
+    DeleteFileW(release.localTempFilePath.c_str());
+    return false;
+}
+
+void models::InstanceConfig::AddToDownloadCache(const std::filesystem::path& filePath)
+{
+    const auto& release = GetSelectedRelease();
+
+    if (!release.checksum.has_value())
+    {
+        return;
+    }
+
+    if (const auto downloadCache = cache::DownloadCache::OpenMachineWide(); downloadCache.has_value())
+    {
+        downloadCache->Store(release.checksum.value(), filePath);
+    }
+}
+
+std::expected<int, std::string> models::InstanceConfig::DownloadRelease(const int releaseIndex)
 {
     UNREFERENCED_PARAMETER(releaseIndex);
     abortDownloadRequested.store(false, std::memory_order_relaxed);
@@ -104,6 +425,53 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
 
     auto& release = GetSelectedRelease();
 
+    // validators of the response the bytes on disk stem from, sent as If-Range when resuming
+    std::string resumeEtag{};
+    std::string resumeLastModified{};
+    std::optional<std::filesystem::path> cachedAttachmentName{};
+
+    PurgeStaleResumeJournals(release.downloadUrl);
+
+    // Pick up the partial file an earlier run (or an earlier call of this one) left behind
+    if (const auto journal = LoadResumeJournal(release.downloadUrl);
+        journal.has_value() &&
+        (release.localTempFilePath.empty() || release.localTempFilePath == journal->tempFile))
+    {
+        if (release.localTempFilePath.empty())
+        {
+            spdlog::info("Continuing download of {} from an earlier run ({} bytes)", journal->tempFile,
+                         journal->bytesCommitted);
+            release.localTempFilePath = journal->tempFile;
+        }
+
+        resumeEtag = journal->etag;
+        resumeLastModified = journal->lastModified;
+
+        if (!journal->attachmentName.empty())
+        {
+            cachedAttachmentName = journal->attachmentName;
+        }
+
+        // The journaled digest spares reading the whole prefix back, but it only vouches for the
+        // bytes on disk if nobody else can have modified the file in the meantime. Otherwise the
+        // hasher starts out empty and the partial file is hashed again from offset 0.
+        if (release.checksum.has_value() && journal->hashAlgorithm == release.checksum->checksumAlg &&
+            !journal->hashState.empty() && release.payloadHasher.GetBytesHashed() < journal->bytesCommitted &&
+            IsInPrivateTemporaryDirectory(journal->tempFile))
+        {
+            hashing::IncrementalHasher hasher(journal->hashAlgorithm);
+
+            if (hasher.ImportState(journal->bytesCommitted, journal->hashState, journal->hashDigest))
+            {
+                release.payloadHasher = std::move(hasher);
+            }
+            else
+            {
+                spdlog::debug("Journaled digest state not restorable, the partial file will be hashed again");
+            }
+        }
+    }
+
     // Reuse existing temp file if present (allows resuming across user retries)
     if (release.localTempFilePath.empty())
     {
@@ -123,36 +491,20 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
         spdlog::debug("Using existing temp file {}", release.localTempFilePath);
     }
 
-    std::ofstream outStream{};
-    const std::ios_base::iostate exceptionMask = outStream.exceptions() | std::ios::failbit;
-    outStream.exceptions(exceptionMask);
-
-    int retryCount = MAX_RETRY_COUNT;
-    long currentTimeoutSecs = MAX_TIMEOUT_SECS;
-    constexpr long kMaxTimeoutSecs = MAX_TIMEOUT_SECS_TOTAL;
+    io::BlockWriter writer{};
+
+    // no time budget; a download making progress must never be cut short, the attempts bound it
+    retry::RetryPolicy retryPolicy({
+        .maxAttempts        = MAX_RETRY_COUNT,
+        .initialTimeoutSecs = MAX_TIMEOUT_SECS,
+        .maxTimeoutSecs     = MAX_TIMEOUT_SECS_TOTAL,
+    });
+    const std::stop_token abortToken = downloadStopSource.get_token();
+    const std::unique_ptr<web::BandwidthThrottle> throttle = CreateDownloadThrottle();
+    hashing::ChunkVerifier chunkVerifier = release.checksum.has_value()
+                                               ? release.checksum->CreateChunkVerifier()
+                                               : hashing::ChunkVerifier{};
     std::string lastFailureDetails{};
-    std::optional<std::filesystem::path> cachedAttachmentName{};
-
-    auto tryGetHeader = [](const auto& headers, const std::string& key) -> std::string
-    {
-        if (const auto it = headers.find(key); it != headers.end())
-        {
-            return it->second;
-        }
-
-        // Some stacks may lowercase header names.
-        std::string lowerKey = key;
-        for (auto& ch : lowerKey)
-        {
-            ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-        }
-        if (const auto it2 = headers.find(lowerKey); it2 != headers.end())
-        {
-            return it2->second;
-        }
-
-        return {};
-    };
 
     auto tryParseTotalSizeFromContentRange = [](const std::string& contentRange) -> std::optional<uint64_t>
     {
@@ -195,42 +547,245 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
         return 0ULL;
     };
 
-    while (true)
+    auto renameToAttachment = [&release](const std::filesystem::path& attachmentName)
     {
-        if (abortDownloadRequested.load(std::memory_order_relaxed))
+        std::filesystem::path newLocation = release.localTempFilePath;
+        newLocation.replace_filename(attachmentName);
+
+        // If the server-supplied filename already matches our current path, don't "rename".
+        // Otherwise we'd delete the file and then fail to move it (ERROR_FILE_NOT_FOUND).
+        if (newLocation == release.localTempFilePath)
         {
-            spdlog::info("Download aborted before starting next attempt");
-            return std::unexpected("Download cancelled.");
+            spdlog::debug("Skipping rename; already named {}", newLocation);
+            return;
         }
 
-        const auto ua = std::format("{}/{}", appFilename, appVersion.str());
+        spdlog::debug("Renaming {} to {}", release.localTempFilePath, newLocation);
 
-        std::optional<uint64_t> expectedSize{};
-        if (release.downloadSize.has_value())
+        DeleteFileA(newLocation.string().c_str());
+
+        // some setups with bootstrappers (like InnoSetup) require the original .exe extension
+        // otherwise it will fail to launch itself elevated with a "ShellExecuteEx failed" error.
+        if (!MoveFileA(release.localTempFilePath.string().c_str(), newLocation.string().c_str()))
         {
-            expectedSize = static_cast<uint64_t>(release.downloadSize.value());
+            spdlog::error("Failed to rename {} to {}, error: {:#x}", release.localTempFilePath,
+                          newLocation, GetLastError());
         }
-
-        uint64_t localSize = getLocalSize();
-
-        if (expectedSize.has_value() && localSize == expectedSize.value())
+        else
         {
-            spdlog::info("Local file already complete ({} bytes), skipping download", localSize);
-            return httplib::OK_200;
+            release.localTempFilePath = newLocation;
         }
+    };
 
-        // Without an expected size, reuse a non-empty local file only when a checksum is
-        // configured downstream -- the checksum verification will catch any truncated or
-        // interrupted file.  Without that backstop an interrupted temp file would be
-        // accepted silently (especially in WhenPresent Authenticode mode), so we fall
-        // through and let the server respond; a 416 is already handled below by restarting.
-        if (!expectedSize.has_value() && localSize > 0 && release.checksum.has_value())
+    // A fresh response replaces the validators, a partial one only ever confirms them
+    auto rememberValidators = [&](const std::unordered_map<std::string, std::string>& headers, const long httpCode)
+    {
+        if (httpCode == httplib::OK_200)
         {
-            spdlog::info("Reusing existing local download ({} bytes), checksum will verify integrity", localSize);
-            return httplib::OK_200;
+            resumeEtag = TryGetHeader(headers, "ETag");
+            resumeLastModified = TryGetHeader(headers, "Last-Modified");
         }
-
-        // If local size exceeds expected, drop it and start over
+        else if (httpCode == httplib::PartialContent_206)
+        {
+            if (const auto etag = TryGetHeader(headers, "ETag"); !etag.empty()) resumeEtag = etag;
+            if (const auto lm = TryGetHeader(headers, "Last-Modified"); !lm.empty()) resumeLastModified = lm;
+        }
+    };
+
+    // Records how far the download got, so a later run can continue where this one stopped
+    auto saveResumeJournal = [&](const uint64_t bytesCommitted)
+    {
+        if (bytesCommitted == 0)
+        {
+            PurgeResumeJournal(release.downloadUrl);
+            return;
+        }
+
+        ResumeJournal journal{
+            .url = release.downloadUrl,
+            .tempFile = release.localTempFilePath,
+            .etag = resumeEtag,
+            .lastModified = resumeLastModified,
+            .bytesCommitted = bytesCommitted,
+            .attachmentName = cachedAttachmentName.has_value() ? cachedAttachmentName->string() : std::string{},
+        };
+
+        // the digest is only of use if it covers exactly the committed bytes and its state can be
+        // saved, an MD5 download re-hashes the partial file when resumed
+        if (const auto& hasher = release.payloadHasher; hasher.IsValid() && hasher.GetBytesHashed() == bytesCommitted)
+        {
+            if (auto hashState = hasher.ExportState(); !hashState.empty())
+            {
+                journal.hashAlgorithm = hasher.GetAlgorithm();
+                journal.hashState = std::move(hashState);
+                journal.hashDigest = hasher.GetHash();
+            }
+        }
+
+        StoreResumeJournal(journal);
+    };
+
+    const auto ua = std::format("{}/{}", appFilename, appVersion.str());
+
+    // Another updater instance on this machine may have fetched the very same payload already
+    if (getLocalSize() == 0 && TryRestoreFromDownloadCache())
+    {
+        return httplib::OK_200;
+    }
+
+    // A matching binary patch beats any full download; if it can't be fetched or doesn't reproduce
+    // the release checksum, nothing is kept and the full download below takes over.
+    if (getLocalSize() == 0)
+    {
+        const auto patched = DownloadReleasePatch(ua, throttle.get());
+
+        if (patched.has_value() && patched.value())
+        {
+            return httplib::OK_200;
+        }
+
+        if (!patched.has_value())
+        {
+            if (abortDownloadRequested.load(std::memory_order_relaxed))
+            {
+                return std::unexpected("Download cancelled.");
+            }
+
+            spdlog::warn("Patching failed ({}), falling back to the full download", patched.error());
+        }
+    }
+
+#if NV_DOWNLOAD_SEGMENTS > 1
+    // Fresh downloads of large payloads are split into parallel byte-range segments if the server
+    // supports it; on any failure the partial data is discarded and the single-stream loop below
+    // takes over (which then also produces the user-facing error, if any).
+    if (getLocalSize() == 0)
+    {
+        const auto segmented = DownloadReleaseSegmented(ua, cachedAttachmentName, throttle.get());
+
+        if (segmented.has_value() && segmented.value())
+        {
+            if (cachedAttachmentName.has_value())
+            {
+                renameToAttachment(cachedAttachmentName.value());
+            }
+
+            // with chunk digests the loop below checks the result first, and repairs it if necessary
+            if (!chunkVerifier.IsEnabled())
+            {
+                return httplib::OK_200;
+            }
+        }
+
+        if (!segmented.has_value())
+        {
+            if (abortDownloadRequested.load(std::memory_order_relaxed))
+            {
+                return std::unexpected("Download cancelled.");
+            }
+
+            spdlog::warn("Segmented download failed ({}), falling back to a single stream", segmented.error());
+        }
+    }
+#endif
+
+    while (true)
+    {
+        if (abortDownloadRequested.load(std::memory_order_relaxed))
+        {
+            spdlog::info("Download aborted before starting next attempt");
+            return std::unexpected("Download cancelled.");
+        }
+
+        std::optional<uint64_t> expectedSize{};
+        if (release.downloadSize.has_value())
+        {
+            expectedSize = static_cast<uint64_t>(release.downloadSize.value());
+        }
+
+        uint64_t localSize = getLocalSize();
+
+        // With chunk digests the bytes already on disk needn't be taken on faith: corrupt chunks are
+        // fetched again in place and an unverifiable tail is dropped, so one bad block no longer
+        // fails the checksum of the whole file after the fact.
+        if (chunkVerifier.IsEnabled() && localSize > 0 &&
+            (!expectedSize.has_value() || localSize <= expectedSize.value()))
+        {
+            const uint64_t chunkSize = chunkVerifier.GetChunkSize();
+            const uint64_t finalChunkBegin = (chunkVerifier.GetChunkCount() - 1) * chunkSize;
+            // a partial chunk can only be checked if it's the final one
+            const uint64_t checkEnd = localSize > finalChunkBegin ? localSize : localSize - localSize % chunkSize;
+            // what this process verified while writing it needn't be read back
+            const uint64_t checkBegin = std::min(chunkVerifier.GetVerifiedLength(), checkEnd);
+            uint64_t validEnd = checkEnd;
+
+            if (checkBegin < checkEnd)
+            {
+                const auto corrupt = chunkVerifier.FindCorruptChunks(release.localTempFilePath, checkBegin, checkEnd);
+
+                if (!corrupt.has_value())
+                {
+                    spdlog::warn("Failed to verify chunks of the partial download: {}", corrupt.error());
+                    validEnd = checkBegin;
+                }
+                else if (!corrupt->empty())
+                {
+                    spdlog::warn("{} chunk(s) of the partial download are corrupt, fetching them again",
+                                 corrupt->size());
+
+                    if (const auto repaired = RepairCorruptChunks(chunkVerifier, corrupt.value(), ua); !repaired)
+                    {
+                        spdlog::warn("Failed to repair chunks ({}), resuming from the first corrupt one",
+                                     repaired.error());
+                        validEnd = corrupt->front() * chunkSize;
+                    }
+                    else if (corrupt->back() + 1 == chunkVerifier.GetChunkCount())
+                    {
+                        // repairing the final chunk completed the file
+                        validEnd = getLocalSize();
+                    }
+
+                    // the running digest no longer matches what's on disk
+                    release.payloadHasher.Reset();
+                }
+            }
+
+            if (validEnd < getLocalSize())
+            {
+                spdlog::info("Discarding unverified data past offset {}", validEnd);
+
+                std::error_code ec;
+                std::filesystem::resize_file(release.localTempFilePath, validEnd, ec);
+                if (ec)
+                {
+                    spdlog::error("Failed to truncate file {}, error {}", release.localTempFilePath, ec.message());
+                    return std::unexpected(std::format("Failed to truncate temporary file: {}", ec.message()));
+                }
+            }
+
+            localSize = getLocalSize();
+        }
+
+        if (expectedSize.has_value() && localSize == expectedSize.value())
+        {
+            spdlog::info("Local file already complete ({} bytes), skipping download", localSize);
+            PurgeResumeJournal(release.downloadUrl);
+            return httplib::OK_200;
+        }
+
+        // Without an expected size, reuse a non-empty local file only when a checksum is
+        // configured downstream -- the checksum verification will catch any truncated or
+        // interrupted file.  Without that backstop an interrupted temp file would be
+        // accepted silently (especially in WhenPresent Authenticode mode), so we fall
+        // through and let the server respond; a 416 is already handled below by restarting.
+        if (!expectedSize.has_value() && localSize > 0 && release.checksum.has_value())
+        {
+            spdlog::info("Reusing existing local download ({} bytes), checksum will verify integrity", localSize);
+            PurgeResumeJournal(release.downloadUrl);
+            return httplib::OK_200;
+        }
+
+        // If local size exceeds expected, drop it and start over
         if (expectedSize.has_value() && localSize > expectedSize.value())
         {
             spdlog::warn("Local temp file is larger than expected ({} > {}), truncating and restarting",
@@ -240,20 +795,56 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
 
         const bool wantsResume = localSize > 0;
 
-        const std::ios::openmode openMode =
-            std::ios::binary | (wantsResume ? std::ios::app : std::ios::trunc);
+        if (chunkVerifier.IsEnabled())
+        {
+            chunkVerifier.Seek(localSize);
+        }
+
+        // Keep the running payload digest in lockstep with the on-disk file; the existing
+        // prefix only has to be read back if the digest doesn't already cover it, e.g. after
+        // any of the truncate-and-restart paths below or on the first attempt of a new session.
+        if (release.checksum.has_value())
+        {
+            auto& hasher = release.payloadHasher;
 
-        try
+            if (hasher.GetAlgorithm() != release.checksum->checksumAlg)
+            {
+                hasher = hashing::IncrementalHasher(release.checksum->checksumAlg);
+            }
+
+            if (hasher.GetBytesHashed() != localSize)
+            {
+                // a digest lagging behind (e.g. restored from the journal) only needs the difference
+                if (hasher.GetBytesHashed() > localSize)
+                {
+                    hasher.Reset();
+                }
+
+                if (wantsResume && !hasher.CatchUpWithFile(release.localTempFilePath, localSize))
+                {
+                    spdlog::warn("Failed to hash existing {} bytes of {}, checksum will be computed after download",
+                                 localSize, release.localTempFilePath);
+                    // invalid rather than reset, so no later attempt mistakes it for a digest of the prefix
+                    hasher = hashing::IncrementalHasher{};
+                }
+            }
+        }
+
+        if (const auto opened = writer.Open(release.localTempFilePath, wantsResume); !opened)
         {
-            outStream.open(release.localTempFilePath.string(), openMode);
+            spdlog::error("Failed to open file {}, error {}", release.localTempFilePath, opened.error());
+            return std::unexpected(std::format("Failed to open temporary file '{}': {}", release.localTempFilePath.string(), opened.error()));
         }
-        catch (std::ios_base::failure& e)
+
+        // claim the space up front, so the payload ends up in as few fragments as possible
+        bool isSpaceReserved = expectedSize.has_value();
+        if (isSpaceReserved)
         {
-            spdlog::error("Failed to open file {}, error {}", release.localTempFilePath, e.what());
-            return std::unexpected(std::format("Failed to open temporary file '{}': {}", release.localTempFilePath.string(), e.what()));
+            writer.Reserve(expectedSize.value());
         }
 
-        spdlog::debug("Starting release download from {} (timeout {}s)", release.downloadUrl, currentTimeoutSecs);
+        spdlog::debug("Starting release download from {} (timeout {}s)", release.downloadUrl,
+                      retryPolicy.GetTimeoutSecs());
         if (wantsResume)
         {
             const auto rangeHeader = std::format("bytes={}-", localSize);
@@ -265,9 +856,12 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
             std::unordered_map<std::string, std::string> fields{};
             long lastHttpCode{0};
             bool abortBecauseRangeIgnored{false};
+            bool corruptChunk{false};
         };
 
         CurlHeaderCollector headerCollector{};
+        uint64_t bytesWritten = 0;
+        uint64_t nextJournalCheckpoint = RESUME_JOURNAL_INTERVAL;
 
         auto trimInPlace = [](std::string& s)
         {
@@ -347,68 +941,140 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
                 return 0;
             }
 
-            try
+            // a corrupt chunk ends the attempt right away instead of failing the checksum at the very end
+            if (chunkVerifier.IsEnabled() && !chunkVerifier.Add(ptr, bytes))
             {
-                outStream.write(ptr, static_cast<std::streamsize>(bytes));
-                return bytes;
+                headerCollector.corruptChunk = true;
+                return 0;
             }
-            catch (...)
+
+            // holding the write back is what slows the sender down
+            if (throttle && !throttle->Consume(bytes, abortToken))
+            {
+                return 0; // abort transfer
+            }
+
+            // without a size in the manifest, the response headers tell it at the latest
+            if (!isSpaceReserved)
+            {
+                isSpaceReserved = true;
+
+                if (const auto total = tryParseTotalSizeFromContentRange(
+                    TryGetHeader(headerCollector.fields, "Content-Range")); total.has_value())
+                {
+                    writer.Reserve(total.value());
+                }
+                else if (headerCollector.lastHttpCode == httplib::OK_200)
+                {
+                    try
+                    {
+                        writer.Reserve(std::stoull(TryGetHeader(headerCollector.fields, "Content-Length")));
+                    }
+                    catch (...)
+                    {
+                        // no usable length, nothing to reserve
+                    }
+                }
+            }
+
+            // only hands the data over, the disk is written to on the writer's own thread
+            if (!writer.Write(ptr, bytes))
             {
                 return 0; // abort transfer
             }
+
+            release.payloadHasher.Add(ptr, bytes);
+            bytesWritten += bytes;
+
+            // Checkpoint every now and then, so even a killed process leaves its progress behind.
+            // The queued blocks are written out first: a journal ahead of the file on disk doesn't
+            // match its hash state, which then gets rebuilt from the whole partial file instead.
+            if (bytesWritten >= nextJournalCheckpoint)
+            {
+                if (!writer.Flush())
+                {
+                    return 0; // abort transfer, Close reports the error
+                }
+
+                rememberValidators(headerCollector.fields, headerCollector.lastHttpCode);
+                saveResumeJournal(localSize + bytesWritten);
+                nextJournalCheckpoint = bytesWritten + RESUME_JOURNAL_INTERVAL;
+            }
+
+            return bytes;
         };
 
         // Build common vendor + additional headers via the shared helper
         std::list<std::string> headerLines = BuildCommonHeaders();
 
-        curlpp::Easy req;
-        req.setOpt(curlpp::options::Url(release.downloadUrl));
-        req.setOpt(curlpp::options::UserAgent(ua));
-        req.setOpt(curlpp::options::FollowLocation(true));
-        req.setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
-        req.setOpt(curlpp::options::HttpHeader(headerLines));
+        // Only continue the very file the bytes on disk stem from; if it changed in the meantime,
+        // the server answers with all of the new one instead and the download starts over
+        if (wantsResume)
+        {
+            if (!resumeEtag.empty() && !resumeEtag.starts_with("W/"))
+            {
+                headerLines.push_back(std::format("If-Range: {}", resumeEtag));
+            }
+            else if (!resumeLastModified.empty())
+            {
+                headerLines.push_back(std::format("If-Range: {}", resumeLastModified));
+            }
+        }
+
+        auto& transferContext = web::TransferContext::Instance();
+        const web::EasyHandle req = transferContext.Acquire();
+        const auto timingGuard = sg::make_scope_guard([&] { transferContext.RecordTransfer(*req); });
+        req->setOpt(curlpp::options::Url(release.downloadUrl));
+        req->setOpt(curlpp::options::UserAgent(ua));
+        req->setOpt(curlpp::options::FollowLocation(true));
+        req->setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
+        req->setOpt(curlpp::options::HttpHeader(headerLines));
 
         // Prefer "stall" timeouts: don't abort if bytes still trickle in.
-        req.setOpt(curlpp::options::ConnectTimeout(60));
-        req.setOpt(curlpp::options::LowSpeedLimit(1));
-        req.setOpt(curlpp::options::LowSpeedTime(currentTimeoutSecs));
+        req->setOpt(curlpp::options::ConnectTimeout(60));
+        req->setOpt(curlpp::options::LowSpeedLimit(1));
+        req->setOpt(curlpp::options::LowSpeedTime(retryPolicy.GetTimeoutSecs()));
 
         // Streaming write + header collection
-        req.setOpt(curlpp::options::WriteFunction(writeCallback));
-        req.setOpt(curlpp::options::HeaderFunction(headerCallback));
+        req->setOpt(curlpp::options::WriteFunction(writeCallback));
+        req->setOpt(curlpp::options::HeaderFunction(headerCallback));
+
+        // Progress; curl counts from the resume offset
+        const uint64_t resumeOffset = wantsResume ? localSize : 0;
+        downloadProgress.SetPhase(web::DownloadPhase::Starting, resumeOffset, expectedSize.value_or(0));
 
-        // Progress (always enabled so we can abort on shutdown)
-        auto progressCallback = [this, progressFn](double dltotal, double dlnow, double ultotal, double ulnow) -> int
+        web::TransferInfoCallback progressCallback = [this, &throttle, &req, resumeOffset, &expectedSize](
+            curl_off_t dltotal, curl_off_t dlnow) -> int
         {
-            if (abortDownloadRequested.load(std::memory_order_relaxed))
+            if (throttle)
             {
-                return 1; // abort transfer
+                throttle->SampleRtt(req->getHandle());
             }
 
-            if (progressFn != nullptr)
-            {
-                return progressFn(nullptr, dltotal, dlnow, ultotal, ulnow);
-            }
+            const uint64_t total = dltotal > 0
+                                       ? resumeOffset + static_cast<uint64_t>(dltotal)
+                                       : expectedSize.value_or(0);
+            downloadProgress.Update(resumeOffset + static_cast<uint64_t>(dlnow), total);
 
             return 0;
         };
-        req.setOpt(curlpp::options::NoProgress(false));
-        req.setOpt(curlpp::options::ProgressFunction(progressCallback));
+        web::SetTransferInfoFunction(*req, progressCallback);
 
         // Resume
         if (wantsResume)
         {
 #ifdef CURLOPT_RESUME_FROM_LARGE
-            req.setOpt(curlpp::options::ResumeFromLarge(static_cast<curl_off_t>(localSize)));
+            req->setOpt(curlpp::options::ResumeFromLarge(static_cast<curl_off_t>(localSize)));
 #else
-            req.setOpt(curlpp::options::ResumeFrom(static_cast<long>(localSize)));
+            req->setOpt(curlpp::options::ResumeFrom(static_cast<long>(localSize)));
 #endif
         }
 
         int code = httplib::OK_200;
         try
         {
-            req.perform();
+            // returns right away on RequestAbortDownload, no matter what the transfer is waiting for
+            web::PerformCancellable(*req, abortToken);
 
             // If we didn't parse an HTTP status line, treat as OK (best-effort).
             code = headerCollector.lastHttpCode != 0 ? static_cast<int>(headerCollector.lastHttpCode) : httplib::OK_200;
@@ -418,23 +1084,22 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
             if (abortDownloadRequested.load(std::memory_order_relaxed))
             {
                 spdlog::info("Download aborted");
+
+                (void)writer.Close();
+                rememberValidators(headerCollector.fields, headerCollector.lastHttpCode);
+                saveResumeJournal(getLocalSize());
+
                 return std::unexpected("Download cancelled.");
             }
 
             // If we aborted because the server ignored the Range request, restart from scratch.
             if (headerCollector.abortBecauseRangeIgnored)
             {
-                spdlog::warn("Server ignored resume (returned 200), restarting from scratch");
-                try
-                {
-                    outStream.close();
-                    outStream.open(release.localTempFilePath.string(), std::ios::binary | std::ios::trunc);
-                    outStream.close();
-                }
-                catch (...)
-                {
-                    // ignore
-                }
+                spdlog::warn("Server ignored resume or the file changed (returned 200), restarting from scratch");
+                (void)writer.Close();
+
+                std::error_code ec;
+                std::filesystem::resize_file(release.localTempFilePath, 0, ec);
 
                 // Retry without consuming a retry slot.
                 continue;
@@ -477,20 +1142,50 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
             code = static_cast<int>(CURLE_FAILED_INIT);
         }
 
-        try { outStream.close(); } catch (...) { }
+        // the attempt only succeeded if everything it received made it to disk
+        if (const auto closed = writer.Close(); !closed)
+        {
+            spdlog::error("Failed to write {}, error {}", release.localTempFilePath, closed.error());
+            lastFailureDetails = closed.error();
+            code = static_cast<int>(CURLE_WRITE_ERROR);
+        }
+
+        // the final chunk can only be checked once the transfer is complete
+        if ((code == httplib::OK_200 || code == httplib::PartialContent_206) &&
+            chunkVerifier.IsEnabled() && !chunkVerifier.Finish())
+        {
+            headerCollector.corruptChunk = true;
+            code = static_cast<int>(CURLE_RECV_ERROR);
+        }
+
+        // Drop everything from the corrupt chunk on, the next attempt resumes right at its start
+        if (headerCollector.corruptChunk)
+        {
+            const uint64_t chunkStart = chunkVerifier.GetOffset();
+            spdlog::warn("Chunk at offset {} failed verification, fetching it again", chunkStart);
+            lastFailureDetails = std::format("Downloaded data at offset {} failed chunk verification", chunkStart);
+
+            std::error_code ec;
+            std::filesystem::resize_file(release.localTempFilePath, chunkStart, ec);
+            if (ec)
+            {
+                spdlog::error("Failed to truncate file {}, error {}", release.localTempFilePath, ec.message());
+                return std::unexpected(std::format("Failed to truncate temporary file: {}", ec.message()));
+            }
+        }
 
         const auto& headers = headerCollector.fields;
 
         // Update expected size from headers if not provided by server JSON
         if (!expectedSize.has_value())
         {
-            if (const auto cr = tryGetHeader(headers, "Content-Range"); !cr.empty())
+            if (const auto cr = TryGetHeader(headers, "Content-Range"); !cr.empty())
             {
                 expectedSize = tryParseTotalSizeFromContentRange(cr);
             }
             else if (code == httplib::OK_200)
             {
-                const auto cl = tryGetHeader(headers, "Content-Length");
+                const auto cl = TryGetHeader(headers, "Content-Length");
                 if (!cl.empty())
                 {
                     try
@@ -507,42 +1202,6 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
 
         const uint64_t finalSize = getLocalSize();
 
-        auto tryExtractFilenameFromContentDisposition = [](const std::string& cdHeader) -> std::optional<std::filesystem::path>
-        {
-            if (cdHeader.empty())
-            {
-                return std::nullopt;
-            }
-
-            std::vector<std::string> arguments;
-            char dl = ';';
-            size_t start = 0, end = 0;
-
-            while ((start = cdHeader.find_first_not_of(dl, end)) != std::string::npos)
-            {
-                end = cdHeader.find(dl, start);
-                arguments.push_back(cdHeader.substr(start, end - start));
-            }
-
-            if (arguments.size() < 2)
-            {
-                return std::nullopt;
-            }
-
-            const auto& filename = arguments[ 1 ];
-            std::regex productRegex("filename=(.*)", std::regex_constants::icase);
-            auto matchesBegin = std::sregex_iterator(filename.begin(), filename.end(), productRegex);
-            auto matchesEnd = std::sregex_iterator();
-
-            if (matchesBegin == matchesEnd)
-            {
-                return std::nullopt;
-            }
-
-            const std::smatch& match = *matchesBegin;
-            return std::filesystem::path(match[ 1 ].str());
-        };
-
         // Treat 206 as success only if file size matches expected
         if (code == httplib::PartialContent_206)
         {
@@ -564,24 +1223,22 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
         if (wantsResume && code == httplib::RangeNotSatisfiable_416)
         {
             spdlog::warn("Server responded 416 to Range request, truncating and restarting");
-            try
-            {
-                outStream.open(release.localTempFilePath.string(), std::ios::binary | std::ios::trunc);
-                outStream.close();
-            }
-            catch (std::ios_base::failure& e)
+
+            std::error_code ec;
+            std::filesystem::resize_file(release.localTempFilePath, 0, ec);
+            if (ec)
             {
-                spdlog::error("Failed to truncate file {}, error {}", release.localTempFilePath, e.what());
-                return std::unexpected(std::format("Failed to truncate temporary file for restart: {}", e.what()));
+                spdlog::error("Failed to truncate file {}, error {}", release.localTempFilePath, ec.message());
+                return std::unexpected(std::format("Failed to truncate temporary file for restart: {}", ec.message()));
             }
         }
 
         // try to grab original filename (may be missing on some retries/ranged requests)
-        const auto cd = tryGetHeader(headers, "Content-Disposition");
+        const auto cd = TryGetHeader(headers, "Content-Disposition");
         if (!cd.empty())
         {
             spdlog::debug("Content-Disposition header value: {}", cd);
-            if (auto parsed = tryExtractFilenameFromContentDisposition(cd); parsed.has_value())
+            if (auto parsed = TryExtractFilenameFromContentDisposition(cd); parsed.has_value())
             {
                 cachedAttachmentName = parsed.value();
             }
@@ -595,7 +1252,7 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
         if (code == httplib::OK_200)
         {
             std::optional<std::filesystem::path> attachmentName{};
-            if (auto parsed = tryExtractFilenameFromContentDisposition(cd); parsed.has_value())
+            if (auto parsed = TryExtractFilenameFromContentDisposition(cd); parsed.has_value())
             {
                 attachmentName = parsed.value();
             }
@@ -606,44 +1263,20 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
 
             if (attachmentName.has_value())
             {
-                std::filesystem::path newLocation = release.localTempFilePath;
-                newLocation.replace_filename(attachmentName.value());
-
-                // If the server-supplied filename already matches our current path, don't "rename".
-                // Otherwise we'd delete the file and then fail to move it (ERROR_FILE_NOT_FOUND).
-                if (newLocation == release.localTempFilePath)
-                {
-                    spdlog::debug("Skipping rename; already named {}", newLocation);
-                }
-                else
-                {
-                    spdlog::debug("Renaming {} to {}", release.localTempFilePath, newLocation);
-
-                    DeleteFileA(newLocation.string().c_str());
-
-                    // some setups with bootstrappers (like InnoSetup) require the original .exe extension
-                    // otherwise it will fail to launch itself elevated with a "ShellExecuteEx failed" error.
-                    if (!MoveFileA(release.localTempFilePath.string().c_str(), newLocation.string().c_str()))
-                    {
-                        spdlog::error("Failed to rename {} to {}, error: {:#x}", release.localTempFilePath,
-                                      newLocation, GetLastError());
-                    }
-                    else
-                    {
-                        release.localTempFilePath = newLocation;
-                    }
-                }
+                renameToAttachment(attachmentName.value());
             }
         }
 
         if (code == httplib::OK_200)
         {
+            PurgeResumeJournal(release.downloadUrl);
             return code;
         }
 
         if (code == httplib::NotFound_404)
         {
             spdlog::error("GET request failed with 404, deleting temporary file {}", release.localTempFilePath);
+            PurgeResumeJournal(release.downloadUrl);
             if (DeleteFileA(release.localTempFilePath.string().c_str()) == FALSE)
             {
                 spdlog::warn("Failed to delete temporary file {}, error {:#x}, message {}", release.localTempFilePath,
@@ -652,19 +1285,33 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
             return std::unexpected("HTTP 404: Not Found");
         }
 
-        if (--retryCount > 0)
+        // whatever made it to disk is continued by the next attempt, or by the next run
+        rememberValidators(headers, headerCollector.lastHttpCode);
+        saveResumeJournal(getLocalSize());
+
+        const retry::Failure failure{
+            .httpCode   = headerCollector.lastHttpCode,
+            .isTimeout  = code == CURLE_OPERATION_TIMEDOUT,
+            .retryAfter = TryGetHeader(headers, "Retry-After"),
+        };
+
+        if (const auto delay = retryPolicy.NextDelay(failure); delay.has_value())
         {
-            spdlog::debug("Web request failed (code {}), retrying {} more time(s)", code, retryCount);
+            spdlog::debug("Web request failed (code {}), retrying in {} ms, {} more time(s)", code, delay->count(),
+                          retryPolicy.GetAttemptsLeft());
+
+            if (failure.isTimeout)
+            {
+                spdlog::info("Request timeout reached, setting new timeout to {} seconds",
+                             retryPolicy.GetTimeoutSecs());
+            }
 
-            if (code == CURLE_OPERATION_TIMEDOUT)
+            if (!retryPolicy.Sleep(delay.value(), abortToken))
             {
-                currentTimeoutSecs = std::min(currentTimeoutSecs * 2, kMaxTimeoutSecs);
-                spdlog::info("Request timeout reached, setting new timeout to {} seconds", currentTimeoutSecs);
+                spdlog::info("Download aborted");
+                return std::unexpected("Download cancelled.");
             }
 
-            std::mt19937_64 eng{std::random_device{}()};
-            std::uniform_int_distribution<> dist{1000, 5000};
-            std::this_thread::sleep_for(std::chrono::milliseconds{dist(eng)});
             continue;
         }
 
@@ -679,346 +1326,1088 @@ std::expected<int, std::string> models::InstanceConfig::DownloadRelease(curl_pro
     }
 }
 
-// ============================================================================
-// Helpers
-// ============================================================================
-
-namespace
+std::expected<bool, std::string> models::InstanceConfig::DownloadReleaseSegmented(
+    const std::string& userAgent,
+    std::optional<std::filesystem::path>& attachmentName,
+    web::BandwidthThrottle* throttle)
 {
-    /**
-     * \brief Returns true if the URL uses HTTPS (or, in debug builds, HTTP localhost).
-     * Rejects http://, file://, and any other non-HTTPS scheme.
-     */
-    bool IsAllowedDownloadUrl(const std::string& url)
-    {
-        if (url.empty()) return false;
+    auto& release = GetSelectedRelease();
+    const std::stop_token abortToken = downloadStopSource.get_token();
+    const std::list<std::string> commonHeaders = BuildCommonHeaders();
 
-        // HTTPS is always allowed
-        if (url.rfind("https://", 0) == 0) return true;
+    //
+    // Probe; the server has to advertise byte-range support and a known length
+    //
+    std::unordered_map<std::string, std::string> probeHeaders{};
+    std::string effectiveUrl{};
 
-#if !defined(NDEBUG) || defined(NV_FLAGS_ALLOW_HTTP_DOWNLOAD)
-        // In debug builds, allow plain HTTP for local test servers
-        if (url.rfind("http://localhost", 0) == 0 ||
-            url.rfind("http://127.0.0.1", 0) == 0 ||
-            url.rfind("http://[::1]", 0) == 0)
+    try
+    {
+        auto headerCallback = [&probeHeaders](char* buffer, size_t size, size_t nitems) -> size_t
         {
-            return true;
+            const size_t bytes = size * nitems;
+            if (buffer != nullptr && bytes > 0)
+            {
+                CollectHeaderLine(buffer, bytes, probeHeaders);
+            }
+            return bytes;
+        };
+
+        auto& transferContext = web::TransferContext::Instance();
+        const web::EasyHandle probe = transferContext.Acquire();
+        const auto timingGuard = sg::make_scope_guard([&] { transferContext.RecordTransfer(*probe); });
+        probe->setOpt(curlpp::options::Url(release.downloadUrl));
+        probe->setOpt(curlpp::options::UserAgent(userAgent));
+        probe->setOpt(curlpp::options::FollowLocation(true));
+        probe->setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
+        probe->setOpt(curlpp::options::HttpHeader(commonHeaders));
+        probe->setOpt(curlpp::options::NoBody(true));
+        probe->setOpt(curlpp::options::ConnectTimeout(60));
+        probe->setOpt(curlpp::options::Timeout(MAX_TIMEOUT_SECS));
+        probe->setOpt(curlpp::options::HeaderFunction(headerCallback));
+        web::PerformCancellable(*probe, abortToken);
+
+        if (const auto code = curlpp::infos::ResponseCode::get(*probe); code != httplib::OK_200)
+        {
+            spdlog::debug("Range probe returned HTTP {}, using a single stream", code);
+            return false;
         }
-#endif
 
+        effectiveUrl = curlpp::infos::EffectiveUrl::get(*probe);
+    }
+    catch (const curlpp::RuntimeError& e)
+    {
+        spdlog::debug("Range probe failed: {}", e.what());
+        return false;
+    }
+    catch (const curlpp::LogicError& e)
+    {
+        spdlog::debug("Range probe failed: {}", e.what());
         return false;
     }
-}
 
-// ============================================================================
-// RequestUpdateInfo
-// ============================================================================
+    if (!util::icompare(TryGetHeader(probeHeaders, "Accept-Ranges"), "bytes"))
+    {
+        spdlog::debug("Server doesn't advertise byte ranges, using a single stream");
+        return false;
+    }
 
-[[nodiscard]] std::expected<void, std::string> models::InstanceConfig::RequestUpdateInfo()
-{
-    const auto ua = std::format("{}/{}", appFilename, appVersion.str());
-    spdlog::debug("Setting User Agent to {}", ua);
+    uint64_t totalSize = 0;
+    try
+    {
+        totalSize = std::stoull(TryGetHeader(probeHeaders, "Content-Length"));
+    }
+    catch (...)
+    {
+        spdlog::debug("Server didn't report the payload size, using a single stream");
+        return false;
+    }
+
+    if (release.downloadSize.has_value() && static_cast<uint64_t>(release.downloadSize.value()) != totalSize)
+    {
+        spdlog::warn("Server reported {} bytes but manifest specifies {}, using a single stream",
+                     totalSize, release.downloadSize.value());
+        return false;
+    }
 
-    long currentTimeoutSecs = MAX_TIMEOUT_SECS;
+    const uint64_t segmentCount = std::min<uint64_t>(NV_DOWNLOAD_SEGMENTS, totalSize / NV_DOWNLOAD_SEGMENT_MIN_SIZE);
+    if (segmentCount < 2)
+    {
+        spdlog::debug("Payload of {} bytes too small for segmenting, using a single stream", totalSize);
+        return false;
+    }
 
-    // Assemble per-request headers once; Accept header prepended here.
-    auto buildManifestHeaders = [&]() -> std::list<std::string>
+    if (const auto parsed = TryExtractFilenameFromContentDisposition(TryGetHeader(probeHeaders, "Content-Disposition"));
+        parsed.has_value())
+    {
+        attachmentName = parsed.value();
+    }
+
+    //
+    // Segments are written into a preallocated side file that only replaces the temp file once
+    // complete, so an interrupted run never leaves a full-sized but partially zero-filled file
+    // behind that the resume logic would mistake for a finished download.
+    //
+    std::filesystem::path partFile = release.localTempFilePath;
+    partFile += ".part";
+
+    std::fstream file{};
+    file.exceptions(file.exceptions() | std::ios::failbit);
+
+    try
+    {
+        file.open(partFile, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    }
+    catch (std::ios_base::failure& e)
+    {
+        spdlog::error("Failed to open file {}, error {}", partFile, e.what());
+        return std::unexpected(std::format("Failed to open temporary file '{}': {}", partFile.string(), e.what()));
+    }
+
+    auto partFileGuard = sg::make_scope_guard([&file, &partFile]
+    {
+        try { file.close(); } catch (...) { }
+        std::error_code ec;
+        std::filesystem::remove(partFile, ec);
+    });
+
+    std::error_code resizeError;
+    std::filesystem::resize_file(partFile, totalSize, resizeError);
+    if (resizeError)
+    {
+        spdlog::error("Failed to preallocate {} bytes for {}, error {}", totalSize, partFile, resizeError.message());
+        return std::unexpected(std::format("Failed to preallocate temporary file: {}", resizeError.message()));
+    }
+
+    // Pin the segments to the probed representation; a changed file answers 200 instead of 206
+    std::list<std::string> segmentHeaders = commonHeaders;
+    if (const auto etag = TryGetHeader(probeHeaders, "ETag"); !etag.empty() && !etag.starts_with("W/"))
     {
-        auto lines = BuildCommonHeaders();
-        lines.push_front("Accept: application/json");
-        return lines;
+        segmentHeaders.push_back(std::format("If-Range: {}", etag));
+    }
+
+    auto& hasher = release.payloadHasher;
+    hasher = release.checksum.has_value()
+                 ? hashing::IncrementalHasher(release.checksum->checksumAlg)
+                 : hashing::IncrementalHasher{};
+
+    struct Segment
+    {
+        /** First byte offset */
+        uint64_t begin{0};
+        /** Last byte offset (inclusive) */
+        uint64_t end{0};
+        /** Bytes received so far, starting at begin */
+        uint64_t written{0};
+        std::optional<retry::RetryPolicy> retryPolicy{};
+        bool done{false};
+        std::chrono::steady_clock::time_point retryAt{};
+        web::EasyHandle request{};
+
+        [[nodiscard]] uint64_t Length() const { return end - begin + 1; }
     };
 
-    std::vector<std::string> candidateUrls;
-    candidateUrls.reserve(1 + fallbackUpdateRequestUrls.size());
-    candidateUrls.push_back(updateRequestUrl);
-    candidateUrls.insert(candidateUrls.end(), fallbackUpdateRequestUrls.begin(), fallbackUpdateRequestUrls.end());
+    std::vector<Segment> segments(segmentCount);
+    const uint64_t segmentSize = totalSize / segmentCount;
+    for (uint64_t i = 0; i < segmentCount; i++)
+    {
+        segments[ i ].begin = i * segmentSize;
+        segments[ i ].end = (i == segmentCount - 1) ? totalSize - 1 : (i + 1) * segmentSize - 1;
+        segments[ i ].retryPolicy.emplace(retry::RetryOptions{
+            .maxAttempts        = MAX_RETRY_COUNT,
+            .initialTimeoutSecs = MAX_TIMEOUT_SECS,
+            .maxTimeoutSecs     = MAX_TIMEOUT_SECS_TOTAL,
+        });
+    }
 
-    // Best-effort: try primary URL first, then fallbacks if the primary is not accessible
-    for (size_t i = 0; i < candidateUrls.size(); i++)
+    CURLM* multi = curl_multi_init();
+    if (multi == nullptr)
     {
-        const auto& requestUrl = candidateUrls[ i ];
+        return std::unexpected("Failed to initialize cURL multi handle");
+    }
 
-        if (!IsAllowedDownloadUrl(requestUrl))
+    auto multiGuard = sg::make_scope_guard([multi, &segments]
+    {
+        for (const auto& seg : segments)
         {
-            spdlog::error("Manifest URL {} uses a disallowed scheme and will not be fetched", requestUrl);
-            // Treat as unavailable and try next candidate; if none remain, the
-            // outer loop exits and the caller receives the "no server reachable" error.
-            continue;
+            if (seg.request)
+            {
+                curl_multi_remove_handle(multi, seg.request->getHandle());
+            }
         }
+        curl_multi_cleanup(multi);
+    });
 
-        spdlog::info("Requesting update info from {} ({}/{})", requestUrl, i + 1, candidateUrls.size());
+    // interrupts the poll below right away; destroyed before the guard cleans the multi handle up
+    const std::stop_callback wakeup(abortToken, [multi] { curl_multi_wakeup(multi); });
 
-        // ReSharper disable once CppTooWideScopeInitStatement
-        int retryCount = 5;
-        currentTimeoutSecs = MAX_TIMEOUT_SECS;
+    auto startSegment = [&](Segment& seg) -> bool
+    {
+        seg.request = web::TransferContext::Instance().Acquire();
+        auto& req = *seg.request;
+        CURL* handle = req.getHandle();
 
-        while (true)
+        auto writeCallback = [&seg, &file, &hasher, handle, throttle, &abortToken](char* ptr, size_t size,
+                                                                                 size_t nmemb) -> size_t
         {
-            auto getResult = web::HttpGet(requestUrl, {
-                .userAgent          = ua,
-                .headers            = buildManifestHeaders(),
-                .timeoutSecs        = currentTimeoutSecs,
-                .connectTimeoutSecs = 60,
-                .maxRedirects       = MAX_REDIRECTS,
-            });
+            const size_t bytes = size * nmemb;
+            if (ptr == nullptr || bytes == 0)
+            {
+                return bytes;
+            }
 
-            // Transport failure (connection error, TLS failure, stall timeout, …)
-            if (!getResult)
+            // Anything but 206 means the server ignored the range (or If-Range no longer matched)
+            long httpCode = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &httpCode);
+            if (httpCode != httplib::PartialContent_206)
             {
-                const std::string& transportError = getResult.error();
-                const bool isTimeout =
-                    transportError.find("timeout") != std::string::npos ||
-                    transportError.find("Timeout") != std::string::npos ||
-                    transportError.find("timed out") != std::string::npos ||
-                    transportError.find("Timed out") != std::string::npos;
+                return 0;
+            }
 
-                if (--retryCount > 0)
-                {
-                    spdlog::debug("Web request failed ({}), retrying {} more time(s)", transportError, retryCount);
+            const uint64_t offset = seg.begin + seg.written;
+            if (offset + bytes > seg.end + 1)
+            {
+                return 0;
+            }
 
-                    std::mt19937_64 eng{std::random_device{}()};
-                    std::uniform_int_distribution<> dist{1000, 5000};
-                    std::this_thread::sleep_for(std::chrono::milliseconds{dist(eng)});
+            // One bucket for all segments, so their sum stays within the limit
+            if (throttle && !throttle->Consume(bytes, abortToken))
+            {
+                return 0; // abort transfer
+            }
 
-                    if (isTimeout)
-                    {
-                        long nxt = std::lround(currentTimeoutSecs * 1.5);
-                        currentTimeoutSecs = std::min(nxt, 900L);
-                        spdlog::info("Request timeout reached, setting new timeout to {} seconds", currentTimeoutSecs);
-                    }
+            try
+            {
+                file.seekp(static_cast<std::streamoff>(offset));
+                file.write(ptr, static_cast<std::streamsize>(bytes));
+            }
+            catch (...)
+            {
+                return 0; // abort transfer
+            }
 
-                    continue;
-                }
+            // Only bytes directly continuing the digest can be fed right away, the rest is read back at the end
+            if (hasher.GetBytesHashed() == offset)
+            {
+                hasher.Add(ptr, bytes);
+            }
 
-                spdlog::error("GET request failed: {}", transportError);
+            seg.written += bytes;
+            return bytes;
+        };
 
-                if ((i + 1) < candidateUrls.size())
-                {
-                    spdlog::warn("Primary URL not accessible ({}), attempting fallback", transportError);
-                    break; // try next candidate URL
-                }
+        req.setOpt(curlpp::options::Url(effectiveUrl));
+        req.setOpt(curlpp::options::UserAgent(userAgent));
+        req.setOpt(curlpp::options::FollowLocation(true));
+        req.setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
+        req.setOpt(curlpp::options::HttpHeader(segmentHeaders));
+        req.setOpt(curlpp::options::ConnectTimeout(60));
+        req.setOpt(curlpp::options::LowSpeedLimit(1));
+        req.setOpt(curlpp::options::LowSpeedTime(seg.retryPolicy->GetTimeoutSecs()));
+        req.setOpt(curlpp::options::Range(std::format("{}-{}", seg.begin + seg.written, seg.end)));
+        req.setOpt(curlpp::options::WriteFunction(writeCallback));
+#if LIBCURL_VERSION_NUM >= 0x075700
+        // detach rather than join a lookup still running when the segment gets removed on abort
+        curl_easy_setopt(handle, CURLOPT_QUICK_EXIT, 1L);
+#endif
+
+        return curl_multi_add_handle(multi, handle) == CURLM_OK;
+    };
+
+    for (auto& seg : segments)
+    {
+        if (!startSegment(seg))
+        {
+            return std::unexpected("Failed to queue download segment");
+        }
+    }
+
+    spdlog::info("Downloading {} bytes in {} segments from {}", totalSize, segmentCount, effectiveUrl);
+    downloadProgress.SetPhase(web::DownloadPhase::Starting, 0, totalSize);
+
+    while (std::ranges::any_of(segments, [](const Segment& seg) { return !seg.done; }))
+    {
+        if (abortDownloadRequested.load(std::memory_order_relaxed))
+        {
+            spdlog::info("Download aborted");
+            return std::unexpected("Download cancelled.");
+        }
+
+        int running = 0;
+        if (const CURLMcode mc = curl_multi_perform(multi, &running); mc != CURLM_OK)
+        {
+            return std::unexpected(std::format("cURL multi error: {}", curl_multi_strerror(mc)));
+        }
 
-                return std::unexpected(transportError);
+        int queued = 0;
+        while (const CURLMsg* msg = curl_multi_info_read(multi, &queued))
+        {
+            if (msg->msg != CURLMSG_DONE)
+            {
+                continue;
             }
 
-            const auto& res  = *getResult;
-            const int    code = static_cast<int>(res.httpCode);
-            const std::string& body = res.body;
+            // msg is invalidated by removing the handle, so grab what we need first
+            CURL* handle = msg->easy_handle;
+            const CURLcode result = msg->data.result;
 
-            // HTTP-level failure (server reachable but returned an error status)
-            if (code != httplib::OK_200)
+            const auto seg = std::ranges::find_if(segments, [handle](const Segment& s)
             {
-                if (code != httplib::NotFound_404 && --retryCount > 0)
-                {
-                    spdlog::debug("Web request failed (HTTP {}), retrying {} more time(s)", code, retryCount);
+                return s.request && s.request->getHandle() == handle;
+            });
+            if (seg == segments.end())
+            {
+                continue;
+            }
 
-                    std::mt19937_64 eng{std::random_device{}()};
-                    std::uniform_int_distribution<> dist{1000, 5000};
-                    std::this_thread::sleep_for(std::chrono::milliseconds{dist(eng)});
-                    continue;
-                }
+            long httpCode = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &httpCode);
+            curl_multi_remove_handle(multi, handle);
+            web::TransferContext::Instance().RecordTransfer(*seg->request);
+            seg->request.reset();
+
+            if (result == CURLE_OK && seg->written == seg->Length())
+            {
+                seg->done = true;
+                continue;
+            }
+
+            // A non-ranged reply or a client error won't get any better by retrying this segment
+            if (httpCode != 0 && httpCode != httplib::PartialContent_206 && httpCode < 500)
+            {
+                return std::unexpected(std::format("Segment {}-{} failed with HTTP {}", seg->begin, seg->end, httpCode));
+            }
+
+            const auto delay = seg->retryPolicy->NextDelay({
+                .httpCode  = httpCode,
+                .isTimeout = result == CURLE_OPERATION_TIMEDOUT,
+            });
+            if (!delay.has_value())
+            {
+                return std::unexpected(std::format("Segment {}-{} failed: {}", seg->begin, seg->end,
+                                                   curl_easy_strerror(result)));
+            }
+
+            spdlog::warn("Segment {}-{} failed after {} of {} bytes ({}), retrying in {} ms, {} more time(s)",
+                         seg->begin, seg->end, seg->written, seg->Length(), curl_easy_strerror(result),
+                         delay->count(), seg->retryPolicy->GetAttemptsLeft());
 
-                const std::string statusText = httplib::status_message(code);
-                spdlog::error("GET request failed with HTTP {}: {}", code, statusText);
+            // Don't block the healthy segments while backing off
+            seg->retryAt = std::chrono::steady_clock::now() + delay.value();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& seg : segments)
+        {
+            if (!seg.done && !seg.request && now >= seg.retryAt && !startSegment(seg))
+            {
+                return std::unexpected("Failed to queue download segment");
+            }
+        }
 
-                if ((i + 1) < candidateUrls.size())
+        if (throttle)
+        {
+            for (const auto& seg : segments)
+            {
+                if (seg.request)
                 {
-                    spdlog::warn("Manifest URL returned HTTP {}, attempting fallback", code);
-                    break; // try next candidate URL
+                    throttle->SampleRtt(seg.request->getHandle());
                 }
+            }
+        }
+
+        uint64_t downloaded = 0;
+        for (const auto& seg : segments)
+        {
+            downloaded += seg.written;
+        }
+        downloadProgress.Update(downloaded, totalSize);
+
+        curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+    }
+
+    try
+    {
+        file.close();
+    }
+    catch (std::ios_base::failure& e)
+    {
+        return std::unexpected(std::format("Failed to finalize temporary file: {}", e.what()));
+    }
+
+    if (!MoveFileExA(partFile.string().c_str(), release.localTempFilePath.string().c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        spdlog::error("Failed to move {} to {}, error: {:#x}", partFile, release.localTempFilePath, GetLastError());
+        return std::unexpected(std::format("Failed to move downloaded file into place: {}", winapi::GetLastErrorStdStr()));
+    }
+
+    if (hasher.IsValid() && !hasher.CatchUpWithFile(release.localTempFilePath, totalSize))
+    {
+        spdlog::warn("Failed to complete payload digest, checksum will be computed after download");
+        hasher.Reset();
+    }
+
+    spdlog::info("Segmented download completed successfully ({} bytes)", totalSize);
+    return true;
+}
+
+std::expected<bool, std::string> models::InstanceConfig::DownloadReleasePatch(
+    const std::string& userAgent,
+    web::BandwidthThrottle* throttle)
+{
+    auto& release = GetSelectedRelease();
+
+    std::filesystem::path basePath{};
+    const auto patch = FindApplicablePatch(basePath);
+    if (!patch.has_value())
+    {
+        return false;
+    }
+
+    // the manifest check rejects these already; the patch is fed into the decoder against the
+    // installed file, so it must never arrive over anything but HTTPS
+    if (!IsAllowedDownloadUrl(patch->downloadUrl))
+    {
+        return std::unexpected(std::format("Patch URL {} uses a disallowed scheme", patch->downloadUrl));
+    }
+
+    const std::stop_token abortToken = downloadStopSource.get_token();
+    std::filesystem::path patchFile = release.localTempFilePath;
+    patchFile += ".patch";
+
+    // the patch is only needed until the release has been reconstructed from it
+    const auto patchFileGuard = sg::make_scope_guard([&patchFile]() noexcept
+    {
+        std::error_code ec;
+        std::filesystem::remove(patchFile, ec);
+    });
+
+    //
+    // Download the patch
+    //
+    try
+    {
+        std::ofstream file;
+        file.exceptions(file.exceptions() | std::ios::failbit);
+        file.open(patchFile, std::ios::binary | std::ios::trunc);
+
+        auto writeCallback = [&file, throttle, &abortToken](char* ptr, size_t size, size_t nmemb) -> size_t
+        {
+            const size_t bytes = size * nmemb;
+            if (ptr == nullptr || bytes == 0)
+            {
+                return bytes;
+            }
 
-                return std::unexpected(std::format("HTTP {} {}", code, statusText));
+            if (throttle && !throttle->Consume(bytes, abortToken))
+            {
+                return 0; // abort transfer
             }
 
             try
             {
-                //
-                // Layer 3: Manifest signature verification (Ed25519 / minisign)
-                // Must happen BEFORE json::parse so a tampered body is never trusted.
-                //
-#if defined(NV_MANIFEST_PUBLIC_KEY)
-                {
-                    // Derive the .minisig sidecar URL by appending ".minisig" to the manifest URL
-                    const std::string minisigUrl = requestUrl + ".minisig";
-                    spdlog::debug("Fetching manifest signature from {}", minisigUrl);
-
-                    auto sigGetResult = web::HttpGet(minisigUrl, {
-                        .userAgent          = ua,
-                        .headers            = BuildCommonHeaders(),
-                        .timeoutSecs        = MAX_TIMEOUT_SECS,
-                        .connectTimeoutSecs = 60,
-                        .maxRedirects       = MAX_REDIRECTS,
-                    });
-
-                    const bool sigOk = sigGetResult.has_value()
-                        && sigGetResult->httpCode == httplib::OK_200
-                        && !sigGetResult->body.empty();
-
-                    if (!sigOk)
-                    {
-                        const std::string reason = sigGetResult
-                            ? std::format("HTTP {}", sigGetResult->httpCode)
-                            : sigGetResult.error();
-                        spdlog::error("Failed to fetch manifest signature from {} ({})", minisigUrl, reason);
-
-                        if ((i + 1) < candidateUrls.size())
-                        {
-                            spdlog::warn("Manifest signature unavailable from {}, attempting fallback", requestUrl);
-                            break; // try next candidate URL
-                        }
-
-                        return std::unexpected(
-                            "Manifest signature (.minisig) could not be fetched. "
-                            "Update blocked because NV_MANIFEST_PUBLIC_KEY is configured.");
-                    }
+                file.write(ptr, static_cast<std::streamsize>(bytes));
+                return bytes;
+            }
+            catch (...)
+            {
+                return 0; // abort transfer
+            }
+        };
 
-                    const auto sigResult = VerifyManifestSignature(body, sigGetResult->body);
-                    if (!sigResult)
-                    {
-                        spdlog::error("Manifest signature verification failed: {}", sigResult.error());
-                        return std::unexpected(std::format("Manifest signature invalid: {}", sigResult.error()));
-                    }
+        auto& transferContext = web::TransferContext::Instance();
+        const web::EasyHandle req = transferContext.Acquire();
+        const auto timingGuard = sg::make_scope_guard([&] { transferContext.RecordTransfer(*req); });
 
-                    spdlog::info("Manifest signature verified successfully");
-                }
-#endif
+        const uint64_t patchSize = patch->downloadSize.has_value()
+                                       ? static_cast<uint64_t>(patch->downloadSize.value())
+                                       : 0;
+        downloadProgress.SetPhase(web::DownloadPhase::Starting, 0, patchSize);
 
-                const json reply = json::parse(body);
-                remote = reply.get<UpdateResponse>();
+        web::TransferInfoCallback progressCallback = [this, throttle, &req, patchSize](
+            curl_off_t dltotal, curl_off_t dlnow) -> int
+        {
+            if (throttle)
+            {
+                throttle->SampleRtt(req->getHandle());
+            }
 
-                // remove releases marked as disabled
-                std::erase_if(remote.releases, [](const UpdateRelease& x) { return x.disabled.value_or(false); });
+            downloadProgress.Update(static_cast<uint64_t>(dlnow),
+                                    dltotal > 0 ? static_cast<uint64_t>(dltotal) : patchSize);
 
-                // top release is always latest by version, even if the response wasn't the right order
-                std::ranges::sort(remote.releases, [](const UpdateRelease& lhs, const UpdateRelease& rhs)
-                {
-                    return util::CompareVersions(lhs.GetSemVersion(), rhs.GetSemVersion()) > 0;
-                });
+            return 0;
+        };
+
+        const std::list<std::string> headerLines = BuildCommonHeaders();
+
+        req->setOpt(curlpp::options::Url(patch->downloadUrl));
+        req->setOpt(curlpp::options::UserAgent(userAgent));
+        req->setOpt(curlpp::options::FollowLocation(true));
+        req->setOpt(curlpp::options::MaxRedirs(MAX_REDIRECTS));
+        req->setOpt(curlpp::options::HttpHeader(headerLines));
+        req->setOpt(curlpp::options::ConnectTimeout(60));
+        req->setOpt(curlpp::options::LowSpeedLimit(1));
+        req->setOpt(curlpp::options::LowSpeedTime(MAX_TIMEOUT_SECS));
+        req->setOpt(curlpp::options::WriteFunction(writeCallback));
+        web::SetTransferInfoFunction(*req, progressCallback);
+
+        spdlog::info("Downloading patch from {} against {}", patch->downloadUrl, basePath);
+        web::PerformCancellable(*req, abortToken);
+
+        if (const auto code = curlpp::infos::ResponseCode::get(*req); code != httplib::OK_200)
+        {
+            return std::unexpected(std::format("Patch download failed with HTTP {}", code));
+        }
+
+        file.close();
+    }
+    catch (const curlpp::RuntimeError& e)
+    {
+        return std::unexpected(std::format("Patch download failed: {}", e.what()));
+    }
+    catch (const curlpp::LogicError& e)
+    {
+        return std::unexpected(std::format("Patch download failed: {}", e.what()));
+    }
+    catch (const std::ios_base::failure& e)
+    {
+        return std::unexpected(std::format("Failed to write patch file: {}", e.what()));
+    }
+
+    if (patch->downloadSize.has_value())
+    {
+        std::error_code ec;
+        if (const auto size = std::filesystem::file_size(patchFile, ec); ec || size != patch->downloadSize.value())
+        {
+            return std::unexpected("Downloaded patch has an unexpected size");
+        }
+    }
+
+    //
+    // Reconstruct the release and verify it against the release checksum
+    //
+    const auto& hashCfg = release.checksum.value();
+    auto& hasher = release.payloadHasher;
+    hasher = hashing::IncrementalHasher(hashCfg.checksumAlg);
+
+    auto discardOutput = [&release, &hasher]
+    {
+        hasher.Reset();
+        std::error_code ec;
+        std::filesystem::remove(release.localTempFilePath, ec);
+    };
+
+    downloadProgress.SetPhase(web::DownloadPhase::Patching, 0, release.downloadSize.has_value()
+                                                                  ? static_cast<uint64_t>(release.downloadSize.value())
+                                                                  : 0);
+
+    const auto expectedSize = release.downloadSize.has_value()
+                                  ? std::optional(static_cast<uint64_t>(release.downloadSize.value()))
+                                  : std::nullopt;
+
+    const auto applied = delta::ApplyZstdPatch(basePath, patchFile, release.localTempFilePath, hasher,
+                                               expectedSize, abortToken);
+    if (!applied.has_value())
+    {
+        discardOutput();
+        return std::unexpected(applied.error());
+    }
+
+    if (const auto computed = hasher.GetHash(); !util::icompare(computed, hashCfg.checksum))
+    {
+        discardOutput();
+        return std::unexpected(std::format("Patched file checksum mismatch: expected {}, got {}",
+                                           hashCfg.checksum, computed));
+    }
+
+    spdlog::info("Reconstructed release from patch ({} bytes)", applied.value());
+    return true;
+}
+
+// ============================================================================
+// RequestUpdateInfo
+// ============================================================================
+
+std::expected<models::InstanceConfig::ManifestCandidate, models::InstanceConfig::ManifestFetchError>
+models::InstanceConfig::FetchManifest(
+    const std::string& requestUrl,
+    const std::string& userAgent,
+    const std::stop_token& stopToken) const
+{
+    // A previously verified manifest is revalidated instead of downloaded again
+    std::optional<CachedManifest> cached = LoadCachedManifest(requestUrl);
 
-                //
-                // Layer 3: Rollback / downgrade protection
-                //
 #if defined(NV_MANIFEST_PUBLIC_KEY)
-                if (reply.contains("manifestVersion") && reply["manifestVersion"].is_number_unsigned())
-                {
-                    const uint64_t manifestVersion = reply["manifestVersion"].get<uint64_t>();
-                    if (!CheckAndUpdateManifestVersion(manifestVersion))
-                    {
-                        spdlog::error("Manifest version rollback detected (version {}), blocking update", manifestVersion);
-                        return std::unexpected(
-                            "The update manifest appears to be a downgrade attempt and has been rejected.");
-                    }
-                }
+    // the cache lives in a user-writable location, so it's only as good as its signature
+    if (cached.has_value() && !VerifyManifestSignature(cached->body, cached->signature))
+    {
+        spdlog::warn("Cached manifest of {} failed signature verification, discarding", requestUrl);
+        PurgeCachedManifest(requestUrl);
+        cached.reset();
+    }
+#endif
+
+    // Assemble per-request headers once; Accept header prepended here.
+    auto manifestHeaders = BuildCommonHeaders();
+#if defined(NV_MANIFEST_ACCEPT_BINARY)
+    manifestHeaders.push_front(std::format("Accept: {}", manifest::ACCEPT_HEADER_VALUE));
+#else
+    manifestHeaders.push_front("Accept: application/json");
 #endif
+    if (cached.has_value())
+    {
+        if (!cached->etag.empty())
+            manifestHeaders.push_back(std::format("If-None-Match: {}", cached->etag));
+        if (!cached->lastModified.empty())
+            manifestHeaders.push_back(std::format("If-Modified-Since: {}", cached->lastModified));
+    }
 
-                //
-                // Layer 5: Enforce HTTPS on all download URLs from the manifest
-                //
-                for (const auto& release : remote.releases)
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+    // Derive the .minisig sidecar URL by appending ".minisig" to the manifest URL and fetch it
+    // alongside the body so it doesn't add another round trip; both are joined before verification
+    const std::string minisigUrl = requestUrl + ".minisig";
+    std::stop_source minisigStop;
+    std::stop_callback forwardStop(stopToken, [&minisigStop] { minisigStop.request_stop(); });
+
+    spdlog::debug("Fetching manifest signature from {}", minisigUrl);
+    auto minisigTask = std::async(std::launch::async,
+                                  [minisigUrl, userAgent, headers = BuildCommonHeaders(), token = minisigStop.get_token()]
+                                  {
+                                      return web::HttpGet(minisigUrl, {
+                                          .userAgent          = userAgent,
+                                          .headers            = headers,
+                                          .timeoutSecs        = MAX_TIMEOUT_SECS,
+                                          .connectTimeoutSecs = 60,
+                                          .maxRedirects       = MAX_REDIRECTS,
+                                          .stopToken          = token,
+                                      });
+                                  });
+
+    // don't leave the signature request running when the body fails or isn't modified
+    const auto minisigGuard = sg::make_scope_guard([&minisigStop, &minisigTask]
+    {
+        minisigStop.request_stop();
+        if (minisigTask.valid())
+        {
+            minisigTask.wait();
+        }
+    });
+#endif
+
+    retry::RetryPolicy retryPolicy({
+        .maxAttempts        = 5,
+        .budget             = std::chrono::seconds{MAX_MANIFEST_RETRY_SECS_TOTAL},
+        .initialTimeoutSecs = MAX_TIMEOUT_SECS,
+    });
+    CachedManifest fetched{};
+    bool isFromCache = false;
+
+    while (true)
+    {
+        auto getResult = web::HttpGet(requestUrl, {
+            .userAgent          = userAgent,
+            .headers            = manifestHeaders,
+            .timeoutSecs        = retryPolicy.GetTimeoutSecs(),
+            .connectTimeoutSecs = 60,
+            .maxRedirects       = MAX_REDIRECTS,
+            .stopToken          = stopToken,
+        });
+
+        if (stopToken.stop_requested())
+        {
+            return std::unexpected(ManifestFetchError{"Request cancelled"});
+        }
+
+        // Transport failure (connection error, TLS failure, stall timeout, …)
+        if (!getResult)
+        {
+            const std::string& transportError = getResult.error();
+            const bool isTimeout =
+                transportError.find("timeout") != std::string::npos ||
+                transportError.find("Timeout") != std::string::npos ||
+                transportError.find("timed out") != std::string::npos ||
+                transportError.find("Timed out") != std::string::npos;
+
+            if (const auto delay = retryPolicy.NextDelay({.isTimeout = isTimeout}); delay.has_value())
+            {
+                spdlog::debug("Web request to {} failed ({}), retrying in {} ms, {} more time(s)", requestUrl,
+                              transportError, delay->count(), retryPolicy.GetAttemptsLeft());
+
+                if (isTimeout)
                 {
-                    if (!IsAllowedDownloadUrl(release.downloadUrl))
-                    {
-                        spdlog::error("Release '{}' has a disallowed downloadUrl scheme: {}",
-                                      release.name, release.downloadUrl);
-                        return std::unexpected(
-                            std::format("Release '{}' uses a non-HTTPS downloadUrl which is not allowed for security reasons.",
-                                        release.name));
-                    }
+                    spdlog::info("Request timeout reached, setting new timeout to {} seconds",
+                                 retryPolicy.GetTimeoutSecs());
                 }
 
-                if (remote.instance.has_value())
+                if (!retryPolicy.Sleep(delay.value(), stopToken))
                 {
-                    const auto& inst = remote.instance.value();
-                    if (inst.latestUrl.has_value() && !IsAllowedDownloadUrl(inst.latestUrl.value()))
-                    {
-                        spdlog::error("instance.latestUrl has a disallowed scheme: {}", inst.latestUrl.value());
-                        return std::unexpected(
-                            "The self-updater URL (instance.latestUrl) uses a non-HTTPS scheme which is not allowed.");
-                    }
+                    return std::unexpected(ManifestFetchError{"Request cancelled"});
                 }
 
-                // bail out now if we are not supposed to obey the server settings
-                if (authority == Authority::Local || !reply.contains("shared"))
+                continue;
+            }
+
+            spdlog::error("GET request to {} failed: {}", requestUrl, transportError);
+            return std::unexpected(ManifestFetchError{transportError});
+        }
+
+        const int code = static_cast<int>(getResult->httpCode);
+
+        if (code == httplib::NotModified_304 && cached.has_value())
+        {
+            spdlog::info("Manifest of {} not modified, using cached copy", requestUrl);
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+            minisigStop.request_stop();
+#endif
+            fetched = std::move(cached.value());
+            isFromCache = true;
+            break;
+        }
+
+        // HTTP-level failure (server reachable but returned an error status)
+        if (code != httplib::OK_200)
+        {
+            const auto delay = code != httplib::NotFound_404
+                                   ? retryPolicy.NextDelay({
+                                       .httpCode   = code,
+                                       .retryAfter = TryGetHeader(getResult->headers, "Retry-After"),
+                                   })
+                                   : std::nullopt;
+
+            if (delay.has_value())
+            {
+                spdlog::debug("Web request to {} failed (HTTP {}), retrying in {} ms, {} more time(s)", requestUrl,
+                              code, delay->count(), retryPolicy.GetAttemptsLeft());
+
+                if (!retryPolicy.Sleep(delay.value(), stopToken))
                 {
-                    spdlog::info("{} authority specified (or empty response), ignoring server parameters",
-                                 magic_enum::enum_name(authority));
-                    return {};
+                    return std::unexpected(ManifestFetchError{"Request cancelled"});
                 }
 
-                // merge values that can be supplied both locally and remotely
-                if (remote.shared.has_value())
-                {
-                    const auto& shared = remote.shared.value();
-                    spdlog::info("Processing remote shared configuration parameters");
+                continue;
+            }
 
-                    if (shared.windowTitle.has_value()) merged.windowTitle = shared.windowTitle.value();
+            const std::string statusText = httplib::status_message(code);
+            spdlog::error("GET request to {} failed with HTTP {}: {}", requestUrl, code, statusText);
+            return std::unexpected(ManifestFetchError{std::format("HTTP {} {}", code, statusText)});
+        }
 
-                    if (shared.productName.has_value()) merged.productName = shared.productName.value();
+        fetched.body = std::move(getResult->body);
+        fetched.etag = TryGetHeader(getResult->headers, "ETag");
+        fetched.lastModified = TryGetHeader(getResult->headers, "Last-Modified");
+        fetched.contentType = TryGetHeader(getResult->headers, "Content-Type");
+        break;
+    }
 
-                    // special case where we don't want the server to override what the CLI specified
-                    if (!this->forceLocalVersion)
-                    {
-                        if (shared.detectionMethod.has_value()) merged.detectionMethod = shared.detectionMethod.value();
+    const std::string& body = fetched.body;
 
-                        if (shared.detection.has_value()) merged.detection = shared.detection.value();
-                    }
+    //
+    // Layer 3: Manifest signature verification (Ed25519 / minisign)
+    // Must happen BEFORE json::parse so a tampered body is never trusted.
+    //
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+    // a cached body was already verified against its cached signature above
+    if (!isFromCache)
+    {
+        // join the request started in parallel with the body
+        auto sigGetResult = minisigTask.get();
 
-                    if (shared.installationErrorUrl.has_value())
-                        merged.installationErrorUrl = shared.installationErrorUrl.value();
+        if (stopToken.stop_requested())
+        {
+            return std::unexpected(ManifestFetchError{"Request cancelled"});
+        }
 
-                    if (shared.downloadLocation.has_value()) merged.downloadLocation = shared.downloadLocation.value();
+        const bool sigOk = sigGetResult.has_value()
+            && sigGetResult->httpCode == httplib::OK_200
+            && !sigGetResult->body.empty();
 
-                    if (shared.runAsTemporaryCopy.has_value()) merged.runAsTemporaryCopy = shared.runAsTemporaryCopy.value();
+        if (!sigOk)
+        {
+            const std::string reason = sigGetResult
+                ? std::format("HTTP {}", sigGetResult->httpCode)
+                : sigGetResult.error();
+            spdlog::error("Failed to fetch manifest signature from {} ({})", minisigUrl, reason);
+
+            return std::unexpected(ManifestFetchError{
+                "Manifest signature (.minisig) could not be fetched. "
+                "Update blocked because NV_MANIFEST_PUBLIC_KEY is configured."
+            });
+        }
 
-                    // Signature verification settings from server (do not override strict mode set by CLI)
-                    if (shared.signatureVerificationMode.has_value() && !strictVerification)
-                        merged.signatureVerificationMode = shared.signatureVerificationMode.value();
+        const auto sigResult = VerifyManifestSignature(body, sigGetResult->body);
+        if (!sigResult)
+        {
+            spdlog::error("Manifest signature verification of {} failed: {}", requestUrl, sigResult.error());
+            return std::unexpected(ManifestFetchError{
+                std::format("Manifest signature invalid: {}", sigResult.error()),
+                true
+            });
+        }
 
-                    if (shared.signaturePolicy.has_value() && !strictVerification)
-                        merged.signaturePolicy = shared.signaturePolicy.value();
+        spdlog::info("Manifest signature of {} verified successfully", requestUrl);
+        fetched.signature = std::move(sigGetResult->body);
+    }
+#endif
 
-                    if (shared.signatureStrategy.has_value() && !strictVerification)
-                        merged.signatureStrategy = shared.signatureStrategy.value();
+    if (isFromCache && fetched.parsed.has_value())
+    {
+        spdlog::debug("Using cached parse result of {}", requestUrl);
+        return std::move(fetched.parsed.value());
+    }
 
-                    if (shared.signatureConfig.has_value() && !strictVerification)
-                        merged.signatureConfig = shared.signatureConfig.value();
+    try
+    {
+        ManifestCandidate candidate{};
+        // streams the releases (dropping disabled ones) without building a DOM of them;
+        // the reply keeps every other top-level member for the checks done by the caller
+        candidate.response = manifest::ParseUpdateResponse(
+            body, manifest::FormatFromContentType(fetched.contentType), candidate.reply);
 
-                    if (shared.hideRemindButton.has_value()) merged.hideRemindButton = shared.hideRemindButton.value();
+        auto& releases = candidate.response.releases;
 
-                    if (shared.iconBase64.has_value()) merged.iconBase64 = shared.iconBase64.value();
-                }
+        // top release is always latest by version, even if the response wasn't the right order
+        std::ranges::sort(releases, [](const UpdateRelease& lhs, const UpdateRelease& rhs)
+        {
+            return util::CompareVersions(lhs.GetSemVersion(), rhs.GetSemVersion()) > 0;
+        });
 
-                return {};
-            }
-            catch (const json::exception& e)
-            {
-                spdlog::error("Failed to parse JSON, error {}", e.what());
+        // also when reparsing a cached body, e.g. after the updater was upgraded
+        fetched.parsed = candidate;
+        StoreCachedManifest(requestUrl, fetched);
+
+        return candidate;
+    }
+    catch (const json::exception& e)
+    {
+        // Some censorship setups return HTTP 200 with non-JSON body (block pages),
+        // so this is not fatal; another candidate URL may still deliver.
+        spdlog::error("Failed to parse JSON from {}, error {}", requestUrl, e.what());
+        if (isFromCache) PurgeCachedManifest(requestUrl);
+        return std::unexpected(ManifestFetchError{std::format("JSON parsing error: {}", e.what())});
+    }
+    catch (const std::exception& e)
+    {
+        spdlog::error("Unexpected error during parsing of response from {}, error {}", requestUrl, e.what());
+        if (isFromCache) PurgeCachedManifest(requestUrl);
+        return std::unexpected(ManifestFetchError{std::format("Unknown error error: {}", e.what())});
+    }
+}
+
+[[nodiscard]] std::expected<void, std::string> models::InstanceConfig::RequestUpdateInfo()
+{
+    const auto ua = std::format("{}/{}", appFilename, appVersion.str());
+    spdlog::debug("Setting User Agent to {}", ua);
+
+    std::vector<std::string> candidateUrls;
+    candidateUrls.reserve(1 + fallbackUpdateRequestUrls.size());
+    candidateUrls.push_back(updateRequestUrl);
+    candidateUrls.insert(candidateUrls.end(), fallbackUpdateRequestUrls.begin(), fallbackUpdateRequestUrls.end());
+
+    //
+    // Staggered race across the candidate URLs: the primary starts right away, each fallback
+    // joins after NV_MANIFEST_FALLBACK_DELAY_MS (or immediately once every attempt in flight
+    // has failed). The first verified and parsed manifest wins, the others get cancelled.
+    //
+    std::mutex raceMutex;
+    std::condition_variable raceCondition;
+    std::vector<std::optional<std::expected<ManifestCandidate, ManifestFetchError>>> results(candidateUrls.size());
+    std::optional<size_t> winner{};
+    std::stop_source raceStop;
+    std::vector<std::jthread> workers;
+    // cancel stragglers before the workers get joined on scope exit
+    auto cancelGuard = sg::make_scope_guard([&raceStop] { raceStop.request_stop(); });
+
+    size_t launched = 0;
+
+    // must be called with raceMutex held
+    auto launchNext = [&]
+    {
+        const size_t i = launched++;
+        const auto& requestUrl = candidateUrls[ i ];
+
+        if (!IsAllowedDownloadUrl(requestUrl))
+        {
+            spdlog::error("Manifest URL {} uses a disallowed scheme and will not be fetched", requestUrl);
+            // Treat as unavailable; the next candidate gets started right away.
+            results[ i ] = std::unexpected(ManifestFetchError{"No update server URL could be reached"});
+            return;
+        }
+
+        spdlog::info("Requesting update info from {} ({}/{})", requestUrl, i + 1, candidateUrls.size());
 
-                // Some censorship setups return HTTP 200 with non-JSON body (block pages).
-                // If configured, try fallbacks before failing hard.
-                if ((i + 1) < candidateUrls.size())
+        workers.emplace_back([this, i, &requestUrl, &ua, &raceMutex, &raceCondition, &results, &winner,
+                                 stopToken = raceStop.get_token()]
+            {
+                auto result = FetchManifest(requestUrl, ua, stopToken);
                 {
-                    spdlog::warn("Non-JSON response received, attempting fallback");
-                    break; // try next candidate URL
+                    std::lock_guard lock(raceMutex);
+                    if (result.has_value() && !winner.has_value())
+                    {
+                        winner = i;
+                    }
+                    results[ i ] = std::move(result);
                 }
+                raceCondition.notify_all();
+            });
+    };
+
+    std::unique_lock lock(raceMutex);
+    auto nextLaunchAt = std::chrono::steady_clock::now();
+
+    while (!winner.has_value())
+    {
+        bool allLaunchedFailed = true;
+        for (size_t i = 0; i < launched; i++)
+        {
+            if (!results[ i ].has_value())
+            {
+                allLaunchedFailed = false;
+                continue;
+            }
+
+            if (const auto& result = results[ i ].value(); !result.has_value() && result.error().isFatal)
+            {
+                return std::unexpected(result.error().message);
+            }
+        }
 
-                return std::unexpected(std::format("JSON parsing error: {}", e.what()));
+        if (launched == candidateUrls.size())
+        {
+            if (allLaunchedFailed)
+            {
+                return std::unexpected(results.back()->error().message);
             }
-            catch (const std::exception& e)
+
+            raceCondition.wait(lock);
+            continue;
+        }
+
+        if (const auto now = std::chrono::steady_clock::now(); allLaunchedFailed || now >= nextLaunchAt)
+        {
+            if (!allLaunchedFailed)
             {
-                spdlog::error("Unexpected error during response parsing, error {}", e.what());
+                spdlog::warn("No usable response from {} yet, racing fallback", candidateUrls[ launched - 1 ]);
+            }
 
-                if ((i + 1) < candidateUrls.size())
-                {
-                    spdlog::warn("Response parsing failed, attempting fallback");
-                    break; // try next candidate URL
-                }
+            launchNext();
+            nextLaunchAt = now + std::chrono::milliseconds(NV_MANIFEST_FALLBACK_DELAY_MS);
+            continue;
+        }
+
+        raceCondition.wait_until(lock, nextLaunchAt);
+    }
+
+    raceStop.request_stop();
+
+    ManifestCandidate candidate = std::move(results[ winner.value() ]->value());
+    lock.unlock();
+
+    if (winner.value() > 0)
+    {
+        spdlog::warn("Using manifest from fallback URL {}", candidateUrls[ winner.value() ]);
+    }
+
+    const json& reply = candidate.reply;
+    remote = std::move(candidate.response);
+
+    //
+    // Layer 3: Rollback / downgrade protection
+    //
+#if defined(NV_MANIFEST_PUBLIC_KEY)
+    if (reply.contains("manifestVersion") && reply["manifestVersion"].is_number_unsigned())
+    {
+        const uint64_t manifestVersion = reply["manifestVersion"].get<uint64_t>();
+        if (!CheckAndUpdateManifestVersion(manifestVersion))
+        {
+            spdlog::error("Manifest version rollback detected (version {}), blocking update", manifestVersion);
+            return std::unexpected(
+                "The update manifest appears to be a downgrade attempt and has been rejected.");
+        }
+    }
+#endif
+
+    //
+    // Layer 5: Enforce HTTPS on all download URLs from the manifest
+    //
+    for (const auto& release : remote.releases)
+    {
+        if (!IsAllowedDownloadUrl(release.downloadUrl))
+        {
+            spdlog::error("Release '{}' has a disallowed downloadUrl scheme: {}",
+                          release.name, release.downloadUrl);
+            return std::unexpected(
+                std::format("Release '{}' uses a non-HTTPS downloadUrl which is not allowed for security reasons.",
+                            release.name));
+        }
+
+        if (!release.patches.has_value())
+        {
+            continue;
+        }
 
-                return std::unexpected(std::format("Unknown error error: {}", e.what()));
+        // patches are downloaded in place of the release, the same rule applies to them
+        for (const auto& patch : release.patches.value())
+        {
+            if (!IsAllowedDownloadUrl(patch.downloadUrl))
+            {
+                spdlog::error("Release '{}' has a patch with a disallowed downloadUrl scheme: {}",
+                              release.name, patch.downloadUrl);
+                return std::unexpected(
+                    std::format("Release '{}' uses a non-HTTPS patch downloadUrl which is not allowed for security reasons.",
+                                release.name));
             }
         }
     }
 
-    return std::unexpected("No update server URL could be reached");
+    if (remote.instance.has_value())
+    {
+        const auto& inst = remote.instance.value();
+        if (inst.latestUrl.has_value() && !IsAllowedDownloadUrl(inst.latestUrl.value()))
+        {
+            spdlog::error("instance.latestUrl has a disallowed scheme: {}", inst.latestUrl.value());
+            return std::unexpected(
+                "The self-updater URL (instance.latestUrl) uses a non-HTTPS scheme which is not allowed.");
+        }
+    }
+
+    // bail out now if we are not supposed to obey the server settings
+    if (authority == Authority::Local || !reply.contains("shared"))
+    {
+        spdlog::info("{} authority specified (or empty response), ignoring server parameters",
+                     magic_enum::enum_name(authority));
+        return {};
+    }
+
+    // merge values that can be supplied both locally and remotely
+    if (remote.shared.has_value())
+    {
+        const auto& shared = remote.shared.value();
+        spdlog::info("Processing remote shared configuration parameters");
+
+        if (shared.windowTitle.has_value()) merged.windowTitle = shared.windowTitle.value();
+
+        if (shared.productName.has_value()) merged.productName = shared.productName.value();
+
+        // special case where we don't want the server to override what the CLI specified
+        if (!this->forceLocalVersion)
+        {
+            if (shared.detectionMethod.has_value()) merged.detectionMethod = shared.detectionMethod.value();
+
+            if (shared.detection.has_value()) merged.detection = shared.detection.value();
+        }
+
+        if (shared.installationErrorUrl.has_value())
+            merged.installationErrorUrl = shared.installationErrorUrl.value();
+
+        if (shared.downloadLocation.has_value()) merged.downloadLocation = shared.downloadLocation.value();
+
+        if (shared.runAsTemporaryCopy.has_value()) merged.runAsTemporaryCopy = shared.runAsTemporaryCopy.value();
+
+        // Signature verification settings from server (do not override strict mode set by CLI)
+        if (shared.signatureVerificationMode.has_value() && !strictVerification)
+            merged.signatureVerificationMode = shared.signatureVerificationMode.value();
+
+        if (shared.signaturePolicy.has_value() && !strictVerification)
+            merged.signaturePolicy = shared.signaturePolicy.value();
+
+        if (shared.signatureStrategy.has_value() && !strictVerification)
+            merged.signatureStrategy = shared.signatureStrategy.value();
+
+        if (shared.signatureConfig.has_value() && !strictVerification)
+            merged.signatureConfig = shared.signatureConfig.value();
+
+        if (shared.hideRemindButton.has_value()) merged.hideRemindButton = shared.hideRemindButton.value();
+
+        if (shared.iconBase64.has_value()) merged.iconBase64 = shared.iconBase64.value();
+
+        if (shared.backgroundDownloadRateLimit.has_value())
+            merged.backgroundDownloadRateLimit = shared.backgroundDownloadRateLimit.value();
+
+        if (shared.backgroundDownloadAdaptive.has_value())
+            merged.backgroundDownloadAdaptive = shared.backgroundDownloadAdaptive.value();
+
+        if (shared.prefetchRelease.has_value()) merged.prefetchRelease = shared.prefetchRelease.value();
+    }
+
+    return {};
 }
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Common.h"
 #include "Util.h"
+#include "Http.h"
 #include "InstanceConfig.hpp"
 #include "NAuthenticode.h"
 
@@ -59,6 +60,12 @@ models::InstanceConfig::InstanceConfig(HINSTANCE hInstance, argh::parser& cmdl,
     }
 
     set_default_logger(logger);
+
+    // per-transfer timings as JSON Lines next to the log file, for diagnosing slow updates
+    if (cmdl[ {NV_CLI_TIMING_REPORT} ] && cmdl({NV_CLI_PARAM_LOG_TO_FILE}))
+    {
+        web::TransferContext::Instance().EnableTimingReport(cmdl({NV_CLI_PARAM_LOG_TO_FILE}).str() + ".timing.jsonl");
+    }
 #endif
 
 #pragma endregion
@@ -66,6 +73,7 @@ models::InstanceConfig::InstanceConfig(HINSTANCE hInstance, argh::parser& cmdl,
     this->overrideSuccessCode = static_cast<bool>(cmdl({NV_CLI_PARAM_OVERRIDE_OK}) >> this->overriddenSuccessCode);
 
     spdlog::debug("Initializing updater instance (PID: {})", GetCurrentProcessId());
+    spdlog::debug("SHA backend = {}", hashing::GetShaBackendName());
 
     //
     // Defaults and embedded stuff
@@ -75,6 +83,13 @@ models::InstanceConfig::InstanceConfig(HINSTANCE hInstance, argh::parser& cmdl,
                   || cmdl[ {NV_CLI_SILENT_UPDATE} ];
     this->ignorePostponePeriod = cmdl[ {NV_CLI_IGNORE_POSTPONE} ];
 
+    if (uint64_t rateLimit = 0; cmdl({NV_CLI_PARAM_BACKGROUND_RATE_LIMIT}) >> rateLimit)
+    {
+        this->cliBackgroundRateLimit = rateLimit;
+    }
+    this->cliBackgroundRateAdaptive = cmdl[ {NV_CLI_BACKGROUND_RATE_ADAPTIVE} ];
+    this->cliPrefetch = cmdl[ {NV_CLI_PREFETCH} ];
+
 #if !defined(NV_FLAGS_NO_SERVER_URL_RESOURCE)
     // grab our backend URL from string resource
     std::string idsServerUrl(NV_API_URL_MAX_CHARS, '\0');
@@ -192,53 +207,13 @@ models::InstanceConfig::InstanceConfig(HINSTANCE hInstance, argh::parser& cmdl,
         parentAppPath = std::get<std::string>(parentPath.value());
         spdlog::debug("parentAppPath = {}", parentAppPath.value());
 
-        std::ifstream parentAppFileStream(parentAppPath.value(), std::ios::binary);
-        std::ifstream currentAppFileStream(appPath, std::ios::binary);
+        const auto parentHash = hashing::HashFile<hashing::AcceleratedSHA256>(parentAppPath.value());
+        const auto currentHash = hashing::HashFile<hashing::AcceleratedSHA256>(appPath);
 
-        if (parentAppFileStream.is_open() && currentAppFileStream.is_open())
+        if (parentHash.has_value() && currentHash.has_value())
         {
-            SHA256 parentSha256Alg, currentSha256Alg;
-            // improve hashing speed
-            constexpr std::size_t chunkSize = 4 * 1024; // 4 KB
-
-            std::vector<char> parentAppFileBuffer(chunkSize);
-            while (!parentAppFileStream.eof())
-            {
-                parentAppFileStream.read(parentAppFileBuffer.data(), parentAppFileBuffer.size());
-                std::streamsize bytesRead = parentAppFileStream.gcount();
-
-                parentSha256Alg.add(parentAppFileBuffer.data(), bytesRead);
-
-                if (bytesRead < chunkSize && !parentAppFileStream.eof())
-                {
-                    if (parentAppFileStream.fail())
-                    {
-                        spdlog::error("Failed to read file {} to the end for hashing, aborting", parentAppPath.value());
-                        break;
-                    }
-                }
-            }
-
-            std::vector<char> currentAppFileBuffer(chunkSize);
-            while (!currentAppFileStream.eof())
-            {
-                currentAppFileStream.read(currentAppFileBuffer.data(), currentAppFileBuffer.size());
-                std::streamsize bytesRead = currentAppFileStream.gcount();
-
-                currentSha256Alg.add(currentAppFileBuffer.data(), bytesRead);
-
-                if (bytesRead < chunkSize && !currentAppFileStream.eof())
-                {
-                    if (currentAppFileStream.fail())
-                    {
-                        spdlog::error("Failed to read file {} to the end for hashing, aborting", appPath);
-                        break;
-                    }
-                }
-            }
-
-            const auto hashLhs = parentSha256Alg.getHash();
-            const auto hashRhs = currentSha256Alg.getHash();
+            const auto& hashLhs = parentHash.value().front();
+            const auto& hashRhs = currentHash.value().front();
 
             spdlog::debug("Hashes LHS {} vs. RHS {}", hashLhs, hashRhs);
 
@@ -257,13 +232,11 @@ models::InstanceConfig::InstanceConfig(HINSTANCE hInstance, argh::parser& cmdl,
         }
         else
         {
-            spdlog::warn("Failed to open process module streams for comparison");
+            spdlog::warn("Failed to read process modules for comparison: {}",
+                         !parentHash.has_value() ? parentHash.error() : currentHash.error());
             // prerequisites for running in this mode not met
             this->isTemporaryCopy = false;
         }
-
-        parentAppFileStream.close();
-        currentAppFileStream.close();
     }
 
     spdlog::debug("isTemporaryCopy = {}", this->isTemporaryCopy);
@@ -548,6 +521,14 @@ models::InstanceConfig::~InstanceConfig()
             continue;
         }
 
+        // an unfinished download is kept for the next run to continue
+        if (const auto journal = LoadResumeJournal(release.downloadUrl);
+            journal.has_value() && journal->tempFile == release.localTempFilePath)
+        {
+            spdlog::debug("Keeping partial download {} for resuming", release.localTempFilePath);
+            continue;
+        }
+
         // delete local setup copy
         if (DeleteFileA(release.localTempFilePath.string().c_str()) == FALSE)
         {
@@ -573,7 +554,7 @@ void models::InstanceConfig::ApplyCustomWindowIcon(HWND hWnd)
 
     spdlog::debug("Custom icon: decoding {} base64 characters", merged.iconBase64->size());
 
-    const auto decoded = winapi::DecodeBase64(*merged.iconBase64);
+    const auto decoded = util::DecodeBase64(*merged.iconBase64);
     if (!decoded)
     {
         spdlog::warn("Custom icon: base64 decode failed: {}", decoded.error());
@@ -861,109 +842,27 @@ std::expected<bool, std::string> models::InstanceConfig::IsInstalledVersionOutda
                 return std::unexpected("File to hash not found");
             }
 
-            std::ifstream file(filePath, std::ios::binary);
-
-            if (!file.is_open())
-            {
-                spdlog::error("Failed to open file {}", filePath);
-                return std::unexpected("Failed to open file");
-            }
-
-            // improve hashing speed
-            constexpr std::size_t chunkSize = 4 * 1024; // 4 KB
-
             // checksum detection data of release
             const auto& hashCfg = release.detectionChecksum.value();
 
-            switch (hashCfg.checksumAlg)
+            if (hashCfg.checksumAlg == ChecksumAlgorithm::Invalid)
             {
-                case ChecksumAlgorithm::MD5:
-                {
-                    spdlog::debug("Hashing with MD5");
-                    MD5 alg;
-
-                    std::vector<char> buffer(chunkSize);
-                    while (!file.eof())
-                    {
-                        file.read(buffer.data(), buffer.size());
-                        std::streamsize bytesRead = file.gcount();
-
-                        alg.add(buffer.data(), bytesRead);
-
-                        if (bytesRead < chunkSize && !file.eof())
-                        {
-                            if (file.fail())
-                            {
-                                spdlog::error("Failed to read file {} to end", filePath);
-                                return std::unexpected("Failed to read file");
-                            }
-                        }
-                    }
-
-                    const bool isOutdated = !util::icompare(alg.getHash(), hashCfg.checksum);
-                    spdlog::debug("isOutdated = {}", isOutdated);
-                    return isOutdated;
-                }
-                case ChecksumAlgorithm::SHA1:
-                {
-                    spdlog::debug("Hashing with SHA1");
-                    SHA1 alg;
-
-                    std::vector<char> buffer(chunkSize);
-                    while (!file.eof())
-                    {
-                        file.read(buffer.data(), buffer.size());
-                        std::streamsize bytesRead = file.gcount();
-
-                        alg.add(buffer.data(), bytesRead);
-
-                        if (bytesRead < chunkSize && !file.eof())
-                        {
-                            if (file.fail())
-                            {
-                                spdlog::error("Failed to read file {} to end", filePath);
-                                return std::unexpected("Failed to read file");
-                            }
-                        }
-                    }
-
-                    const bool isOutdated = !util::icompare(alg.getHash(), hashCfg.checksum);
-                    spdlog::debug("isOutdated = {}", isOutdated);
-                    return isOutdated;
-                }
-                case ChecksumAlgorithm::SHA256:
-                {
-                    spdlog::debug("Hashing with SHA256");
-                    SHA256 alg;
+                spdlog::error("Invalid hashing algorithm specified");
+                return std::unexpected("Invalid hashing algorithm");
+            }
 
-                    std::vector<char> buffer(chunkSize);
-                    while (!file.eof())
-                    {
-                        file.read(buffer.data(), buffer.size());
-                        std::streamsize bytesRead = file.gcount();
-
-                        alg.add(buffer.data(), bytesRead);
-
-                        if (bytesRead < chunkSize && !file.eof())
-                        {
-                            if (file.fail())
-                            {
-                                spdlog::error("Failed to read file {} to end", filePath);
-                                return std::unexpected("Failed to read file");
-                            }
-                        }
-                    }
+            spdlog::debug("Hashing with {}", magic_enum::enum_name(hashCfg.checksumAlg));
 
-                    const bool isOutdated = !util::icompare(alg.getHash(), hashCfg.checksum);
-                    spdlog::debug("isOutdated = {}", isOutdated);
-                    return isOutdated;
-                }
-                case ChecksumAlgorithm::Invalid:
-                    spdlog::error("Invalid hashing algorithm specified");
-                    return std::unexpected("Invalid hashing algorithm");
+            const auto digest = GetDetectionChecksum(filePath, hashCfg.checksumAlg);
+            if (!digest.has_value())
+            {
+                spdlog::error("Failed to hash file {}: {}", filePath, digest.error());
+                return std::unexpected("Failed to read file");
             }
 
-            break;
+            const bool isOutdated = !util::icompare(digest.value(), hashCfg.checksum);
+            spdlog::debug("isOutdated = {}", isOutdated);
+            return isOutdated;
         }
         //
         // Evaluate custom expression
@@ -1018,6 +917,145 @@ std::expected<bool, std::string> models::InstanceConfig::IsInstalledVersionOutda
     return std::unexpected("Unsupported detection method");
 }
 
+std::optional<models::ReleasePatch> models::InstanceConfig::FindApplicablePatch(std::filesystem::path& basePath) const
+{
+    const auto& release = GetSelectedRelease();
+
+    if (!release.patches.has_value() || release.patches->empty())
+    {
+        return std::nullopt;
+    }
+
+    // the reconstructed file can't be trusted without something to check it against
+    if (!release.checksum.has_value())
+    {
+        spdlog::debug("Release offers patches but no checksum, ignoring them");
+        return std::nullopt;
+    }
+
+    std::string filePath;
+    VersionResource statement = VersionResource::FILEVERSION;
+
+    try
+    {
+        switch (merged.detectionMethod)
+        {
+            case ProductVersionDetectionMethod::FileVersion:
+            {
+                const auto cfg = merged.GetFileVersionConfig();
+                filePath = RenderInjaTemplate(cfg.input, cfg.data);
+                statement = cfg.statement;
+                break;
+            }
+            case ProductVersionDetectionMethod::FileSize:
+            {
+                const auto cfg = merged.GetFileSizeConfig();
+                filePath = RenderInjaTemplate(cfg.input, cfg.data);
+                break;
+            }
+            case ProductVersionDetectionMethod::FileChecksum:
+            {
+                const auto cfg = merged.GetFileChecksumConfig();
+                filePath = RenderInjaTemplate(cfg.input, cfg.data);
+                break;
+            }
+            default:
+                spdlog::debug("Detection method {} has no file to patch", magic_enum::enum_name(merged.detectionMethod));
+                return std::nullopt;
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        spdlog::warn("Failed to resolve product detection file, error: {}", ex.what());
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(filePath, ec))
+    {
+        spdlog::debug("Product detection file {} not found, can't patch", filePath);
+        return std::nullopt;
+    }
+
+    // every algorithm the patches' checksums use, computed in a single pass over the file
+    std::vector<ChecksumAlgorithm> algorithms{};
+    for (const auto& patch : release.patches.value())
+    {
+        if (!patch.detectionChecksum.has_value())
+        {
+            continue;
+        }
+
+        if (const auto alg = patch.detectionChecksum->checksumAlg;
+            alg != ChecksumAlgorithm::Invalid && std::ranges::find(algorithms, alg) == algorithms.end())
+        {
+            algorithms.push_back(alg);
+        }
+    }
+
+    std::unordered_map<ChecksumAlgorithm, std::string> localHashes{};
+    if (!algorithms.empty())
+    {
+        if (const auto digests = hashing::HashFile(filePath, algorithms); digests.has_value())
+        {
+            for (size_t i = 0; i < algorithms.size(); i++)
+            {
+                localHashes[ algorithms[ i ] ] = digests.value()[ i ];
+            }
+        }
+        else
+        {
+            spdlog::warn("Failed to hash {}, checksum-based patches are skipped: {}", filePath, digests.error());
+        }
+    }
+
+    std::optional<semver::version> localVersion{};
+    if (const auto version = statement == VersionResource::PRODUCTVERSION
+                                 ? winapi::GetWin32ResourceProductVersion(filePath)
+                                 : winapi::GetWin32ResourceFileVersion(filePath);
+        version.has_value())
+    {
+        localVersion = version.value();
+    }
+
+    for (const auto& patch : release.patches.value())
+    {
+        if (patch.detectionChecksum.has_value())
+        {
+            const auto& expected = patch.detectionChecksum.value();
+            const auto local = localHashes.find(expected.checksumAlg);
+
+            if (local == localHashes.end() || !util::icompare(local->second, expected.checksum))
+            {
+                continue;
+            }
+        }
+        else if (patch.detectionVersion.has_value())
+        {
+            const auto patchVersion = patch.GetDetectionSemVersion();
+
+            if (!localVersion.has_value() || !patchVersion.has_value() ||
+                util::CompareVersions(patchVersion.value(), localVersion.value()) != 0)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            spdlog::warn("Patch {} specifies neither detectionChecksum nor detectionVersion, skipping",
+                         patch.downloadUrl);
+            continue;
+        }
+
+        spdlog::info("Patch {} applies to installed file {}", patch.downloadUrl, filePath);
+        basePath = filePath;
+        return patch;
+    }
+
+    spdlog::debug("None of the {} patches applies to {}", release.patches->size(), filePath);
+    return std::nullopt;
+}
+
 std::expected<void, std::string> models::InstanceConfig::RegisterAutostart(const std::string& launchArgs) const
 {
     winreg::RegKey key;
@@ -1141,3 +1179,18 @@ bool models::InstanceConfig::TryRunTemporaryProcess() const
 
     return true;
 }
+
+std::filesystem::path models::InstanceConfig::GetLocalDataDirectory() const
+{
+    const auto localAppData = winapi::GetLocalAppDataPath();
+    if (!localAppData)
+    {
+        return {};
+    }
+
+    // same layout as the registry key used for the manifest version
+    return std::filesystem::path(*localAppData)
+        / (manufacturer.empty() ? appFilename : manufacturer)
+        / (product.empty() ? appFilename : product)
+        / "Vicius";
+}
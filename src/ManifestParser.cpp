@@ -0,0 +1,418 @@
+#include "pch.h"
+#include "ManifestParser.h"
+#include "Util.h"
+
+
+namespace
+{
+    /**
+     * \brief Minimal SAX to DOM builder for the parts of the document that aren't streamed.
+     */
+    class ValueBuilder
+    {
+        json* target{nullptr};
+        json* member{nullptr};
+        std::vector<json*> stack;
+        bool active{false};
+
+        template <typename Value>
+        json* Put(Value&& value)
+        {
+            if (stack.empty())
+            {
+                *target = json(std::forward<Value>(value));
+                return target;
+            }
+
+            json& parent = *stack.back();
+            if (parent.is_array())
+            {
+                parent.emplace_back(std::forward<Value>(value));
+                return &parent.back();
+            }
+
+            *member = json(std::forward<Value>(value));
+            return member;
+        }
+
+    public:
+        void Begin(json& into)
+        {
+            target = &into;
+            member = nullptr;
+            stack.clear();
+            active = true;
+        }
+
+        /** True while a value is being captured */
+        [[nodiscard]] bool IsActive() const { return active; }
+
+        template <typename Value>
+        bool Scalar(Value&& value)
+        {
+            Put(std::forward<Value>(value));
+            active = !stack.empty();
+            return true;
+        }
+
+        bool StartObject()
+        {
+            stack.push_back(Put(json::value_t::object));
+            return true;
+        }
+
+        bool StartArray()
+        {
+            stack.push_back(Put(json::value_t::array));
+            return true;
+        }
+
+        bool Key(json::string_t& key)
+        {
+            member = &(*stack.back())[ std::move(key) ];
+            return true;
+        }
+
+        bool End()
+        {
+            stack.pop_back();
+            active = !stack.empty();
+            return true;
+        }
+    };
+
+    /**
+     * \brief SAX handler streaming the releases array into UpdateRelease instances.
+     *
+     * The potentially large string members of a release are moved into place; everything else
+     * of a release is collected as (small) DOM and converted with the regular from_json so the
+     * model definition stays the single source of truth for defaults and validation.
+     */
+    class UpdateResponseHandler
+    {
+    public:
+        using number_integer_t = json::number_integer_t;
+        using number_unsigned_t = json::number_unsigned_t;
+        using number_float_t = json::number_float_t;
+        using string_t = json::string_t;
+        using binary_t = json::binary_t;
+
+    private:
+        enum class Scope
+        {
+            Document,
+            Root,
+            Releases,
+            Release,
+            Done,
+        };
+
+        struct StreamedMembers
+        {
+            std::optional<std::string> name;
+            std::optional<std::string> version;
+            std::optional<std::string> summary;
+            std::optional<std::string> publishedAt;
+            std::optional<std::string> downloadUrl;
+        };
+
+        json& remainder;
+        std::vector<models::UpdateRelease>& releases;
+        const manifest::ParseOptions& options;
+
+        Scope scope{Scope::Document};
+        ValueBuilder builder;
+        std::string pendingKey;
+
+        json releaseMembers;
+        StreamedMembers streamed;
+        json invalidRelease;
+
+        std::optional<std::string>* GetStreamedSlot(const std::string& key)
+        {
+            if (key == "summary") return &streamed.summary;
+            if (key == "name") return &streamed.name;
+            if (key == "version") return &streamed.version;
+            if (key == "publishedAt") return &streamed.publishedAt;
+            if (key == "downloadUrl") return &streamed.downloadUrl;
+            return nullptr;
+        }
+
+        /**
+         * \brief Starts capturing the value beginning at the current position as DOM.
+         */
+        ValueBuilder& Capture()
+        {
+            switch (scope)
+            {
+            case Scope::Document:
+                // not an object; the conversion in ParseUpdateResponse reports it
+                builder.Begin(remainder);
+                scope = Scope::Done;
+                break;
+            case Scope::Root:
+                builder.Begin(remainder[ pendingKey ]);
+                break;
+            case Scope::Releases:
+                // not an object; reported by Rethrow()
+                builder.Begin(invalidRelease);
+                break;
+            case Scope::Release:
+                builder.Begin(releaseMembers[ pendingKey ]);
+                break;
+            case Scope::Done:
+                // trailing data is rejected by the parser before it gets here
+                builder.Begin(invalidRelease);
+                break;
+            }
+
+            return builder;
+        }
+
+        template <typename Value>
+        bool Scalar(Value&& value)
+        {
+            if (!builder.IsActive())
+            {
+                Capture();
+            }
+
+            return builder.Scalar(std::forward<Value>(value));
+        }
+
+        void BeginRelease()
+        {
+            releaseMembers = json::object();
+            streamed = {};
+        }
+
+        void EndRelease()
+        {
+            auto release = releaseMembers.get<models::UpdateRelease>();
+
+            if (streamed.name) release.name = std::move(*streamed.name);
+            if (streamed.version) release.version = std::move(*streamed.version);
+            if (streamed.summary) release.summary = std::move(*streamed.summary);
+            if (streamed.publishedAt) release.publishedAt = std::move(*streamed.publishedAt);
+            if (streamed.downloadUrl) release.downloadUrl = std::move(*streamed.downloadUrl);
+
+            if (options.skipDisabled && release.disabled.value_or(false))
+            {
+                return;
+            }
+
+            if (options.minimumVersion.has_value() &&
+                util::CompareVersions(release.GetSemVersion(), options.minimumVersion.value()) < 0)
+            {
+                return;
+            }
+
+            releases.push_back(std::move(release));
+        }
+
+    public:
+        UpdateResponseHandler(json& remainder, std::vector<models::UpdateRelease>& releases,
+                              const manifest::ParseOptions& options)
+            : remainder(remainder), releases(releases), options(options)
+        {
+        }
+
+        /**
+         * \brief Raises the error the DOM conversion would have raised for a non-object release.
+         */
+        void Rethrow() const
+        {
+            if (!invalidRelease.is_null())
+            {
+                std::ignore = invalidRelease.get<models::UpdateRelease>();
+            }
+        }
+
+        bool null()
+        {
+            return Scalar(nullptr);
+        }
+
+        bool boolean(bool val)
+        {
+            return Scalar(val);
+        }
+
+        bool number_integer(number_integer_t val)
+        {
+            return Scalar(val);
+        }
+
+        bool number_unsigned(number_unsigned_t val)
+        {
+            return Scalar(val);
+        }
+
+        bool number_float(number_float_t val, const string_t&)
+        {
+            return Scalar(val);
+        }
+
+        bool string(string_t& val)
+        {
+            if (!builder.IsActive() && scope == Scope::Release)
+            {
+                if (auto* slot = GetStreamedSlot(pendingKey))
+                {
+                    *slot = std::move(val);
+                    return true;
+                }
+            }
+
+            return Scalar(std::move(val));
+        }
+
+        bool binary(binary_t& val)
+        {
+            return Scalar(json::binary(std::move(val)));
+        }
+
+        bool start_object(std::size_t)
+        {
+            if (builder.IsActive())
+            {
+                return builder.StartObject();
+            }
+
+            switch (scope)
+            {
+            case Scope::Document:
+                remainder = json::object();
+                scope = Scope::Root;
+                return true;
+            case Scope::Releases:
+                BeginRelease();
+                scope = Scope::Release;
+                return true;
+            default:
+                return Capture().StartObject();
+            }
+        }
+
+        bool key(string_t& val)
+        {
+            if (builder.IsActive())
+            {
+                return builder.Key(val);
+            }
+
+            pendingKey = std::move(val);
+            return true;
+        }
+
+        bool end_object()
+        {
+            if (builder.IsActive())
+            {
+                return builder.End();
+            }
+
+            if (scope == Scope::Release)
+            {
+                EndRelease();
+                scope = Scope::Releases;
+            }
+            else if (scope == Scope::Root)
+            {
+                scope = Scope::Done;
+            }
+
+            return true;
+        }
+
+        bool start_array(std::size_t)
+        {
+            if (builder.IsActive())
+            {
+                return builder.StartArray();
+            }
+
+            if (scope == Scope::Root && pendingKey == "releases")
+            {
+                scope = Scope::Releases;
+                return true;
+            }
+
+            return Capture().StartArray();
+        }
+
+        bool end_array()
+        {
+            if (builder.IsActive())
+            {
+                return builder.End();
+            }
+
+            // only the releases array is ever left open outside the builder
+            scope = Scope::Root;
+            return true;
+        }
+
+        template <class Exception>
+        bool parse_error(std::size_t, const std::string&, const Exception& ex)
+        {
+            throw ex;
+        }
+    };
+}
+
+manifest::Format manifest::FormatFromContentType(std::string_view contentType)
+{
+    // strip parameters like "; charset=utf-8"
+    if (const auto semicolon = contentType.find(';'); semicolon != std::string_view::npos)
+    {
+        contentType = contentType.substr(0, semicolon);
+    }
+
+    const std::string mediaType = util::trim(std::string(contentType));
+
+    if (util::icompare(mediaType, "application/cbor"))
+    {
+        return Format::Cbor;
+    }
+
+    if (util::icompare(mediaType, "application/msgpack") ||
+        util::icompare(mediaType, "application/x-msgpack") ||
+        util::icompare(mediaType, "application/vnd.msgpack"))
+    {
+        return Format::MessagePack;
+    }
+
+    return Format::Json;
+}
+
+models::UpdateResponse manifest::ParseUpdateResponse(std::string_view body, Format format, json& remainder,
+                                                     const ParseOptions& options)
+{
+    std::vector<models::UpdateRelease> releases;
+    UpdateResponseHandler handler(remainder, releases, options);
+
+    json::input_format_t inputFormat = json::input_format_t::json;
+    switch (format)
+    {
+    case Format::Json:
+        inputFormat = json::input_format_t::json;
+        break;
+    case Format::Cbor:
+        inputFormat = json::input_format_t::cbor;
+        break;
+    case Format::MessagePack:
+        inputFormat = json::input_format_t::msgpack;
+        break;
+    }
+
+    remainder = json{};
+    json::sax_parse(body, &handler, inputFormat);
+    handler.Rethrow();
+
+    // converts instance/shared and raises the same errors as before for malformed members
+    auto response = remainder.get<models::UpdateResponse>();
+    response.releases = std::move(releases);
+
+    return response;
+}
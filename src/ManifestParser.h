@@ -0,0 +1,61 @@
+#pragma once
+
+#include "models/UpdateResponse.hpp"
+
+
+namespace manifest
+{
+    /**
+     * \brief Wire formats a manifest can be served in.
+     */
+    enum class Format
+    {
+        Json,
+        Cbor,
+        MessagePack,
+    };
+
+    /**
+     * \brief The Accept header value offering every supported format, binary ones preferred.
+     */
+    inline constexpr const char* ACCEPT_HEADER_VALUE =
+        "application/cbor, application/msgpack;q=0.9, application/json;q=0.8";
+
+    /**
+     * \brief Maps a Content-Type response header to the manifest format, JSON if unknown or absent.
+     */
+    Format FormatFromContentType(std::string_view contentType);
+
+    /**
+     * \brief Filters applied while the releases are streamed in.
+     */
+    struct ParseOptions
+    {
+        /** Don't collect releases with disabled set to true */
+        bool skipDisabled{true};
+        /** If set, releases with a lower version are not collected */
+        std::optional<semver::version> minimumVersion{};
+    };
+
+    /**
+     * \brief Parses an update manifest straight into an UpdateResponse.
+     *
+     * The releases array is consumed by a SAX handler that builds one UpdateRelease at a time
+     * and moves the large string members (summary etc.) directly into it, so no DOM of the
+     * releases is ever built. Every other top-level member (instance, shared, manifestVersion,
+     * ...) is still materialized as DOM since the callers inspect it.
+     *
+     * Releases are returned in document order. The binary formats produce the same SAX events
+     * as JSON and thus deserialize into the very same models.
+     *
+     * \param body The raw document.
+     * \param format The wire format of body.
+     * \param remainder Receives the document without its releases member.
+     * \param options Release filters.
+     * \return The deserialized response.
+     * \throws json::exception on malformed documents, the same way json::parse (or
+     *         json::from_cbor etc.) and json::get<UpdateResponse> would.
+     */
+    models::UpdateResponse ParseUpdateResponse(std::string_view body, Format format, json& remainder,
+                                               const ParseOptions& options = {});
+}
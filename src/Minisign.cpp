@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "Minisign.h"
+
+#if defined(NV_MANIFEST_PUBLIC_KEY) || defined(NV_MINISIGN_SUPPORT)
+
+namespace
+{
+    /**
+     * \brief Parse a minisign .minisig file and extract the raw Ed25519 signature bytes.
+     *
+     * The minisign .minisig format is:
+     *   Line 0: comment ("untrusted comment: ...")
+     *   Line 1: base64-encoded  "signature_algorithm (2 bytes) || key_id (8 bytes) || signature (64 bytes)"
+     *   Line 2: trusted comment ("trusted comment: ...")
+     *   Line 3: base64-encoded global signature (covers trusted comment + file signature)
+     *
+     * We only need line 1 to verify the file body.
+     */
+    bool ParseMinisigFile(const std::string& minisigBody,
+                          std::string& outKeyId,
+                          std::vector<unsigned char>& outSig,
+                          bool& outPrehashed)
+    {
+        // Split into lines
+        std::vector<std::string> lines;
+        std::istringstream ss(minisigBody);
+        std::string line;
+        while (std::getline(ss, line))
+        {
+            // Strip CR
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) lines.push_back(line);
+        }
+
+        if (lines.size() < 2) return false;
+
+        // Decode line 1 (base64)
+        const auto& b64 = lines[1];
+        const size_t decodedLen = b64.size(); // base64 text is always longer than its decoded form
+        std::vector<unsigned char> decoded(decodedLen);
+        size_t actualLen = 0;
+
+        if (sodium_base642bin(decoded.data(), decodedLen, b64.c_str(), b64.size(),
+                              nullptr, &actualLen, nullptr, sodium_base64_VARIANT_ORIGINAL) != 0)
+        {
+            return false;
+        }
+
+        // Layout: 2 bytes algo + 8 bytes key id + 64 bytes Ed25519 sig = 74 bytes total
+        if (actualLen < 74) return false;
+
+        // First 2 bytes: algorithm tag.
+        //   "Ed" = legacy   : pure Ed25519 over the raw message
+        //   "ED" = prehashed : Ed25519 over BLAKE2b-512 of the message
+        // minisign has defaulted to the prehashed ("ED") format since 0.6, so we
+        // must accept both and verify accordingly (see VerifySignature).
+        if (decoded[0] != 'E') return false;
+        if (decoded[1] == 'd')      outPrehashed = false;
+        else if (decoded[1] == 'D') outPrehashed = true;
+        else                        return false;
+
+        // Bytes 2-9: key id (we store as hex string for logging)
+        std::string keyId;
+        keyId.reserve(16);
+        for (int i = 2; i < 10; ++i)
+        {
+            char buf[3];
+            std::snprintf(buf, sizeof(buf), "%02x", decoded[i]);
+            keyId += buf;
+        }
+        outKeyId = keyId;
+
+        // Bytes 10-73: Ed25519 signature
+        outSig.assign(decoded.begin() + 10, decoded.begin() + 10 + crypto_sign_BYTES);
+        return true;
+    }
+
+    /**
+     * \brief Decode a base64 minisign public key (e.g. NV_MANIFEST_PUBLIC_KEY).
+     *        The key string is the second line of a minisign .pub file.
+     *        Layout: 2 bytes algo + 8 bytes key id + 32 bytes public key = 42 bytes.
+     */
+    bool ParseMinisignPublicKey(const char* pubKeyStr,
+                                std::vector<unsigned char>& outPubKey)
+    {
+        const size_t maxLen = strlen(pubKeyStr); // base64 text is always longer than its decoded form
+        std::vector<unsigned char> decoded(maxLen);
+        size_t actualLen = 0;
+
+        if (sodium_base642bin(decoded.data(), maxLen, pubKeyStr, strlen(pubKeyStr),
+                              nullptr, &actualLen, nullptr, sodium_base64_VARIANT_ORIGINAL) != 0)
+        {
+            return false;
+        }
+
+        if (actualLen < 42) return false;                    // 2 + 8 + 32
+        if (decoded[0] != 'E' || decoded[1] != 'd') return false;
+
+        outPubKey.assign(decoded.begin() + 10, decoded.begin() + 10 + crypto_sign_PUBLICKEYBYTES);
+        return true;
+    }
+}
+
+std::expected<void, std::string> minisign::VerifySignature(const std::string& body,
+                                                           const std::string& minisigBody,
+                                                           const char* publicKey)
+{
+    if (sodium_init() < 0)
+    {
+        return std::unexpected("Failed to initialize libsodium");
+    }
+
+    // Parse the .minisig sidecar
+    std::string keyId;
+    std::vector<unsigned char> sig;
+    bool prehashed = false;
+    if (!ParseMinisigFile(minisigBody, keyId, sig, prehashed))
+    {
+        return std::unexpected("Failed to parse signature file (.minisig)");
+    }
+
+    spdlog::debug("VerifySignature: key id from .minisig = {}", keyId);
+
+    if (sig.size() != crypto_sign_BYTES)
+    {
+        return std::unexpected(std::format("Invalid signature length: expected {}, got {}",
+                                           crypto_sign_BYTES, sig.size()));
+    }
+
+    // Decode the public key
+    std::vector<unsigned char> pubKey;
+    if (!ParseMinisignPublicKey(publicKey, pubKey))
+    {
+        return std::unexpected("Failed to decode the minisign public key");
+    }
+
+    if (pubKey.size() != crypto_sign_PUBLICKEYBYTES)
+    {
+        return std::unexpected("Invalid public key length");
+    }
+
+    // Verify the detached Ed25519 signature. In prehashed ("ED") mode the
+    // signature covers BLAKE2b-512 of the body (minisign's default), so we must
+    // hash the document first and verify over the 64-byte digest; in legacy
+    // ("Ed") mode the signature covers the raw body directly.
+    int result;
+    if (prehashed)
+    {
+        unsigned char digest[crypto_generichash_BYTES_MAX];
+        crypto_generichash(
+            digest, sizeof digest,
+            reinterpret_cast<const unsigned char*>(body.data()),
+            body.size(),
+            nullptr, 0
+        );
+        result = crypto_sign_verify_detached(sig.data(), digest, sizeof digest, pubKey.data());
+    }
+    else
+    {
+        result = crypto_sign_verify_detached(
+            sig.data(),
+            reinterpret_cast<const unsigned char*>(body.data()),
+            body.size(),
+            pubKey.data()
+        );
+    }
+
+    if (result != 0)
+    {
+        spdlog::error("VerifySignature: Ed25519 signature verification FAILED ({} mode)",
+                      prehashed ? "prehashed" : "legacy");
+        return std::unexpected("Signature is invalid - the document may have been tampered with");
+    }
+
+    spdlog::info("VerifySignature: signature valid");
+    return {};
+}
+
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <expected>
+#include <string>
+
+
+// built along with a compiled-in manifest key, or when requested explicitly (e.g. by the benchmarks)
+#if defined(NV_MANIFEST_PUBLIC_KEY) || defined(NV_MINISIGN_SUPPORT)
+
+namespace minisign
+{
+    /**
+     * \brief Verifies a detached minisign Ed25519 signature over a document.
+     *
+     * Both signature formats minisign produces are accepted: legacy ("Ed", Ed25519 over the raw
+     * document) and prehashed ("ED", Ed25519 over the BLAKE2b-512 digest of the document).
+     *
+     * \param body The raw bytes the signature covers.
+     * \param minisigBody The raw contents of the .minisig sidecar file.
+     * \param publicKey The base64 public key, i.e. the second line of a minisign .pub file.
+     * \return Empty on success; unexpected error string on failure.
+     */
+    [[nodiscard]] std::expected<void, std::string> VerifySignature(const std::string& body,
+                                                                   const std::string& minisigBody,
+                                                                   const char* publicKey);
+}
+
+#endif
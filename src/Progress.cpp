@@ -0,0 +1,104 @@
+#include "pch.h"
+#include "Progress.h"
+
+
+void web::DownloadProgress::Publish(const DownloadPhase newPhase, const uint64_t newDownloaded,
+                                    const uint64_t newTotal, const uint64_t newRate)
+{
+    const uint32_t seq = sequence.load(std::memory_order_relaxed);
+
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    // keeps the field stores below from becoming visible before the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+
+    phase.store(newPhase, std::memory_order_relaxed);
+    downloaded.store(newDownloaded, std::memory_order_relaxed);
+    total.store(newTotal, std::memory_order_relaxed);
+    bytesPerSecond.store(newRate, std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+void web::DownloadProgress::Reset()
+{
+    sampleTime.reset();
+    sampleBytes = 0;
+    rate = 0;
+
+    Publish(DownloadPhase::Idle, 0, 0, 0);
+}
+
+void web::DownloadProgress::SetPhase(const DownloadPhase newPhase, const uint64_t newDownloaded,
+                                     const uint64_t newTotal)
+{
+    sampleTime.reset();
+    sampleBytes = 0;
+    rate = 0;
+
+    Publish(newPhase, newDownloaded, newTotal, 0);
+}
+
+void web::DownloadProgress::Update(const uint64_t newDownloaded, const uint64_t newTotal)
+{
+    DownloadPhase current = phase.load(std::memory_order_relaxed);
+    if (current == DownloadPhase::Starting)
+    {
+        current = DownloadPhase::Downloading;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    // the first sample, or the file got truncated for a retry: start measuring from here
+    if (!sampleTime.has_value() || newDownloaded < sampleBytes)
+    {
+        sampleTime = now;
+        sampleBytes = newDownloaded;
+    }
+    else if (const std::chrono::duration<double> elapsed = now - sampleTime.value();
+        elapsed >= RATE_SAMPLE_INTERVAL)
+    {
+        const double sample = static_cast<double>(newDownloaded - sampleBytes) / elapsed.count();
+        rate = rate <= 0 ? sample : rate + RATE_SMOOTHING * (sample - rate);
+
+        sampleTime = now;
+        sampleBytes = newDownloaded;
+    }
+
+    Publish(current, newDownloaded, newTotal, static_cast<uint64_t>(rate));
+}
+
+void web::DownloadProgress::Complete(const bool succeeded)
+{
+    Publish(succeeded ? DownloadPhase::Finished : DownloadPhase::Failed,
+            downloaded.load(std::memory_order_relaxed),
+            total.load(std::memory_order_relaxed),
+            0);
+}
+
+web::ProgressSnapshot web::DownloadProgress::GetSnapshot() const
+{
+    ProgressSnapshot snapshot{};
+
+    while (true)
+    {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0)
+        {
+            // a write is in progress, it's a handful of stores so just spin
+            continue;
+        }
+
+        snapshot.phase = phase.load(std::memory_order_relaxed);
+        snapshot.downloaded = downloaded.load(std::memory_order_relaxed);
+        snapshot.total = total.load(std::memory_order_relaxed);
+        snapshot.bytesPerSecond = bytesPerSecond.load(std::memory_order_relaxed);
+
+        // keeps the field loads above from being satisfied after the sequence is re-read
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) == before)
+        {
+            return snapshot;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+
+namespace web
+{
+    /**
+     * \brief What a release download is currently busy with.
+     */
+    enum class DownloadPhase : uint32_t
+    {
+        /** No download was started */
+        Idle,
+        /** Preparing, connecting or waiting for the first bytes */
+        Starting,
+        /** Receiving the release or its patch */
+        Downloading,
+        /** Reconstructing the release from a downloaded patch */
+        Patching,
+        /** The download task completed successfully */
+        Finished,
+        /** The download task completed with an error or got cancelled */
+        Failed,
+    };
+
+    /**
+     * \brief Consistent copy of the download progress at one point in time.
+     */
+    struct ProgressSnapshot
+    {
+        DownloadPhase phase{DownloadPhase::Idle};
+        /** Bytes received so far, including what an earlier attempt left on disk */
+        uint64_t downloaded{0};
+        /** Expected total size, 0 while unknown */
+        uint64_t total{0};
+        /** Smoothed transfer rate, 0 until enough samples were taken */
+        uint64_t bytesPerSecond{0};
+
+        /** True once the download task has produced its result */
+        [[nodiscard]] bool IsComplete() const
+        {
+            return phase == DownloadPhase::Finished || phase == DownloadPhase::Failed;
+        }
+
+        /** Estimated time until the download completes, if the total and rate are known */
+        [[nodiscard]] std::optional<std::chrono::seconds> GetEta() const
+        {
+            if (total == 0 || bytesPerSecond == 0 || downloaded > total)
+            {
+                return std::nullopt;
+            }
+
+            return std::chrono::seconds{(total - downloaded) / bytesPerSecond};
+        }
+    };
+
+    /**
+     * \brief Progress of a release download, written by the transfer thread and read by anyone.
+     *
+     * Published through a sequence lock: the single writer bumps the sequence to an odd value,
+     * updates the fields and bumps it to even again; readers retry until they saw the same even
+     * sequence before and after copying. Neither side ever waits on a lock, so the UI can take a
+     * snapshot every frame for free, and completion is just another phase.
+     */
+    class DownloadProgress
+    {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<DownloadPhase> phase{DownloadPhase::Idle};
+        std::atomic<uint64_t> downloaded{0};
+        std::atomic<uint64_t> total{0};
+        std::atomic<uint64_t> bytesPerSecond{0};
+
+        // rate estimation, only touched by the writer
+        std::optional<std::chrono::steady_clock::time_point> sampleTime{};
+        uint64_t sampleBytes{0};
+        double rate{0};
+
+        void Publish(DownloadPhase newPhase, uint64_t newDownloaded, uint64_t newTotal, uint64_t newRate);
+
+    public:
+        /** Rate samples are taken at most this often, shorter windows are too noisy */
+        static constexpr std::chrono::milliseconds RATE_SAMPLE_INTERVAL{500};
+        /** Weight of the newest sample in the smoothed rate */
+        static constexpr double RATE_SMOOTHING = 0.3;
+
+        DownloadProgress() = default;
+        DownloadProgress(const DownloadProgress&) = delete;
+        DownloadProgress& operator=(const DownloadProgress&) = delete;
+
+        /**
+         * \brief Back to Idle. Must not race with a writer, call before the download task starts.
+         */
+        void Reset();
+
+        /**
+         * \brief Enters a new phase and restarts the rate estimation, so bytes already on disk
+         *        (e.g. of a resumed file) don't show up as a burst of throughput.
+         */
+        void SetPhase(DownloadPhase newPhase, uint64_t newDownloaded = 0, uint64_t newTotal = 0);
+
+        /**
+         * \brief Reports the absolute progress of the current phase. Enters Downloading when
+         *        still Starting.
+         * \param newDownloaded Bytes received so far.
+         * \param newTotal Expected total size, 0 if unknown.
+         */
+        void Update(uint64_t newDownloaded, uint64_t newTotal);
+
+        /**
+         * \brief Marks the download task as done.
+         */
+        void Complete(bool succeeded);
+
+        [[nodiscard]] ProgressSnapshot GetSnapshot() const;
+    };
+}
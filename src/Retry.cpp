@@ -0,0 +1,168 @@
+#include "pch.h"
+#include "Retry.h"
+
+#include <charconv>
+#include <iomanip>
+#include <sstream>
+
+
+namespace
+{
+    class SteadyClock final : public retry::Clock
+    {
+    public:
+        [[nodiscard]] std::chrono::steady_clock::time_point Now() const override
+        {
+            return std::chrono::steady_clock::now();
+        }
+
+        [[nodiscard]] std::chrono::system_clock::time_point WallNow() const override
+        {
+            return std::chrono::system_clock::now();
+        }
+
+        bool SleepFor(const std::chrono::milliseconds duration, const std::stop_token& stopToken) override
+        {
+            std::mutex mutex;
+            std::condition_variable_any cv;
+            std::unique_lock lock(mutex);
+            cv.wait_for(lock, stopToken, duration, [] { return false; });
+            return !stopToken.stop_requested();
+        }
+    };
+
+    /**
+     * \brief Parses an IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+     */
+    std::optional<std::chrono::system_clock::time_point> ParseHttpDate(const std::string_view value)
+    {
+        std::tm tm{};
+        std::istringstream stream{std::string(value)};
+        stream.imbue(std::locale::classic());
+        stream >> std::get_time(&tm, "%a, %d %b %Y %H:%M:%S");
+        if (stream.fail())
+        {
+            return std::nullopt;
+        }
+
+        const std::chrono::year_month_day date{
+            std::chrono::year{tm.tm_year + 1900},
+            std::chrono::month{static_cast<unsigned>(tm.tm_mon + 1)},
+            std::chrono::day{static_cast<unsigned>(tm.tm_mday)}
+        };
+        if (!date.ok())
+        {
+            return std::nullopt;
+        }
+
+        return std::chrono::sys_days{date}
+            + std::chrono::hours{tm.tm_hour}
+            + std::chrono::minutes{tm.tm_min}
+            + std::chrono::seconds{tm.tm_sec};
+    }
+}
+
+retry::Clock& retry::SystemClock()
+{
+    static SteadyClock instance;
+    return instance;
+}
+
+retry::RetryPolicy::RetryPolicy(const RetryOptions& options, Clock& clock)
+    : options(options),
+      clock(clock),
+      eng(options.seed.has_value() ? options.seed.value() : std::random_device{}()),
+      previousDelay(options.baseDelay),
+      attemptsLeft(options.maxAttempts),
+      timeoutSecs(options.initialTimeoutSecs)
+{
+    if (options.budget.count() > 0)
+    {
+        deadline = clock.Now() + options.budget;
+    }
+}
+
+std::optional<std::chrono::milliseconds> retry::RetryPolicy::NextDelay(const Failure& failure)
+{
+    if (--attemptsLeft <= 0)
+    {
+        return std::nullopt;
+    }
+
+    if (failure.isTimeout)
+    {
+        timeoutSecs = std::min(std::lround(timeoutSecs * 1.5), options.maxTimeoutSecs);
+    }
+
+    // decorrelated jitter: uniform between base and three times the previous delay
+    const auto upper = std::max(options.baseDelay, std::min(options.maxDelay, previousDelay * 3));
+    std::uniform_int_distribution<int64_t> dist{options.baseDelay.count(), upper.count()};
+    std::chrono::milliseconds delay{dist(eng)};
+    previousDelay = delay;
+
+    // the server knows best when it'll be ready again
+    if ((failure.httpCode == httplib::TooManyRequests_429 || failure.httpCode == httplib::ServiceUnavailable_503) &&
+        !failure.retryAfter.empty())
+    {
+        if (const auto retryAfter = ParseRetryAfter(failure.retryAfter, clock.WallNow()); retryAfter.has_value())
+        {
+            // a misbehaving or hostile server must not park the updater for hours
+            if (retryAfter.value() > options.maxRetryAfter)
+            {
+                return std::nullopt;
+            }
+
+            delay = retryAfter.value();
+        }
+    }
+
+    if (options.budget.count() > 0 && clock.Now() + delay >= deadline)
+    {
+        return std::nullopt;
+    }
+
+    return delay;
+}
+
+bool retry::RetryPolicy::Sleep(const std::chrono::milliseconds delay, const std::stop_token& stopToken)
+{
+    return clock.SleepFor(delay, stopToken);
+}
+
+std::optional<std::chrono::milliseconds> retry::ParseRetryAfter(std::string_view value,
+                                                                const std::chrono::system_clock::time_point now)
+{
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) value.remove_prefix(1);
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.remove_suffix(1);
+
+    if (value.empty())
+    {
+        return std::nullopt;
+    }
+
+    if (std::ranges::all_of(value, [](const unsigned char c) { return std::isdigit(c) != 0; }))
+    {
+        uint64_t seconds = 0;
+        if (const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+            ec != std::errc{})
+        {
+            return std::nullopt;
+        }
+
+        // anything beyond a day is nonsense for our purposes and would overflow below
+        return std::chrono::seconds{std::min<uint64_t>(seconds, 24 * 60 * 60)};
+    }
+
+    const auto date = ParseHttpDate(value);
+    if (!date.has_value())
+    {
+        return std::nullopt;
+    }
+
+    if (date.value() <= now)
+    {
+        return std::chrono::milliseconds{0};
+    }
+
+    return std::chrono::duration_cast<std::chrono::milliseconds>(date.value() - now);
+}
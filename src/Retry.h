@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <random>
+#include <stop_token>
+#include <string>
+#include <string_view>
+
+
+namespace retry
+{
+    /**
+     * \brief Time source of a RetryPolicy, replaceable to run a schedule in virtual time.
+     */
+    class Clock
+    {
+    public:
+        virtual ~Clock() = default;
+
+        /** Monotonic time used for the budget */
+        [[nodiscard]] virtual std::chrono::steady_clock::time_point Now() const = 0;
+
+        /** Wall-clock time used to resolve absolute Retry-After dates */
+        [[nodiscard]] virtual std::chrono::system_clock::time_point WallNow() const = 0;
+
+        /**
+         * \brief Waits for the given duration unless stop is requested first.
+         * \return False if the wait was interrupted.
+         */
+        virtual bool SleepFor(std::chrono::milliseconds duration, const std::stop_token& stopToken) = 0;
+    };
+
+    /**
+     * \brief The real clock, sleeping on a condition variable so a stop request wakes it up.
+     */
+    Clock& SystemClock();
+
+    /**
+     * \brief Parameters of a RetryPolicy.
+     */
+    struct RetryOptions
+    {
+        /** Total number of attempts, including the first one */
+        int maxAttempts{5};
+        /** Lower bound and seed of the decorrelated jitter */
+        std::chrono::milliseconds baseDelay{1000};
+        /** Upper bound of a single jittered delay (Retry-After may exceed it) */
+        std::chrono::milliseconds maxDelay{30000};
+        /** Longest Retry-After that is waited out, the policy gives up if a server asks for more */
+        std::chrono::milliseconds maxRetryAfter{std::chrono::minutes{5}};
+        /** Wall time all attempts and delays together may take, zero for no limit */
+        std::chrono::milliseconds budget{0};
+        /** Stall timeout of the first attempt in seconds */
+        long initialTimeoutSecs{180};
+        /** Upper bound the stall timeout grows to after timeouts */
+        long maxTimeoutSecs{900};
+        /** Fixed seed for reproducible schedules, random if unset */
+        std::optional<uint64_t> seed{};
+    };
+
+    /**
+     * \brief Outcome of a failed attempt, as far as the schedule is concerned.
+     */
+    struct Failure
+    {
+        /** HTTP status code of the failed attempt, 0 for transport errors */
+        long httpCode{0};
+        /** True if the attempt ran into the stall timeout */
+        bool isTimeout{false};
+        /** Raw Retry-After response header value, if any */
+        std::string retryAfter{};
+    };
+
+    /**
+     * \brief Retry schedule shared by all network operations.
+     *
+     * Delays follow "decorrelated jitter" (each delay is drawn between the base delay and three
+     * times the previous one, capped), which spreads out clients that failed at the same moment.
+     * A Retry-After header on 429/503 replaces the jittered delay; retrying stops if it asks for
+     * more than maxRetryAfter. After a timeout the stall timeout for the next attempt grows by
+     * half. Retrying stops once the attempts or the time budget are used up.
+     */
+    class RetryPolicy
+    {
+        RetryOptions options;
+        Clock& clock;
+        std::mt19937_64 eng;
+        std::chrono::steady_clock::time_point deadline{};
+        std::chrono::milliseconds previousDelay;
+        int attemptsLeft;
+        long timeoutSecs;
+
+    public:
+        explicit RetryPolicy(const RetryOptions& options, Clock& clock = SystemClock());
+
+        /**
+         * \brief Accounts a failed attempt and computes the delay before the next one.
+         *        Doesn't wait, callers either use Sleep or schedule the retry themselves.
+         * \return The delay or std::nullopt if no further attempt should be made.
+         */
+        [[nodiscard]] std::optional<std::chrono::milliseconds> NextDelay(const Failure& failure);
+
+        /**
+         * \brief Waits out a delay returned by NextDelay on the policy's clock.
+         * \return False if the wait got cancelled.
+         */
+        [[nodiscard]] bool Sleep(std::chrono::milliseconds delay, const std::stop_token& stopToken = {});
+
+        /** Attempts still available after the ones accounted so far */
+        [[nodiscard]] int GetAttemptsLeft() const { return attemptsLeft; }
+
+        /** The stall timeout to use for the next attempt */
+        [[nodiscard]] long GetTimeoutSecs() const { return timeoutSecs; }
+    };
+
+    /**
+     * \brief Parses a Retry-After header value, either delay-seconds or an HTTP-date.
+     * \return The delay relative to now, zero for dates in the past, std::nullopt if malformed.
+     */
+    std::optional<std::chrono::milliseconds> ParseRetryAfter(std::string_view value,
+                                                             std::chrono::system_clock::time_point now);
+}
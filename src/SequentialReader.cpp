@@ -0,0 +1,171 @@
+#include "pch.h"
+#include "SequentialReader.h"
+
+#include <future>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    struct AlignedDelete
+    {
+        void operator()(uint8_t* block) const
+        {
+            ::operator delete[](block, std::align_val_t{io::READ_BLOCK_ALIGNMENT});
+        }
+    };
+
+    using AlignedBlock = std::unique_ptr<uint8_t[], AlignedDelete>;
+
+    AlignedBlock AllocateBlock()
+    {
+        return AlignedBlock(static_cast<uint8_t*>(
+            ::operator new[](io::READ_BLOCK_SIZE, std::align_val_t{io::READ_BLOCK_ALIGNMENT})));
+    }
+
+#if defined(_WIN32)
+    using FileHandle = HANDLE;
+    const FileHandle INVALID_FILE = INVALID_HANDLE_VALUE;
+
+    FileHandle OpenForReading(const std::filesystem::path& filePath)
+    {
+        // sharing matches ifstream, so files still open elsewhere (e.g. by a download) can be read
+        return CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    }
+
+    void CloseFile(const FileHandle file)
+    {
+        CloseHandle(file);
+    }
+
+    // positioned read, so the read-ahead doesn't depend on a shared file pointer
+    int64_t ReadAt(const FileHandle file, const uint64_t offset, uint8_t* buffer, const size_t length)
+    {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD read = 0;
+        if (!ReadFile(file, buffer, static_cast<DWORD>(length), &read, &overlapped))
+        {
+            return GetLastError() == ERROR_HANDLE_EOF ? 0 : -1;
+        }
+
+        return read;
+    }
+#else
+    using FileHandle = int;
+    constexpr FileHandle INVALID_FILE = -1;
+
+    FileHandle OpenForReading(const std::filesystem::path& filePath)
+    {
+        const int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file != INVALID_FILE)
+        {
+            posix_fadvise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+        return file;
+    }
+
+    void CloseFile(const FileHandle file)
+    {
+        close(file);
+    }
+
+    int64_t ReadAt(const FileHandle file, const uint64_t offset, uint8_t* buffer, const size_t length)
+    {
+        size_t total = 0;
+        while (total < length)
+        {
+            const ssize_t read = pread(file, buffer + total, length - total, static_cast<off_t>(offset + total));
+            if (read < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return -1;
+            }
+            if (read == 0)
+            {
+                break;
+            }
+            total += static_cast<size_t>(read);
+        }
+
+        return static_cast<int64_t>(total);
+    }
+#endif
+}
+
+std::expected<uint64_t, std::string> io::ReadSequential(const std::filesystem::path& filePath, const uint64_t begin,
+                                                        const uint64_t end, const BlockSink& sink)
+{
+    const FileHandle file = OpenForReading(filePath);
+    if (file == INVALID_FILE)
+    {
+        return std::unexpected(std::format("Failed to open {}", filePath.string()));
+    }
+    const auto fileGuard = sg::make_scope_guard([file]() noexcept { CloseFile(file); });
+
+    auto readBlock = [file, end](const uint64_t offset, uint8_t* buffer) -> int64_t
+    {
+        return ReadAt(file, offset, buffer, static_cast<size_t>(std::min<uint64_t>(READ_BLOCK_SIZE, end - offset)));
+    };
+
+    if (begin >= end)
+    {
+        return 0;
+    }
+
+    AlignedBlock current = AllocateBlock();
+    AlignedBlock next{};
+
+    uint64_t offset = begin;
+    int64_t length = readBlock(offset, current.get());
+
+    while (length > 0)
+    {
+        const uint64_t blockEnd = offset + static_cast<uint64_t>(length);
+
+        // a full block that isn't the last one requested, so more is expected
+        std::future<int64_t> ahead{};
+        if (length == static_cast<int64_t>(READ_BLOCK_SIZE) && blockEnd < end)
+        {
+            if (!next)
+            {
+                next = AllocateBlock();
+            }
+            ahead = std::async(std::launch::async, readBlock, blockEnd, next.get());
+        }
+
+        const bool proceed = sink(current.get(), static_cast<size_t>(length));
+        offset = blockEnd;
+
+        if (!ahead.valid())
+        {
+            return offset - begin;
+        }
+
+        length = ahead.get();
+
+        if (!proceed)
+        {
+            return offset - begin;
+        }
+
+        std::swap(current, next);
+    }
+
+    if (length < 0)
+    {
+        return std::unexpected(std::format("Failed to read {}", filePath.string()));
+    }
+
+    return offset - begin;
+}
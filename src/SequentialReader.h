@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <string>
+
+
+namespace io
+{
+    /** Size of the blocks ReadSequential hands out, large enough for BLAKE3 to use every core */
+    constexpr size_t READ_BLOCK_SIZE = 4 * 1024 * 1024; // 4 MiB
+
+    /** Alignment of the block buffers, a page so copies out of the file cache stay on fast paths */
+    constexpr size_t READ_BLOCK_ALIGNMENT = 4096;
+
+    /** Pass as end to ReadSequential to read up to the end of the file */
+    constexpr uint64_t READ_TO_END = std::numeric_limits<uint64_t>::max();
+
+    /**
+     * \brief Callback receiving the blocks of ReadSequential in file order.
+     * \return False to stop reading.
+     */
+    using BlockSink = std::function<bool(const uint8_t* data, size_t length)>;
+
+    /**
+     * \brief Reads a byte range of a file front to back in large aligned blocks.
+     *
+     * The file is opened for sequential access, so the OS reads ahead aggressively, and the next
+     * block is read on another thread while sink processes the current one. Reading and hashing
+     * a file therefore overlap instead of alternating in small steps.
+     *
+     * \param filePath The file to read.
+     * \param begin Offset of the first byte to read.
+     * \param end Offset to stop at, or READ_TO_END.
+     * \param sink Receives the blocks.
+     * \return The number of bytes handed to sink, which is less than requested if the file is
+     *         shorter or sink stopped early, or an error message if the file couldn't be read.
+     */
+    std::expected<uint64_t, std::string> ReadSequential(const std::filesystem::path& filePath, uint64_t begin,
+                                                        uint64_t end, const BlockSink& sink);
+}
@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "Throttle.h"
+
+#include <winsock2.h>
+#include <mstcpip.h>
+
+
+namespace
+{
+    /**
+     * \brief Queries the kernel's smoothed RTT estimate of a transfer's connection.
+     * \remarks SIO_TCP_INFO requires Windows 10 1703 or newer.
+     */
+    std::optional<std::chrono::microseconds> QueryConnectionRtt(CURL* handle)
+    {
+        curl_socket_t socket = CURL_SOCKET_BAD;
+        if (curl_easy_getinfo(handle, CURLINFO_ACTIVESOCKET, &socket) != CURLE_OK || socket == CURL_SOCKET_BAD)
+        {
+            return std::nullopt;
+        }
+
+        DWORD version = 0;
+        TCP_INFO_v0 info{};
+        DWORD bytesReturned = 0;
+
+        if (WSAIoctl(socket, SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info), &bytesReturned,
+                     nullptr, nullptr) != 0)
+        {
+            return std::nullopt;
+        }
+
+        return std::chrono::microseconds{info.RttUs};
+    }
+}
+
+web::BandwidthThrottle::BandwidthThrottle(const uint64_t bytesPerSecond, const bool adaptive)
+    : maxRate(std::max<uint64_t>(bytesPerSecond, 1)),
+      // never starve the transfer into its stall timeout
+      minRate(std::max<uint64_t>(maxRate / 16, 1)),
+      currentRate(maxRate),
+      isAdaptive(adaptive),
+      lastRefill(std::chrono::steady_clock::now())
+{
+}
+
+void web::BandwidthThrottle::Refill(const std::chrono::steady_clock::time_point now)
+{
+    const std::chrono::duration<double> elapsed = now - lastRefill;
+    lastRefill = now;
+
+    // allow bursts of a quarter second worth of data
+    const double capacity = static_cast<double>(currentRate) / 4.0;
+    tokens = std::min(capacity, tokens + elapsed.count() * static_cast<double>(currentRate));
+}
+
+bool web::BandwidthThrottle::Consume(const size_t bytes, const std::stop_token& stopToken)
+{
+    std::chrono::duration<double> wait{};
+
+    {
+        std::lock_guard guard(lock);
+        Refill(std::chrono::steady_clock::now());
+
+        // go into debt and pay it off by waiting, so large blocks are accounted precisely
+        tokens -= static_cast<double>(bytes);
+        if (tokens < 0)
+        {
+            wait = std::chrono::duration<double>(-tokens / static_cast<double>(currentRate));
+        }
+    }
+
+    if (wait.count() <= 0)
+    {
+        return true;
+    }
+
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    std::unique_lock waitLock(mutex);
+    cv.wait_for(waitLock, stopToken, std::chrono::duration_cast<std::chrono::milliseconds>(wait), [] { return false; });
+
+    return !stopToken.stop_requested();
+}
+
+void web::BandwidthThrottle::SampleRtt(CURL* handle)
+{
+    if (!isAdaptive)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard guard(lock);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastRttSample < ADAPTIVE_SAMPLE_INTERVAL)
+        {
+            return;
+        }
+        lastRttSample = now;
+    }
+
+    if (const auto rtt = QueryConnectionRtt(handle); rtt.has_value() && rtt->count() > 0)
+    {
+        AddRttSample(rtt.value());
+    }
+}
+
+void web::BandwidthThrottle::AddRttSample(const std::chrono::microseconds rtt)
+{
+    std::lock_guard guard(lock);
+
+    if (!baseRtt.has_value() || rtt < baseRtt.value())
+    {
+        baseRtt = rtt;
+    }
+
+    const uint64_t previousRate = currentRate;
+
+    if (rtt - baseRtt.value() > ADAPTIVE_DELAY_TARGET)
+    {
+        // multiplicative decrease
+        currentRate = std::max(minRate, currentRate * 3 / 4);
+    }
+    else
+    {
+        // additive increase
+        currentRate = std::min(maxRate, currentRate + std::max<uint64_t>(maxRate / 20, 1));
+    }
+
+    if (currentRate != previousRate)
+    {
+        spdlog::debug("Adaptive throttle: RTT {} us (base {} us), rate {} -> {} B/s",
+                      rtt.count(), baseRtt->count(), previousRate, currentRate);
+    }
+}
+
+uint64_t web::BandwidthThrottle::GetCurrentRate() const
+{
+    std::lock_guard guard(lock);
+    return currentRate;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+
+
+namespace web
+{
+    /**
+     * \brief Token-bucket rate limiter for the download write path.
+     *
+     * Received blocks are charged against the bucket; once it runs dry the writing thread is held
+     * back until enough tokens have been refilled, which in turn makes TCP flow control slow the
+     * sender down. One instance may be shared by several concurrent transfers to cap their sum.
+     *
+     * In adaptive mode the effective rate follows the connection's round-trip time: growing RTT
+     * means queues are building up somewhere (someone else is using the link), so the rate is cut
+     * multiplicatively; while the RTT stays near its observed minimum the rate recovers additively
+     * up to the configured limit.
+     */
+    class BandwidthThrottle
+    {
+        mutable std::mutex lock;
+
+        uint64_t maxRate;
+        uint64_t minRate;
+        uint64_t currentRate;
+        bool isAdaptive;
+
+        double tokens{0};
+        std::chrono::steady_clock::time_point lastRefill;
+
+        std::optional<std::chrono::microseconds> baseRtt{};
+        std::chrono::steady_clock::time_point lastRttSample{};
+
+        void Refill(std::chrono::steady_clock::time_point now);
+
+    public:
+        /** Queueing delay above the base RTT at which the adaptive mode backs off */
+        static constexpr std::chrono::milliseconds ADAPTIVE_DELAY_TARGET{60};
+        /** Minimum interval between two RTT samples */
+        static constexpr std::chrono::milliseconds ADAPTIVE_SAMPLE_INTERVAL{500};
+
+        /**
+         * \param bytesPerSecond The rate limit.
+         * \param adaptive True to additionally back off on growing round-trip times.
+         */
+        BandwidthThrottle(uint64_t bytesPerSecond, bool adaptive);
+
+        /**
+         * \brief Charges a received block and waits while the bucket is in debt.
+         * \return False if the wait got cancelled.
+         */
+        bool Consume(size_t bytes, const std::stop_token& stopToken);
+
+        /**
+         * \brief Samples the round-trip time of a transfer's connection, if due and supported.
+         *        No-op unless adaptive.
+         */
+        void SampleRtt(CURL* handle);
+
+        /**
+         * \brief Feeds a round-trip time measurement into the adaptive rate control.
+         */
+        void AddRttSample(std::chrono::microseconds rtt);
+
+        /** The rate currently enforced in bytes per second */
+        [[nodiscard]] uint64_t GetCurrentRate() const;
+    };
+}
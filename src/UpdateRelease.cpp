@@ -3,29 +3,43 @@
 #include "UpdateRelease.hpp"
 
 
-semver::version models::UpdateRelease::GetSemVersion() const
+namespace
 {
-    try
+    /**
+     * \brief Parses a manifest version string, tolerating whitespace and a leading "v".
+     * \param value The version string.
+     * \param what Describes the value in log messages.
+     */
+    std::optional<semver::version> TryParseVersion(const std::string& value, const std::string_view what)
     {
-        // trim whitespace, then strip a leading "v" prefix only
-        std::string value = util::trim(version);
-        if (!value.empty() && value.front() == 'v')
+        try
+        {
+            // trim whitespace, then strip a leading "v" prefix only
+            std::string trimmed = util::trim(value);
+            if (!trimmed.empty() && trimmed.front() == 'v')
+            {
+                trimmed.erase(trimmed.begin());
+            }
+            util::toSemVerCompatible(trimmed);
+
+            return semver::version::parse(trimmed);
+        }
+        catch (const std::exception& e)
         {
-            value.erase(value.begin());
+            spdlog::debug("Error parsing {} `{}`: {}", what, value, e.what());
+        }
+        catch (...)
+        {
+            spdlog::debug("Unknown exception parsing {} `{}`", what, value);
         }
-        util::toSemVerCompatible(value);
 
-        return semver::version::parse(value);
+        return std::nullopt;
     }
-    catch (const std::exception& e)
-    {
-        spdlog::debug("Error parsing update version `{}`: {}", version, e.what());
-    }
-    catch (...)
-    {
-        spdlog::debug("Unknown exception parsing update version `{}`", version);
-    }
-    return semver::version{0, 0, 0};
+}
+
+semver::version models::UpdateRelease::GetSemVersion() const
+{
+    return TryParseVersion(version, "update version").value_or(semver::version{0, 0, 0});
 }
 
 std::optional<semver::version> models::UpdateRelease::GetDetectionSemVersion() const
@@ -36,27 +50,16 @@ std::optional<semver::version> models::UpdateRelease::GetDetectionSemVersion() c
         return GetSemVersion();
     }
 
-    try
-    {
-        // trim whitespace, then strip a leading "v" prefix only
-        std::string value = util::trim(detectionVersion.value());
-        if (!value.empty() && value.front() == 'v')
-        {
-            value.erase(value.begin());
-        }
-        util::toSemVerCompatible(value);
+    // Fall back to the primary release version, consistent with the no-detectionVersion path.
+    return TryParseVersion(detectionVersion.value(), "update detection version").value_or(GetSemVersion());
+}
 
-        return semver::version::parse(value);
-    }
-    catch (const std::exception& e)
-    {
-        spdlog::debug("Error parsing update detection version `{}`: {}", detectionVersion.value(), e.what());
-    }
-    catch (...)
+std::optional<semver::version> models::ReleasePatch::GetDetectionSemVersion() const
+{
+    if (!detectionVersion.has_value())
     {
-        spdlog::debug("Unknown exception parsing update detection version `{}`", detectionVersion.value());
+        return std::nullopt;
     }
 
-    // Fall back to the primary release version, consistent with the no-detectionVersion path.
-    return GetSemVersion();
+    return TryParseVersion(detectionVersion.value(), "patch detection version");
 }
@@ -27,8 +27,17 @@ namespace util
     int CompareVersions(const semver::version& a, const semver::version& b);
     void stripNulls(std::string& s);
     void stripNulls(std::wstring& s);
+
+    /**
+     * \brief Decodes a standard Base64 string into raw bytes.
+     * \param b64 The Base64-encoded input string; whitespace (e.g. line breaks) is skipped.
+     * \return Decoded bytes on success; unexpected error string on failure.
+     * \remarks Rejects inputs larger than 1 MiB as a safety guard against server-supplied data.
+     */
+    [[nodiscard]] std::expected<std::vector<uint8_t>, std::string> DecodeBase64(const std::string& b64);
 }
 
+#if defined(_WIN32)
 namespace winapi
 {
     std::expected<semver::version, std::string> GetWin32ResourceFileVersion(const std::filesystem::path& filePath);
@@ -57,12 +66,25 @@ namespace winapi
 
     [[nodiscard]] std::expected<std::string, std::string> GetNewTemporaryFile(_In_opt_ const std::string& parent = std::string());
 
+    /**
+     * \brief Checks whether only the current user, the Administrators group and SYSTEM can modify the
+     *        file or directory: one of them owns it and its DACL grants nobody else write access.
+     * \remarks Says nothing about the directories above, a caller has to check those as well.
+     */
+    [[nodiscard]] bool IsPrivateToCurrentUser(const std::filesystem::path& path);
+
     /**
      * \brief Attempts to retrieve the %ProgramData% directory.
      * \return The ProgramData path on success; unexpected error string on failure.
      */
     [[nodiscard]] std::expected<std::string, std::string> GetProgramDataPath();
 
+    /**
+     * \brief Attempts to retrieve the current user's %LOCALAPPDATA% directory.
+     * \return The LocalAppData path on success; unexpected error string on failure.
+     */
+    [[nodiscard]] std::expected<std::string, std::string> GetLocalAppDataPath();
+
     /**
      * \brief Queries for the current monitor DPI value.
      * \param hWnd Window handle.
@@ -121,14 +143,6 @@ namespace winapi
      */
     void InvalidateAccentColorCache();
 
-    /**
-     * \brief Decodes a standard Base64 string into raw bytes using CryptStringToBinaryA.
-     * \param b64 The Base64-encoded input string.
-     * \return Decoded bytes on success; unexpected error string on failure.
-     * \remarks Rejects inputs larger than 1 MiB as a safety guard against server-supplied data.
-     */
-    [[nodiscard]] std::expected<std::vector<uint8_t>, std::string> DecodeBase64(const std::string& b64);
-
     /**
      * \brief Creates an HICON from an in-memory Windows .ico buffer.
      *
@@ -144,3 +158,4 @@ namespace winapi
      */
     [[nodiscard]] std::expected<HICON, std::string> CreateIconFromIcoBuffer(const std::vector<uint8_t>& ico, int cx, int cy);
 }
+#endif
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Common.h"
 #include "Util.h"
+#include "Http.h"
 #include "WizardPage.h"
 #include "InstanceConfig.hpp"
 #include "DownloadAndInstall.hpp"
@@ -66,7 +67,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
         NV_CLI_PARAM_OVERRIDE_OK,
         NV_CLI_PARAM_TERMINATE_PROCESS_BEFORE_UPDATE,
         NV_CLI_PARAM_LOCAL_VERSION,
-        NV_CLI_PARAM_FORCE_LOCAL_VERSION
+        NV_CLI_PARAM_FORCE_LOCAL_VERSION,
+        NV_CLI_PARAM_BACKGROUND_RATE_LIMIT
     });
 
 #if !defined(NDEBUG)
@@ -88,7 +90,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
     // entire application lifetime and is torn down after cfg (and every task it
     // owns) has been destroyed.
     curlpp::initialize();
-    const auto curlppGuard = sg::make_scope_guard([] { curlpp::terminate(); });
+    const auto curlppGuard = sg::make_scope_guard([]
+    {
+        // the shared connection/session caches must go before the global cleanup
+        web::TransferContext::Instance().Shutdown();
+        curlpp::terminate();
+    });
 
     // updater configuration, defaults and app state
     models::InstanceConfig cfg(hInstance, cmdl, &earlyAbortCode);
@@ -316,6 +323,16 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
 
 #pragma endregion
 
+#pragma region Prefetch
+
+    // fetch and verify the update before anyone is bothered, so confirming the prompt goes straight to setup
+    if (!cmdl[ {NV_CLI_SILENT_UPDATE} ] && cfg.IsPrefetchEnabled())
+    {
+        cfg.PrefetchRelease();
+    }
+
+#pragma endregion
+
 #pragma region Silent update
 
     if (cmdl[ {NV_CLI_SILENT_UPDATE} ])
@@ -325,9 +342,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
         std::stop_source silentStopSource;
 
         // Download: no progress reporting needed in headless mode
-        cfg.DownloadReleaseAsync(
-            cfg.GetSelectedReleaseId(),
-            [](void*, double, double, double, double) -> int { return CURLE_OK; });
+        cfg.DownloadReleaseAsync(cfg.GetSelectedReleaseId());
 
         cfg.WaitForDownloadToFinish();
 
@@ -739,8 +754,6 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
             {
                 static DWORD lastExitCode = 0;
                 static DWORD lastWin32Error = ERROR_SUCCESS;
-                static std::atomic<double> totalToDownload = 0;
-                static std::atomic<double> totalDownloaded = 0;
 
                 // use this state to reset everything since the user might retry on error
                 if (instStep == DownloadAndInstallStep::Begin)
@@ -748,12 +761,18 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
                     isBackDisabled = true;
                     isCancelDisabled = true;
 
-                    totalToDownload = 0;
-                    totalDownloaded = 0;
-
                     cfg.ResetReleaseDownloadState();
                     cfg.ResetSetupState();
                     cfg.ResetVerifyState();
+
+                    // already downloaded in the background; it's been on disk since it was verified,
+                    // so it is verified again right before setup runs
+                    if (cfg.TakePrefetchedRelease())
+                    {
+                        spdlog::info("Using prefetched release, advancing to verification step");
+                        lastExitCode = 0;
+                        instStep = DownloadAndInstallStep::Verifying;
+                    }
                 }
 
                 ImGui::Indent(leftBorderIndent);
@@ -774,23 +793,11 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
                      instStep == DownloadAndInstallStep::Downloading))
                 {
                     lastExitCode = 0;
-                    totalToDownload = 0;
-                    totalDownloaded = 0;
 
-                    // start download
+                    // start download; wakes up the message loop once the result is in
                     cfg.DownloadReleaseAsync(
                         cfg.GetSelectedReleaseId(),
-                        [](void* pData, double downloadTotal, double downloaded, double uploadTotal, double uploaded) -> int
-                        {
-                            UNREFERENCED_PARAMETER(pData);
-                            UNREFERENCED_PARAMETER(uploadTotal);
-                            UNREFERENCED_PARAMETER(uploaded);
-
-                            totalToDownload.store(downloadTotal, std::memory_order_relaxed);
-                            totalDownloaded.store(downloaded, std::memory_order_relaxed);
-
-                            return CURLE_OK;
-                        });
+                        [hwnd]() { ::PostMessageW(hwnd, WM_NULL, 0, 0); });
 
                     instStep = DownloadAndInstallStep::Downloading;
                 }
@@ -815,7 +822,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
                         instStep = DownloadAndInstallStep::DownloadFailed;
                     }
                     // result consumed — drop the completed future so subsequent frames
-                    // skip polling entirely instead of calling wait_for() on a ready future
+                    // don't report the same result again
                     cfg.ResetReleaseDownloadState();
                 }
 
@@ -824,9 +831,17 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
                     case DownloadAndInstallStep::Downloading:
 
                         {
-                            const double dlNow = totalDownloaded.load(std::memory_order_relaxed);
-                            const double dlTotal = totalToDownload.load(std::memory_order_relaxed);
-                            if (dlNow <= 0 || dlTotal <= 0)
+                            const auto progress = cfg.GetDownloadProgress();
+                            const double dlNow = static_cast<double>(progress.downloaded);
+                            const double dlTotal = static_cast<double>(progress.total);
+
+                            if (progress.phase == web::DownloadPhase::Patching)
+                            {
+                                ImGui::Text("Applying update patch...");
+                                ImGui::SetCursorPosY(ImGui::GetCursorPosY() + SCALED(5));
+                                ui::IndeterminateProgressBar(ImVec2(ImGui::GetContentRegionAvail().x - leftBorderIndent, 0.0f));
+                            }
+                            else if (progress.phase != web::DownloadPhase::Downloading || dlTotal <= 0)
                             {
                                 ImGui::Text("Starting download...");
                                 ImGui::SetCursorPosY(ImGui::GetCursorPosY() + SCALED(5));
@@ -834,9 +849,21 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine,
                             }
                             else
                             {
-                                ImGui::Text("Downloading (%.2f MB of %.2f MB)", dlNow / AS_MB, dlTotal / AS_MB);
+                                if (const auto eta = progress.GetEta(); eta.has_value())
+                                {
+                                    const auto minutes = std::chrono::duration_cast<std::chrono::minutes>(eta.value());
+                                    ImGui::Text("Downloading (%.2f MB of %.2f MB, %.2f MB/s, %lld:%02lld left)",
+                                                dlNow / AS_MB, dlTotal / AS_MB,
+                                                static_cast<double>(progress.bytesPerSecond) / AS_MB,
+                                                static_cast<long long>(minutes.count()),
+                                                static_cast<long long>((eta.value() - minutes).count()));
+                                }
+                                else
+                                {
+                                    ImGui::Text("Downloading (%.2f MB of %.2f MB)", dlNow / AS_MB, dlTotal / AS_MB);
+                                }
                                 ImGui::SetCursorPosY(ImGui::GetCursorPosY() + SCALED(5));
-                                ImGui::ProgressBar(static_cast<float>(dlNow / dlTotal),
+                                ImGui::ProgressBar(static_cast<float>(std::min(dlNow / dlTotal, 1.0)),
                                                    ImVec2(ImGui::GetContentRegionAvail().x - leftBorderIndent, 0.0f));
                             }
                         }
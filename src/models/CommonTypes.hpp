@@ -12,6 +12,8 @@ namespace models
         MD5,
         SHA1,
         SHA256,
+        BLAKE3,
+        XXH3_128,
         Invalid = -1
     };
 
@@ -22,6 +24,8 @@ namespace models
                                  {ca::MD5, magic_enum::enum_name(ca::MD5)},
                                  {ca::SHA1, magic_enum::enum_name(ca::SHA1)},
                                  {ca::SHA256, magic_enum::enum_name(ca::SHA256)},
+                                 {ca::BLAKE3, magic_enum::enum_name(ca::BLAKE3)},
+                                 {ca::XXH3_128, magic_enum::enum_name(ca::XXH3_128)},
                                  })
 
     /**
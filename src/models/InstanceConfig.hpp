@@ -1,6 +1,7 @@
 #pragma once
 #include <curl/curl.h>
 #include <atomic>
+#include <functional>
 #include <list>
 #include <string>
 
@@ -8,12 +9,18 @@
 #include "MergedConfig.hpp"
 #include "NAuthenticode.h"
 #include "../Util.h"
+#include "../Progress.h"
 
 using json = nlohmann::json;
 
 struct zip;
 typedef struct zip zip_t;
 
+namespace web
+{
+    class BandwidthThrottle;
+}
+
 namespace models
 {
     /**
@@ -80,6 +87,8 @@ namespace models
 
         /** The download task */
         std::optional<std::shared_future<std::expected<int, std::string>>> downloadTask;
+        /** Progress of the download task, published by its thread */
+        web::DownloadProgress downloadProgress;
         /** The setup task */
         std::optional<std::shared_future<std::expected<SetupResult, std::string>>> setupTask;
         /** The integrity-verification task */
@@ -90,6 +99,8 @@ namespace models
         std::string lastDownloadError{};
         /** True if the current download should abort ASAP */
         std::atomic_bool abortDownloadRequested{false};
+        /** Signalled together with abortDownloadRequested, wakes up waits between download attempts */
+        std::stop_source downloadStopSource{};
         /** True if we run in any of the silent scenarios, false if not */
         bool isSilent{false};
         /** True if user chose to ignore postpone period */
@@ -104,6 +115,14 @@ namespace models
         int overriddenSuccessCode{ERROR_SUCCESS};
         /** True if --strict-verification was passed or enabled via config */
         bool strictVerification{false};
+        /** The value supplied by NV_CLI_PARAM_BACKGROUND_RATE_LIMIT, overrides the configured one */
+        std::optional<uint64_t> cliBackgroundRateLimit{};
+        /** True if NV_CLI_BACKGROUND_RATE_ADAPTIVE was specified */
+        bool cliBackgroundRateAdaptive{false};
+        /** True if NV_CLI_PREFETCH was specified */
+        bool cliPrefetch{false};
+        /** True while the release temp file holds a payload PrefetchRelease downloaded and verified */
+        bool isReleasePrefetched{false};
 
         /** WinTrust result for the updater exe itself (populated at startup) */
         NSIGINFO appSigInfo{};
@@ -117,17 +136,225 @@ namespace models
         /** Custom window/taskbar icon (small), created from merged.iconBase64; freed in dtor */
         HICON customIconSmall{};
 
-        std::expected<int, std::string> DownloadRelease(curl_progress_callback progressFn, int releaseIndex);
+        std::expected<int, std::string> DownloadRelease(int releaseIndex);
+
+        /**
+         * \brief Creates the bandwidth limiter for the release download, if one applies.
+         * \return The throttle or nullptr if not running unattended or no limit is configured.
+         */
+        [[nodiscard]] std::unique_ptr<web::BandwidthThrottle> CreateDownloadThrottle() const;
+
+        /**
+         * \brief Downloads the selected release over parallel byte-range segments, if the server supports it.
+         * \param userAgent The user agent to send.
+         * \param attachmentName Receives the server-supplied file name, if any.
+         * \param throttle Limits the combined rate of all segments, may be nullptr.
+         * \return True on success, false if segmenting isn't applicable (nothing was downloaded) or an error
+         *         message if the segmented transfer failed.
+         */
+        std::expected<bool, std::string> DownloadReleaseSegmented(const std::string& userAgent,
+                                                                  std::optional<std::filesystem::path>& attachmentName,
+                                                                  web::BandwidthThrottle* throttle);
+
+        /**
+         * \brief Picks the patch of the selected release matching the installed product file.
+         * \param basePath Receives the installed file the patch applies to.
+         * \return The patch or std::nullopt if none applies or the detection method has no file to patch.
+         */
+        std::optional<ReleasePatch> FindApplicablePatch(std::filesystem::path& basePath) const;
+
+        /**
+         * \brief Reconstructs the selected release from a binary patch against the installed product file.
+         * \param userAgent The user agent to send.
+         * \param throttle Limits the patch download rate, may be nullptr.
+         * \return True on success, false if no patch applies (nothing was downloaded) or an error message
+         *         if the patch couldn't be downloaded or didn't reproduce the release checksum.
+         */
+        std::expected<bool, std::string> DownloadReleasePatch(const std::string& userAgent,
+                                                              web::BandwidthThrottle* throttle);
+
+        /**
+         * \brief Fetches chunks of the selected release again and writes them over the release temp file.
+         * \param verifier Provides the chunk layout and digests.
+         * \param chunks The indexes of the chunks to repair.
+         * \param userAgent The user agent to send.
+         * \return Empty on success or an error message if any chunk couldn't be repaired.
+         */
+        std::expected<void, std::string> RepairCorruptChunks(const hashing::ChunkVerifier& verifier,
+                                                             const std::vector<size_t>& chunks,
+                                                             const std::string& userAgent);
+
+        /**
+         * \brief Fetches the selected release from the machine-wide download cache, if present.
+         * \return True if the release temp file now holds a payload matching the release checksum.
+         */
+        bool TryRestoreFromDownloadCache();
+
+        /**
+         * \brief Offers the verified release payload to the machine-wide download cache.
+         */
+        void AddToDownloadCache(const std::filesystem::path& filePath);
 
         [[nodiscard]] std::list<std::string> BuildCommonHeaders() const;
 
+        /**
+         * \brief A manifest fetched, verified and parsed from one of the candidate URLs.
+         */
+        struct ManifestCandidate
+        {
+            json reply;
+            UpdateResponse response;
+        };
+
+        /**
+         * \brief Failure details of fetching the manifest from one of the candidate URLs.
+         */
+        struct ManifestFetchError
+        {
+            std::string message;
+            /** True if the failure must not be papered over by another candidate (e.g. a tampered manifest) */
+            bool isFatal{false};
+        };
+
+        /**
+         * \brief Fetches, verifies and parses the manifest from a single URL, retrying transient failures.
+         * \param requestUrl The manifest URL.
+         * \param userAgent The user agent to send.
+         * \param stopToken Aborts the transfer and any pending retry when stop is requested.
+         * \return The parsed manifest or the failure details.
+         */
+        [[nodiscard]] std::expected<ManifestCandidate, ManifestFetchError> FetchManifest(
+            const std::string& requestUrl,
+            const std::string& userAgent,
+            const std::stop_token& stopToken) const;
+
+        /**
+         * \brief A previously fetched and verified manifest, persisted along with its HTTP validators.
+         */
+        struct CachedManifest
+        {
+            /** The raw manifest bytes */
+            std::string body;
+            /** The raw .minisig the body was verified against (only with NV_MANIFEST_PUBLIC_KEY) */
+            std::string signature;
+            /** The ETag response header value, if any */
+            std::string etag;
+            /** The Last-Modified response header value, if any */
+            std::string lastModified;
+            /** The Content-Type response header value, tells the wire format of body */
+            std::string contentType;
+            /** The result of parsing body, absent if it has to be parsed again (e.g. by another updater version) */
+            std::optional<ManifestCandidate> parsed;
+        };
+
+        /**
+         * \brief Gets the per-tenant, per-user data directory under %LOCALAPPDATA%.
+         * \return The path or an empty path if the location couldn't be resolved.
+         */
+        [[nodiscard]] std::filesystem::path GetLocalDataDirectory() const;
+
+        /**
+         * \brief Gets the per-tenant base path (without extension) of the cached manifest of a URL.
+         * \return The path or an empty path if the location couldn't be resolved.
+         */
+        [[nodiscard]] std::filesystem::path GetManifestCachePath(const std::string& requestUrl) const;
+
+        /**
+         * \brief Loads the cached manifest of a URL, if a complete entry with validators exists and it's
+         *        authenticated by the per-user cache key, i.e. wasn't altered since it was stored.
+         */
+        [[nodiscard]] std::optional<CachedManifest> LoadCachedManifest(const std::string& requestUrl) const;
+
+        /**
+         * \brief Persists a verified manifest along with its parse result, authenticated with the per-user
+         *        cache key; entries without any validators are purged instead.
+         */
+        void StoreCachedManifest(const std::string& requestUrl, const CachedManifest& entry) const;
+
+        /**
+         * \brief Deletes the cached manifest of a URL, if any.
+         */
+        void PurgeCachedManifest(const std::string& requestUrl) const;
+
+        /**
+         * \brief Progress of an unfinished release download, persisted so a later run can continue it.
+         */
+        struct ResumeJournal
+        {
+            /** The release download URL */
+            std::string url;
+            /** The partially downloaded file */
+            std::filesystem::path tempFile;
+            /** The ETag of the response the partial file stems from, if any */
+            std::string etag;
+            /** The Last-Modified of the response the partial file stems from, if any */
+            std::string lastModified;
+            /** Number of leading bytes of tempFile written when the journal was stored */
+            uint64_t bytesCommitted{0};
+            /** The Content-Disposition file name, if the server sent one */
+            std::string attachmentName;
+            /** The algorithm of hashState */
+            ChecksumAlgorithm hashAlgorithm{ChecksumAlgorithm::Invalid};
+            /** The payload digest state covering bytesCommitted, empty if not available */
+            std::string hashState;
+            /** The digest hashState produces, detects states not restorable by this build */
+            std::string hashDigest;
+        };
+
+        /**
+         * \brief Gets the path of the resume journal of a download URL.
+         * \return The path or an empty path if the location couldn't be resolved.
+         */
+        [[nodiscard]] std::filesystem::path GetResumeJournalPath(const std::string& downloadUrl) const;
+
+        /**
+         * \brief Loads the resume journal of a download URL, if its partial file still exists.
+         */
+        [[nodiscard]] std::optional<ResumeJournal> LoadResumeJournal(const std::string& downloadUrl) const;
+
+        /**
+         * \brief Persists the progress of a release download.
+         */
+        void StoreResumeJournal(const ResumeJournal& journal) const;
+
+        /**
+         * \brief Deletes the resume journal of a download URL, if any.
+         */
+        void PurgeResumeJournal(const std::string& downloadUrl) const;
+
+        /**
+         * \brief Deletes journals (and their partial files) not updated within RESUME_JOURNAL_MAX_AGE,
+         *        e.g. of releases superseded before they finished downloading.
+         * \param keepUrl The download URL whose journal is kept regardless of its age.
+         */
+        void PurgeStaleResumeJournals(const std::string& keepUrl) const;
+
+        /**
+         * \brief Gets the path of the per-tenant detection checksum cache.
+         * \return The path or an empty path if the location couldn't be resolved.
+         */
+        [[nodiscard]] std::filesystem::path GetDetectionCachePath() const;
+
+        /**
+         * \brief Gets the digest of a file for FileChecksum detection, reusing the cached digest if the
+         *        file is provably unchanged since it was last hashed and caching a fresh one otherwise.
+         * \return The lower-case hex digest or an error message if the file couldn't be read.
+         */
+        [[nodiscard]] std::expected<std::string, std::string> GetDetectionChecksum(
+            const std::filesystem::path& filePath, ChecksumAlgorithm algorithm) const;
+
         std::expected<SetupResult, std::string> ExecuteSetup(const std::stop_token&);
 
     public:
         static constexpr int MAX_TIMEOUT_SECS = 180; // 3 minutes
         static constexpr int MAX_TIMEOUT_SECS_TOTAL = 3600; // 1 hour
         static constexpr int MAX_RETRY_COUNT = 10;
+        static constexpr int MAX_MANIFEST_RETRY_SECS_TOTAL = 600; // 10 minutes
         static constexpr int MAX_REDIRECTS = 5;
+        static constexpr uint64_t MAX_REPAIR_CHUNK_SIZE = 64ULL * 1024 * 1024; // 64 MiB
+        static constexpr uint64_t RESUME_JOURNAL_INTERVAL = 16ULL * 1024 * 1024; // 16 MiB
+        static constexpr std::chrono::hours RESUME_JOURNAL_MAX_AGE{24 * 14}; // 2 weeks
+        static constexpr size_t DETECTION_CACHE_MAX_ENTRIES = 16;
 
         std::string serverUrlTemplate;
         std::optional<std::vector<std::string>> fallbackServerUrlTemplates;
@@ -252,11 +479,12 @@ namespace models
         _Must_inspect_result_ [[nodiscard]] bool HasMultipleReleases() const { return remote.releases.size() > 1; }
 
         /**
-         * \brief Starts the update release download.
+         * \brief Starts the update release download, its progress is available via GetDownloadProgress.
          * \param releaseIndex Zero-based release index.
-         * \param progressFn The download progress callback.
+         * \param onCompleted Invoked on the download thread once the result is available, e.g. to wake
+         *                    up a waiting message loop. Must not call back into the download functions.
          */
-        bool DownloadReleaseAsync(int releaseIndex, curl_progress_callback progressFn);
+        bool DownloadReleaseAsync(int releaseIndex, std::function<void()> onCompleted = {});
 
 
         /**
@@ -284,6 +512,11 @@ namespace models
          */
         [[nodiscard]] std::optional<DownloadStatus> GetReleaseDownloadStatus() const;
 
+        /**
+         * \brief Lock-free snapshot of the running (or last) download's progress, cheap enough for every frame.
+         */
+        [[nodiscard]] web::ProgressSnapshot GetDownloadProgress() const { return downloadProgress.GetSnapshot(); }
+
         /**
          * \brief Reset the download async task state.
          */
@@ -299,6 +532,27 @@ namespace models
          */
         void WaitForDownloadToFinish();
 
+        /**
+         * \brief Checks whether the release should be fetched before the user is prompted.
+         * \return True if running unattended and prefetching is enabled via config or NV_CLI_PREFETCH.
+         */
+        [[nodiscard]] bool IsPrefetchEnabled() const;
+
+        /**
+         * \brief Downloads and verifies the selected release, blocking until done.
+         * \return True if the verified payload is ready for setup, false otherwise (a partial download
+         *         is kept for resuming).
+         */
+        bool PrefetchRelease();
+
+        /**
+         * \brief Claims the payload of a successful PrefetchRelease, so setup can run without downloading.
+         * \return True once if the prefetched payload is still on disk, false otherwise.
+         * \remarks The payload must be verified again before setup runs; its digest is discarded, so
+         *          VerifyReleaseIntegrity reads the file from disk.
+         */
+        [[nodiscard]] bool TakePrefetchedRelease();
+
         /**
          * \brief Checks the version of the installed product against the latest available release.
          * \return True (outdated) or false (up-to-date) on success; unexpected error string on failure.
@@ -517,6 +771,7 @@ namespace models
          * \remarks Called between DownloadSucceeded and PrepareInstall in the UI state machine.
          *          Checksum: if present in the release it MUST match; absent = allowed in Relaxed, rejected in strict mode.
          *          Signature: governed by merged.signatureVerificationMode (WhenPresent / Required).
+         *          A payload passing both is added to the machine-wide download cache.
          */
         [[nodiscard]] std::expected<void, std::string> VerifyReleaseIntegrity();
 
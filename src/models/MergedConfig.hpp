@@ -41,6 +41,12 @@ namespace models
         bool hideRemindButton{false};
         /** Base64-encoded Windows .ico data for the window and taskbar icon */
         std::optional<std::string> iconBase64;
+        /** Download rate limit in bytes per second for unattended runs, 0 for unlimited */
+        uint64_t backgroundDownloadRateLimit{0};
+        /** True to also back off the unattended download rate when the network gets congested */
+        bool backgroundDownloadAdaptive{false};
+        /** True to download and verify the release in unattended runs before the user is prompted */
+        bool prefetchRelease{false};
 
         MergedConfig() : windowTitle(NV_WINDOW_TITLE), productName(NV_PRODUCT_NAME) { }
 
@@ -70,5 +76,8 @@ namespace models
                                                     signatureStrategy,
                                                     signatureConfig,
                                                     hideRemindButton,
-                                                    iconBase64)
+                                                    iconBase64,
+                                                    backgroundDownloadRateLimit,
+                                                    backgroundDownloadAdaptive,
+                                                    prefetchRelease)
 }
@@ -41,6 +41,12 @@ namespace models
         std::optional<bool> hideRemindButton;
         /** Base64-encoded Windows .ico data for the window and taskbar icon */
         std::optional<std::string> iconBase64;
+        /** Download rate limit in bytes per second for unattended runs, 0 for unlimited */
+        std::optional<uint64_t> backgroundDownloadRateLimit;
+        /** True to also back off the unattended download rate when the network gets congested */
+        std::optional<bool> backgroundDownloadAdaptive;
+        /** True to download and verify the release in unattended runs before the user is prompted */
+        std::optional<bool> prefetchRelease;
     };
 
     NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(SharedConfig,
@@ -56,5 +62,8 @@ namespace models
                                                     signatureStrategy,
                                                     signatureConfig,
                                                     hideRemindButton,
-                                                    iconBase64)
+                                                    iconBase64,
+                                                    backgroundDownloadRateLimit,
+                                                    backgroundDownloadAdaptive,
+                                                    prefetchRelease)
 }
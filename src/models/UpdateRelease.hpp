@@ -1,8 +1,9 @@
 #pragma once
 
 #include "CommonTypes.hpp"
-#include "SignatureValidation.hpp"
 #include "../ADL.hpp"
+#include "SignatureValidation.hpp"
+#include "../Hashing.h"
 
 namespace models
 {
@@ -30,9 +31,27 @@ namespace models
         std::string checksum;
         /** The checksum algorithm */
         ChecksumAlgorithm checksumAlg;
+        /** Size in bytes of the chunks chunkHashes refers to */
+        std::optional<uint64_t> chunkSize;
+        /** Digests (using checksumAlg) of the consecutive chunkSize blocks of the file, the last may be shorter */
+        std::optional<std::vector<std::string>> chunkHashes;
+
+        /**
+         * \brief Creates a verifier for the chunk digests.
+         * \return The verifier, disabled if no chunk digests are provided.
+         */
+        hashing::ChunkVerifier CreateChunkVerifier() const
+        {
+            if (!chunkSize.has_value() || !chunkHashes.has_value())
+            {
+                return {};
+            }
+
+            return {checksumAlg, chunkSize.value(), chunkHashes.value()};
+        }
     };
 
-    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ChecksumParameters, checksum, checksumAlg)
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ChecksumParameters, checksum, checksumAlg, chunkSize, chunkHashes)
 
     /**
      * \brief How to treat files when installing a .zip file
@@ -52,6 +71,34 @@ namespace models
                                  {zefd::DeleteIfPresent, magic_enum::enum_name(zefd::DeleteIfPresent)}
                                  })
 
+    /**
+     * \brief A binary delta reconstructing a release's setup from the installed product file.
+     */
+    class ReleasePatch
+    {
+    public:
+        /** URL of the patch, created with zstd --patch-from against the installed file */
+        std::string downloadUrl;
+        /** Size of the patch in bytes */
+        std::optional<size_t> downloadSize;
+        /** The installed file version this patch applies to */
+        std::optional<std::string> detectionVersion;
+        /** The installed file hash this patch applies to, preferred over detectionVersion */
+        std::optional<ChecksumParameters> detectionChecksum;
+
+        /**
+         * \brief Gets the detection version, if provided and valid.
+         * \return The parsed version.
+         */
+        std::optional<semver::version> GetDetectionSemVersion() const;
+    };
+
+    NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ReleasePatch,
+                                                    downloadUrl,
+                                                    downloadSize,
+                                                    detectionVersion,
+                                                    detectionChecksum)
+
     /**
      * \brief Represents an update release.
      */
@@ -101,9 +148,13 @@ namespace models
         std::optional<std::unordered_map<std::string, ZipExtractFileDisposition>> zipExtractFileDispositionOverrides;
         /** If true, the downloaded setup is launched elevated (As Administrator) via the "runas" verb */
         std::optional<bool> runAsAdmin;
+        /** Binary deltas to try instead of the full download, requires checksum */
+        std::optional<std::vector<ReleasePatch>> patches;
 
         /** Full pathname of the local temporary file */
         std::filesystem::path localTempFilePath{};
+        /** Running digest of the bytes written to localTempFilePath, fed while downloading */
+        hashing::IncrementalHasher payloadHasher{};
 
 
         /**
@@ -138,5 +189,6 @@ namespace models
                                                     detectionVersion,
                                                     zipExtractDefaultFileDisposition,
                                                     zipExtractFileDispositionOverrides,
-                                                    runAsAdmin)
+                                                    runAsAdmin,
+                                                    patches)
 }
@@ -1,5 +1,11 @@
 #pragma once
 
+//
+// The Windows-only parts are left out of other platforms, where just the portable core
+// (hashing, manifest parsing, retries, transfers) is built for the benchmarks
+//
+#if defined(_WIN32)
+
 //
 // WinAPI
 //
@@ -30,13 +36,17 @@
 #include "imgui_impl_win32.h"
 #include "imgui_impl_dx11.h"
 
+#endif
+
 //
 // Utility packages
 //
 #include "argh.h"
 #include <semver/semver.hpp>
 #include <magic_enum/magic_enum.hpp>
+#if defined(_WIN32)
 #include <winreg/WinReg.hpp>
+#endif
 #include <hash-library/md5.h>
 #include <hash-library/sha1.h>
 #include <hash-library/sha256.h>
@@ -48,7 +58,9 @@
 // Logging
 //
 #include <spdlog/spdlog.h>
+#if defined(_WIN32)
 #include <spdlog/sinks/msvc_sink.h>
+#endif
 #include <spdlog/sinks/basic_file_sink.h>
 
 //
@@ -69,25 +81,33 @@
 #include <variant>
 #include <format>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stop_token>
 
+#if defined(_WIN32)
 //
 // neflib
 // 
 #include <nefarius/neflib/MiscWinApi.hpp>
+#endif
 
 //
 // Custom
 //
-#include "UniUtil.h"
 #include "resource.h"
 #include "CustomizeMe.h"
+#if defined(_WIN32)
+#include "UniUtil.h"
 #include "Crypto.h"
 #include "UI.h"
+#endif
 #include "Formatters.h"
 
 //
 // Manifest signing (libsodium, only when a public key is compiled in)
 //
-#if defined(NV_MANIFEST_PUBLIC_KEY)
+#if defined(NV_MANIFEST_PUBLIC_KEY) || defined(NV_MINISIGN_SUPPORT)
 #include <sodium.h>
 #endif
@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "Util.h"
+
+#include <array>
+
+//
+// The helpers of util.cpp that don't depend on platform APIs, kept apart so the
+// portable core (and the benchmarks) can be built without the Windows-only code
+//
+
+namespace
+{
+    constexpr int8_t BASE64_INVALID = -1;
+    constexpr int8_t BASE64_PADDING = -2;
+    constexpr int8_t BASE64_WHITESPACE = -3;
+
+    constexpr auto BASE64_DECODE_TABLE = []
+    {
+        std::array<int8_t, 256> table{};
+        table.fill(BASE64_INVALID);
+
+        constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (size_t i = 0; i < alphabet.size(); i++)
+        {
+            table[ static_cast<unsigned char>(alphabet[ i ]) ] = static_cast<int8_t>(i);
+        }
+
+        table[ '=' ] = BASE64_PADDING;
+        for (const char c : {' ', '\t', '\r', '\n'})
+        {
+            table[ static_cast<unsigned char>(c) ] = BASE64_WHITESPACE;
+        }
+
+        return table;
+    }();
+}
+
+namespace util
+{
+    int CompareVersions(const semver::version& a, const semver::version& b)
+    {
+        // Major/minor/patch and prerelease follow standard SemVer precedence.
+        if (a < b) return -1;
+        if (b < a) return 1;
+
+        // Equal so far: break the tie on the numeric build metadata, which is where
+        // toSemVerCompatible() parks the optional 4th ("revision") version segment.
+        const auto numericBuildMeta = [](const semver::version& v) -> uint64_t
+        {
+            const std::string& meta = v.build_meta();
+            if (meta.empty() || !std::ranges::all_of(meta, [](unsigned char c) { return std::isdigit(c) != 0; }))
+            {
+                return 0; // absent or non-numeric build metadata counts as revision 0
+            }
+            try { return std::stoull(meta); }
+            catch (...) { return 0; }
+        };
+
+        const uint64_t ra = numericBuildMeta(a);
+        const uint64_t rb = numericBuildMeta(b);
+        if (ra < rb) return -1;
+        if (ra > rb) return 1;
+        return 0;
+    }
+
+    std::string trim(const std::string& str, const std::string& whitespace)
+    {
+        const auto strBegin = str.find_first_not_of(whitespace);
+        if (strBegin == std::string::npos) return "";  // no content
+
+        const auto strEnd = str.find_last_not_of(whitespace);
+        const auto strRange = strEnd - strBegin + 1;
+
+        return str.substr(strBegin, strRange);
+    }
+
+    bool icompare_pred(unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); }
+
+    bool icompare(const std::string& a, const std::string& b)
+    {
+        if (a.length() == b.length())
+        {
+            return std::equal(b.begin(), b.end(), a.begin(), icompare_pred);
+        }
+        return false;
+    }
+
+    void toCamelCase(std::string& s)
+    {
+        char previous = ' ';
+        auto f = [ & ](char current)
+        {
+            const char result = (std::isblank(previous) && std::isupper(current)) ? std::tolower(current) : current;
+            previous = current;
+            return result;
+        };
+        std::ranges::transform(s, s.begin(), f);
+    }
+
+    void toSemVerCompatible(std::string& s)
+    {
+        const auto notSemver = s;
+        // v1.2.3 -> 1.2.3
+        if (s.starts_with("v"))
+        {
+            s.erase(s.begin());
+        }
+        // for 4 digit version we gonna cheat and convert it to a valid semantic version
+        if (std::ranges::count_if(s, [](char c) { return c == '.'; }) > 2)
+        {
+            s = std::regex_replace(s, std::regex(R"((\d*)\.(\d*)\.(\d*)\.(\d*))"), "$1.$2.$3+$4");
+        }
+        // Convert traditional non-semver RC/alphas/betas to semver, e.g. `1.0.0-rc1` -> `1.0.0-rc.1`
+        s = std::regex_replace(s, std::regex(R"(([a-zA-Z_]+)(\d+))"), "$1.$2");
+        // Leading zeroes (e.g. in dates like 2024.08.28) aren't valid in semver
+        s = std::regex_replace(s, std::regex(R"(\b0*(\d+))"), "$1");
+
+        spdlog::debug("raw version `{}` -> semver string `{}`", notSemver, s);
+    }
+
+    void stripNulls(std::string& s) { s.erase(std::ranges::find(s, '\0'), s.end()); }
+
+    void stripNulls(std::wstring& s) { s.erase(std::ranges::find(s, L'\0'), s.end()); }
+
+    std::expected<std::vector<uint8_t>, std::string> DecodeBase64(const std::string& b64)
+    {
+        constexpr size_t maxInputBytes = 1u * 1024u * 1024u; // 1 MiB guard
+        if (b64.size() > maxInputBytes)
+            return std::unexpected("Base64 input exceeds 1 MiB limit");
+
+        if (b64.empty())
+            return std::unexpected("Base64 input is empty");
+
+        std::vector<uint8_t> out;
+        out.reserve(b64.size() / 4 * 3);
+
+        // single pass, four characters at a time become three bytes
+        uint32_t quantum = 0;
+        int sextets = 0;
+        int padding = 0;
+
+        for (size_t offset = 0; offset < b64.size(); offset++)
+        {
+            const int8_t value = BASE64_DECODE_TABLE[ static_cast<unsigned char>(b64[ offset ]) ];
+
+            if (value >= 0)
+            {
+                if (padding > 0)
+                    return std::unexpected(std::format("Base64 data continues after padding at offset {}", offset));
+
+                quantum = (quantum << 6) | static_cast<uint32_t>(value);
+                if (++sextets == 4)
+                {
+                    out.push_back(static_cast<uint8_t>(quantum >> 16));
+                    out.push_back(static_cast<uint8_t>(quantum >> 8));
+                    out.push_back(static_cast<uint8_t>(quantum));
+                    quantum = 0;
+                    sextets = 0;
+                }
+            }
+            else if (value == BASE64_PADDING)
+            {
+                padding++;
+            }
+            else if (value == BASE64_INVALID)
+            {
+                return std::unexpected(std::format("Invalid Base64 character at offset {}", offset));
+            }
+        }
+
+        // a final partial quantum carries one or two bytes, with or without its padding
+        switch (sextets)
+        {
+        case 0:
+            if (padding != 0)
+                return std::unexpected("Base64 input has misplaced padding");
+            break;
+        case 2:
+            if (padding != 0 && padding != 2)
+                return std::unexpected("Base64 input has misplaced padding");
+            out.push_back(static_cast<uint8_t>(quantum >> 4));
+            break;
+        case 3:
+            if (padding > 1)
+                return std::unexpected("Base64 input has misplaced padding");
+            out.push_back(static_cast<uint8_t>(quantum >> 10));
+            out.push_back(static_cast<uint8_t>(quantum >> 2));
+            break;
+        default:
+            return std::unexpected("Base64 input is truncated");
+        }
+
+        if (out.empty())
+            return std::unexpected("Base64 input contains no data");
+
+        return out;
+    }
+}
@@ -5,6 +5,7 @@
 #include <Shlobj.h>
 #include <Msi.h>
 #include <tlhelp32.h>
+#include <AclAPI.h>
 
 
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
@@ -67,32 +68,6 @@ namespace util
         return semver::version::parse(normalized);
     }
 
-    int CompareVersions(const semver::version& a, const semver::version& b)
-    {
-        // Major/minor/patch and prerelease follow standard SemVer precedence.
-        if (a < b) return -1;
-        if (b < a) return 1;
-
-        // Equal so far: break the tie on the numeric build metadata, which is where
-        // toSemVerCompatible() parks the optional 4th ("revision") version segment.
-        const auto numericBuildMeta = [](const semver::version& v) -> uint64_t
-        {
-            const std::string& meta = v.build_meta();
-            if (meta.empty() || !std::ranges::all_of(meta, [](unsigned char c) { return std::isdigit(c) != 0; }))
-            {
-                return 0; // absent or non-numeric build metadata counts as revision 0
-            }
-            try { return std::stoull(meta); }
-            catch (...) { return 0; }
-        };
-
-        const uint64_t ra = numericBuildMeta(a);
-        const uint64_t rb = numericBuildMeta(b);
-        if (ra < rb) return -1;
-        if (ra > rb) return 1;
-        return 0;
-    }
-
     std::expected<void, std::string> ParseCommandLineArguments(argh::parser& cmdl)
     {
         int nArgs;
@@ -126,65 +101,6 @@ namespace util
 
         return {};
     }
-
-    std::string trim(const std::string& str, const std::string& whitespace)
-    {
-        const auto strBegin = str.find_first_not_of(whitespace);
-        if (strBegin == std::string::npos) return "";  // no content
-
-        const auto strEnd = str.find_last_not_of(whitespace);
-        const auto strRange = strEnd - strBegin + 1;
-
-        return str.substr(strBegin, strRange);
-    }
-
-    bool icompare_pred(unsigned char a, unsigned char b) { return std::tolower(a) == std::tolower(b); }
-
-    bool icompare(const std::string& a, const std::string& b)
-    {
-        if (a.length() == b.length())
-        {
-            return std::equal(b.begin(), b.end(), a.begin(), icompare_pred);
-        }
-        return false;
-    }
-
-    void toCamelCase(std::string& s)
-    {
-        char previous = ' ';
-        auto f = [ & ](char current)
-        {
-            const char result = (std::isblank(previous) && std::isupper(current)) ? std::tolower(current) : current;
-            previous = current;
-            return result;
-        };
-        std::ranges::transform(s, s.begin(), f);
-    }
-
-    void toSemVerCompatible(std::string& s)
-    {
-        const auto notSemver = s;
-        // v1.2.3 -> 1.2.3
-        if (s.starts_with("v"))
-        {
-            s.erase(s.begin());
-        }
-        // for 4 digit version we gonna cheat and convert it to a valid semantic version
-        if (std::ranges::count_if(s, [](char c) { return c == '.'; }) > 2)
-        {
-            s = std::regex_replace(s, std::regex(R"((\d*)\.(\d*)\.(\d*)\.(\d*))"), "$1.$2.$3+$4");
-        }
-        // Convert traditional non-semver RC/alphas/betas to semver, e.g. `1.0.0-rc1` -> `1.0.0-rc.1`
-        s = std::regex_replace(s, std::regex(R"(([a-zA-Z_]+)(\d+))"), "$1.$2");
-        // Leading zeroes (e.g. in dates like 2024.08.28) aren't valid in semver
-        s = std::regex_replace(s, std::regex(R"(\b0*(\d+))"), "$1");
-
-        spdlog::debug("raw version `{}` -> semver string `{}`", notSemver, s);
-    }
-
-    void stripNulls(std::string& s) { s.erase(std::ranges::find(s, '\0'), s.end()); }
-
-    void stripNulls(std::wstring& s) { s.erase(std::ranges::find(s, L'\0'), s.end()); }
 }
 
 namespace winapi
@@ -531,6 +447,89 @@ namespace winapi
         return tempFile;
     }
 
+    bool IsPrivateToCurrentUser(const std::filesystem::path& path)
+    {
+        PSID owner = nullptr;
+        PACL dacl = nullptr;
+        PSECURITY_DESCRIPTOR descriptor = nullptr;
+
+        if (GetNamedSecurityInfoW(path.c_str(), SE_FILE_OBJECT,
+                                  OWNER_SECURITY_INFORMATION | DACL_SECURITY_INFORMATION, &owner, nullptr,
+                                  &dacl, nullptr, &descriptor) != ERROR_SUCCESS)
+        {
+            return false;
+        }
+        const auto descriptorGuard = sg::make_scope_guard([descriptor]() noexcept { LocalFree(descriptor); });
+
+        // a NULL DACL grants everyone full access
+        if (dacl == nullptr)
+        {
+            return false;
+        }
+
+        HANDLE token = nullptr;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+        {
+            return false;
+        }
+        const auto tokenGuard = sg::make_scope_guard([token]() noexcept { CloseHandle(token); });
+
+        DWORD size = 0;
+        GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+        std::vector<BYTE> buffer(size);
+
+        if (size == 0 || !GetTokenInformation(token, TokenUser, buffer.data(), size, &size))
+        {
+            return false;
+        }
+        const PSID user = reinterpret_cast<const TOKEN_USER*>(buffer.data())->User.Sid;
+
+        const auto isTrusted = [user](const PSID sid)
+        {
+            return EqualSid(sid, user) || IsWellKnownSid(sid, WinBuiltinAdministratorsSid) ||
+                IsWellKnownSid(sid, WinLocalSystemSid);
+        };
+
+        // the owner can always rewrite the DACL
+        if (!isTrusted(owner))
+        {
+            return false;
+        }
+
+        constexpr ACCESS_MASK modifyingAccess = FILE_WRITE_DATA | FILE_APPEND_DATA | FILE_WRITE_EA |
+            FILE_WRITE_ATTRIBUTES | FILE_DELETE_CHILD | DELETE | WRITE_DAC | WRITE_OWNER | GENERIC_WRITE |
+            GENERIC_ALL | MAXIMUM_ALLOWED;
+
+        for (DWORD i = 0; i < dacl->AceCount; i++)
+        {
+            PACE_HEADER header = nullptr;
+            if (!GetAce(dacl, i, reinterpret_cast<LPVOID*>(&header)))
+            {
+                return false;
+            }
+
+            // only inherited by children, doesn't apply to the object itself
+            if ((header->AceFlags & INHERIT_ONLY_ACE) != 0 || header->AceType == ACCESS_DENIED_ACE_TYPE)
+            {
+                continue;
+            }
+
+            // object and conditional ACEs aren't evaluated here, so they're assumed to grant anything
+            if (header->AceType != ACCESS_ALLOWED_ACE_TYPE)
+            {
+                return false;
+            }
+
+            const auto* ace = reinterpret_cast<const ACCESS_ALLOWED_ACE*>(header);
+            if ((ace->Mask & modifyingAccess) != 0 && !isTrusted(const_cast<DWORD*>(&ace->SidStart)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     std::expected<std::string, std::string> GetProgramDataPath()
     {
         std::string tempPath(MAX_PATH, '\0');
@@ -546,6 +545,21 @@ namespace winapi
         return tempPath;
     }
 
+    std::expected<std::string, std::string> GetLocalAppDataPath()
+    {
+        std::string tempPath(MAX_PATH, '\0');
+
+        if (!GetEnvironmentVariableA("LOCALAPPDATA", tempPath.data(), MAX_PATH))
+        {
+            spdlog::error("Failed to get path to LocalAppData directory, error: {0:#x}", GetLastError());
+            return std::unexpected("Failed to resolve %LOCALAPPDATA% directory");
+        }
+
+        util::stripNulls(tempPath);
+        spdlog::debug("tempPath = {}", tempPath);
+        return tempPath;
+    }
+
     // stolen from: https://building.enlyze.com/posts/writing-win32-apps-like-its-2020-part-3/
     using PGetDpiForMonitor = HRESULT(WINAPI*)(HMONITOR hmonitor, int dpiType, UINT* dpiX, UINT* dpiY);
 
@@ -709,33 +723,6 @@ namespace winapi
         g_accentCache.valid = false;
     }
 
-    std::expected<std::vector<uint8_t>, std::string> DecodeBase64(const std::string& b64)
-    {
-        constexpr size_t maxInputBytes = 1u * 1024u * 1024u; // 1 MiB guard
-        if (b64.size() > maxInputBytes)
-            return std::unexpected("Base64 input exceeds 1 MiB limit");
-
-        if (b64.empty())
-            return std::unexpected("Base64 input is empty");
-
-        DWORD decodedLen = 0;
-        if (!CryptStringToBinaryA(b64.c_str(), static_cast<DWORD>(b64.size()),
-                                  CRYPT_STRING_BASE64, nullptr, &decodedLen, nullptr, nullptr))
-        {
-            return std::unexpected(std::format("CryptStringToBinaryA (size query) failed: {:#x}", GetLastError()));
-        }
-
-        std::vector<uint8_t> out(decodedLen);
-        if (!CryptStringToBinaryA(b64.c_str(), static_cast<DWORD>(b64.size()),
-                                  CRYPT_STRING_BASE64, out.data(), &decodedLen, nullptr, nullptr))
-        {
-            return std::unexpected(std::format("CryptStringToBinaryA (decode) failed: {:#x}", GetLastError()));
-        }
-
-        out.resize(decodedLen);
-        return out;
-    }
-
     std::expected<HICON, std::string> CreateIconFromIcoBuffer(const std::vector<uint8_t>& ico, int cx, int cy)
     {
         // ICO file layout:
@@ -0,0 +1,262 @@
+#include "pch.h"
+#include "CancellableTransfer.h"
+#include "Retry.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+//
+// Cancellation has to take effect within a bounded latency wherever a transfer may be stuck:
+// waiting for the server, resolving the host name and backing off between attempts. The bound
+// is a fraction of CANCEL_POLL_INTERVAL, which is only reached if the wakeup got lost and
+// cancellation fell back to polling.
+//
+
+// the silent server uses POSIX sockets, the stalled resolver interposes getaddrinfo
+#if !defined(_WIN32)
+
+#include <dlfcn.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+    /** Highest cancellation latency accepted */
+    constexpr std::chrono::milliseconds MAX_CANCEL_LATENCY{web::CANCEL_POLL_INTERVAL / 5};
+
+    /** Time given to an operation to get stuck before it gets cancelled */
+    constexpr std::chrono::milliseconds STALL_DELAY{50};
+
+    /** Host name whose lookup blocks until released, see getaddrinfo below */
+    constexpr char STALLED_HOST[] = "stalled-resolver.vicius.test";
+
+    /** Longest a lookup of STALLED_HOST blocks, so a joined lookup fails the test instead of hanging it */
+    constexpr std::chrono::seconds MAX_RESOLVER_STALL{5};
+
+    /**
+     * \brief Holds lookups of STALLED_HOST like a DNS server that doesn't answer.
+     */
+    struct StalledResolver
+    {
+        std::mutex lock;
+        std::condition_variable changed;
+        bool isEntered{false};
+        bool isReleased{false};
+
+        static StalledResolver& Instance()
+        {
+            static StalledResolver instance;
+            return instance;
+        }
+
+        int Resolve()
+        {
+            std::unique_lock guard(lock);
+            isEntered = true;
+            changed.notify_all();
+            changed.wait_for(guard, MAX_RESOLVER_STALL, [this] { return isReleased; });
+            return EAI_NONAME;
+        }
+
+        bool WaitEntered(const std::chrono::milliseconds timeout)
+        {
+            std::unique_lock guard(lock);
+            return changed.wait_for(guard, timeout, [this] { return isEntered; });
+        }
+
+        void Release()
+        {
+            std::lock_guard guard(lock);
+            isReleased = true;
+            changed.notify_all();
+        }
+    };
+
+    /**
+     * \brief A loopback HTTP "server" accepting connections and never answering.
+     */
+    class SilentServer
+    {
+        int listener{-1};
+        uint16_t port{0};
+        std::vector<int> connections{};
+        std::jthread acceptor{};
+
+    public:
+        SilentServer()
+        {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+
+            if (listener < 0 ||
+                bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                listen(listener, SOMAXCONN) != 0 ||
+                getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                throw std::runtime_error("Failed to set up the loopback listener");
+            }
+            port = ntohs(address.sin_port);
+
+            acceptor = std::jthread([this](const std::stop_token& stopToken)
+            {
+                pollfd pending{listener, POLLIN, 0};
+                while (!stopToken.stop_requested())
+                {
+                    if (poll(&pending, 1, 50) > 0)
+                    {
+                        if (const int connection = accept(listener, nullptr, nullptr); connection >= 0)
+                        {
+                            connections.push_back(connection);
+                        }
+                    }
+                }
+            });
+        }
+
+        SilentServer(const SilentServer&) = delete;
+        SilentServer& operator=(const SilentServer&) = delete;
+
+        ~SilentServer()
+        {
+            acceptor.request_stop();
+            acceptor.join();
+
+            for (const int connection : connections)
+            {
+                close(connection);
+            }
+            close(listener);
+        }
+
+        [[nodiscard]] std::string GetUrl() const
+        {
+            return "http://127.0.0.1:" + std::to_string(port) + "/manifest.json";
+        }
+    };
+
+    size_t DiscardBody(char*, const size_t size, const size_t count, void*)
+    {
+        return size * count;
+    }
+
+    struct CancelResult
+    {
+        CURLcode code{CURLE_OK};
+        std::chrono::steady_clock::duration latency{};
+    };
+
+    /**
+     * \brief Starts a transfer of url, cancels it once stalled returns and measures until it returned.
+     */
+    template <typename Stalled>
+    CancelResult CancelTransfer(const std::string& url, Stalled stalled)
+    {
+        CURL* handle = curl_easy_init();
+        const auto handleGuard = sg::make_scope_guard([handle]() noexcept { curl_easy_cleanup(handle); });
+
+        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DiscardBody);
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT, 60L);
+
+        std::stop_source stopSource;
+        std::chrono::steady_clock::time_point returned{};
+        CancelResult result{};
+
+        std::jthread transfer([&]
+        {
+            std::string errorMessage;
+            result.code = web::PerformCancellable(handle, stopSource.get_token(), errorMessage);
+            returned = std::chrono::steady_clock::now();
+        });
+
+        stalled();
+
+        const auto requested = std::chrono::steady_clock::now();
+        stopSource.request_stop();
+        transfer.join();
+
+        result.latency = returned - requested;
+        return result;
+    }
+}
+
+// every lookup of the test process goes through here, only STALLED_HOST is held
+extern "C" int getaddrinfo(const char* name, const char* service, const addrinfo* hints, addrinfo** result)
+{
+    if (name != nullptr && std::strcmp(name, STALLED_HOST) == 0)
+    {
+        return StalledResolver::Instance().Resolve();
+    }
+
+    static const auto next = reinterpret_cast<int (*)(const char*, const char*, const addrinfo*, addrinfo**)>(
+        dlsym(RTLD_NEXT, "getaddrinfo"));
+
+    return next != nullptr ? next(name, service, hints, result) : EAI_SYSTEM;
+}
+
+TEST(CancellationTest, CancelsTransferWaitingForServer)
+{
+    const SilentServer server;
+
+    for (int iteration = 0; iteration < 20; iteration++)
+    {
+        const auto result = CancelTransfer(server.GetUrl(), [] { std::this_thread::sleep_for(STALL_DELAY); });
+
+        EXPECT_EQ(result.code, CURLE_ABORTED_BY_CALLBACK) << "iteration " << iteration;
+        EXPECT_LT(result.latency, MAX_CANCEL_LATENCY) << "iteration " << iteration;
+    }
+}
+
+TEST(CancellationTest, CancelsTransferResolvingHostName)
+{
+    auto& resolver = StalledResolver::Instance();
+    // lets the detached lookup thread finish once the test is done
+    const auto releaseGuard = sg::make_scope_guard([&resolver]() noexcept { resolver.Release(); });
+
+    bool isStalled = false;
+    const auto result = CancelTransfer(std::string("http://") + STALLED_HOST + "/manifest.json", [&]
+    {
+        isStalled = resolver.WaitEntered(5s);
+    });
+
+    if (!isStalled)
+    {
+        GTEST_SKIP() << "libcurl doesn't resolve through getaddrinfo (not the threaded resolver)";
+    }
+
+    EXPECT_EQ(result.code, CURLE_ABORTED_BY_CALLBACK);
+    EXPECT_LT(result.latency, MAX_CANCEL_LATENCY);
+}
+
+TEST(CancellationTest, CancelsRetryBackoff)
+{
+    retry::RetryPolicy policy({});
+    std::stop_source stopSource;
+    std::chrono::steady_clock::time_point returned{};
+    bool isCompleted = true;
+
+    std::jthread backoff([&]
+    {
+        isCompleted = policy.Sleep(30s, stopSource.get_token());
+        returned = std::chrono::steady_clock::now();
+    });
+
+    std::this_thread::sleep_for(STALL_DELAY);
+
+    const auto requested = std::chrono::steady_clock::now();
+    stopSource.request_stop();
+    backoff.join();
+
+    EXPECT_FALSE(isCompleted);
+    EXPECT_LT(returned - requested, MAX_CANCEL_LATENCY);
+}
+
+#endif
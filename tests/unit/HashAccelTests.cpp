@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "HashAccel.h"
+#include "TempFile.h"
+
+#include <gtest/gtest.h>
+
+//
+// Every SHA backend must reproduce the FIPS 180 known answers and hash-library's digests, no
+// matter where the input is split. Each backend this CPU supports is forced in turn, the
+// others are skipped. BLAKE3 and XXH3-128 must reproduce their reference test vectors.
+//
+
+namespace
+{
+    using hashing::ShaBackend;
+
+    struct KnownAnswer
+    {
+        std::string message;
+        const char* sha1;
+        const char* sha256;
+    };
+
+    const std::vector<KnownAnswer>& GetKnownAnswers()
+    {
+        static const std::vector<KnownAnswer> answers{
+            {
+                "",
+                "da39a3ee5e6b4b0d3255bfef95601890afd80709",
+                "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+            },
+            {
+                "abc",
+                "a9993e364706816aba3e25717850c26c9cd0d89d",
+                "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+            },
+            // 448 bits, the padding doesn't fit into the last block
+            {
+                "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+                "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+            },
+            // 896 bits
+            {
+                "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqr"
+                "lmnopqrsmnopqrstnopqrstu",
+                "a49b2446a02c645bf419f995b67091253a04a259",
+                "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+            },
+            {
+                std::string(1000000, 'a'),
+                "34aa973cd4c4daa4f61eeb2bdbad27316534016f",
+                "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+            },
+        };
+
+        return answers;
+    }
+
+    /** Piece sizes around the 64-byte block and padding boundaries, cycled through */
+    constexpr size_t PIECE_SIZES[] = {1, 3, 55, 56, 63, 64, 65, 127, 129, 1000, 4099};
+
+    template <typename Hasher>
+    std::string HashInPieces(const std::string_view data, const size_t firstPiece)
+    {
+        Hasher hasher;
+
+        size_t piece = firstPiece;
+        for (size_t offset = 0; offset < data.size(); piece++)
+        {
+            const size_t length = std::min(PIECE_SIZES[ piece % std::size(PIECE_SIZES) ], data.size() - offset);
+            hasher.add(data.data() + offset, length);
+            offset += length;
+        }
+
+        return hasher.getHash();
+    }
+
+    struct ReferenceVector
+    {
+        size_t size;
+        const char* digest;
+    };
+
+    /** The input of the official BLAKE3 test vectors (test_vectors.json), bytes counting up modulo 251 */
+    std::string MakeBlake3Input(const size_t size)
+    {
+        std::string input(size, '\0');
+        for (size_t i = 0; i < size; i++)
+        {
+            input[ i ] = static_cast<char>(i % 251);
+        }
+        return input;
+    }
+
+    /** Chunk (1 KiB) and subtree boundaries of the official BLAKE3 test vectors */
+    constexpr ReferenceVector BLAKE3_VECTORS[] = {
+        {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+        {1, "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213"},
+        {1023, "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11"},
+        {1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7"},
+        {1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444"},
+        {2048, "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a"},
+        {2049, "5f4d72f40d7a5f82b15ca2b2e44b1de3c2ef86c426c95c1af0b6879522563030"},
+        {3072, "b98cb0ff3623be03326b373de6b9095218513e64f1ee2edd2525c7ad1e5cffd2"},
+        {3073, "7124b49501012f81cc7f11ca069ec9226cecb8a2c850cfe644e327d22d3e1cd3"},
+        {4096, "015094013f57a5277b59d8475c0501042c0b642e531b0a1c8f58d2163229e969"},
+        {4097, "9b4052b38f1c5fc8b1f9ff7ac7b27cd242487b3d890d15c96a1c25b8aa0fb995"},
+        {8192, "aae792484c8efe4f19e2ca7d371d8c467ffb10748d8a5a1ae579948f718a2a63"},
+        {8193, "bab6c09cb8ce8cf459261398d2e7aef35700bf488116ceb94a36d0f5f1b7bc3b"},
+        {16384, "f875d6646de28985646f34ee13be9a576fd515f76b5b0a26bb324735041ddde4"},
+        {31744, "62b6960e1a44bcc1eb1a611a8d6235b6b4b78f32e7abc4fb4c6cdcce94895c47"},
+        {102400, "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085"},
+    };
+
+    /** The input of xxHash's sanity tests (sanityBuffer of xsum_sanity_check.c) */
+    std::string MakeXxh3Input(const size_t size)
+    {
+        std::string input(size, '\0');
+        uint64_t generator = 2654435761U; // PRIME32
+
+        for (auto& byte : input)
+        {
+            byte = static_cast<char>(generator >> 56);
+            generator *= 11400714785074694797ULL; // PRIME64
+        }
+        return input;
+    }
+
+    /** Every XXH3 input length class (0, 1-3, 4-8, 9-16, 17-128, 129-240, longer) and stripe/block boundaries */
+    constexpr ReferenceVector XXH3_128_VECTORS[] = {
+        {0, "99aa06d3014798d86001c324468d497f"},
+        {1, "a6cd5e9392000f6ac44bdff4074eecdb"},
+        {6, "082afe0b8162d12a3e7039bdda43cfc6"},
+        {12, "6e3efd8fc7802b18061a192713f69ad9"},
+        {24, "0ce966e4678d37611e7044d28b1b901d"},
+        {48, "a002ac4e5478227ef942219aed80f67b"},
+        {81, "4952f58181ab00425e8bafb9f95fb803"},
+        {103, "00d0c82e60f686686c8734b7d2df189b"},
+        {192, "064934db40706c3d0679e7f625e389d9"},
+        {222, "337e09641b948717f1aebd597cec6b3a"},
+        {403, "1b6de21e332dd73dcdeb804d65c6dea4"},
+        {512, "18d2d110dcc9bca1617e49599013cb6b"},
+        {2048, "f736557fd47073a5dd59e2c3a5f038e0"},
+        {2099, "ad48ae0a0951dc52c6b9d9b3fc9ac765"},
+        {2240, "ccb134fbfa7ce49d6e73a90539cf2948"},
+        {2367, "e89c0f6ff369b427cb37aeb9e5d361ed"},
+        {4096, "b9cfaea2ca5626a4e91206429d1f48f9"},
+    };
+
+    class ShaBackendTest : public testing::TestWithParam<ShaBackend>
+    {
+    protected:
+        void SetUp() override
+        {
+            if (!hashing::SetShaBackend(GetParam()))
+            {
+                GTEST_SKIP() << "Not supported by this CPU or build";
+            }
+        }
+
+        void TearDown() override
+        {
+            hashing::SetShaBackend(ShaBackend::Auto);
+        }
+    };
+}
+
+TEST_P(ShaBackendTest, KnownAnswers)
+{
+    for (const auto& answer : GetKnownAnswers())
+    {
+        hashing::AcceleratedSHA1 sha1;
+        hashing::AcceleratedSHA256 sha256;
+
+        EXPECT_EQ(sha1(answer.message), answer.sha1) << answer.message.size() << " bytes";
+        EXPECT_EQ(sha256(answer.message), answer.sha256) << answer.message.size() << " bytes";
+    }
+}
+
+TEST_P(ShaBackendTest, KnownAnswersInPieces)
+{
+    for (const auto& answer : GetKnownAnswers())
+    {
+        for (size_t firstPiece = 0; firstPiece < std::size(PIECE_SIZES); firstPiece++)
+        {
+            EXPECT_EQ(HashInPieces<hashing::AcceleratedSHA1>(answer.message, firstPiece), answer.sha1)
+                << answer.message.size() << " bytes, first piece " << firstPiece;
+            EXPECT_EQ(HashInPieces<hashing::AcceleratedSHA256>(answer.message, firstPiece), answer.sha256)
+                << answer.message.size() << " bytes, first piece " << firstPiece;
+        }
+    }
+}
+
+TEST_P(ShaBackendTest, MatchesHashLibrary)
+{
+    std::vector<size_t> sizes{};
+    // every position of the end of the message relative to the padding, over three blocks
+    for (size_t size = 0; size <= 3 * 64; size++)
+    {
+        sizes.push_back(size);
+    }
+    sizes.insert(sizes.end(), {4095, 4096, 4097, 1000003});
+
+    for (const size_t size : sizes)
+    {
+        const auto data = test::MakeData(size, 0x5669636975730002 + size);
+
+        SHA1 referenceSha1;
+        SHA256 referenceSha256;
+        const auto expectedSha1 = referenceSha1(data);
+        const auto expectedSha256 = referenceSha256(data);
+
+        hashing::AcceleratedSHA1 sha1;
+        hashing::AcceleratedSHA256 sha256;
+
+        EXPECT_EQ(sha1(data), expectedSha1) << size << " bytes";
+        EXPECT_EQ(sha256(data), expectedSha256) << size << " bytes";
+        EXPECT_EQ(HashInPieces<hashing::AcceleratedSHA1>(data, size), expectedSha1) << size << " bytes";
+        EXPECT_EQ(HashInPieces<hashing::AcceleratedSHA256>(data, size), expectedSha256) << size << " bytes";
+    }
+}
+
+TEST(Blake3Test, ReferenceVectors)
+{
+    for (const auto& vector : BLAKE3_VECTORS)
+    {
+        const auto input = MakeBlake3Input(vector.size);
+
+        hashing::Blake3 blake3;
+        EXPECT_EQ(blake3(input), vector.digest) << vector.size << " bytes";
+
+        for (size_t firstPiece = 0; firstPiece < std::size(PIECE_SIZES); firstPiece++)
+        {
+            EXPECT_EQ(HashInPieces<hashing::Blake3>(input, firstPiece), vector.digest)
+                << vector.size << " bytes, first piece " << firstPiece;
+        }
+    }
+}
+
+TEST(Xxh3Test, ReferenceVectors)
+{
+    for (const auto& vector : XXH3_128_VECTORS)
+    {
+        const auto input = MakeXxh3Input(vector.size);
+
+        hashing::Xxh3_128 xxh3;
+        EXPECT_EQ(xxh3(input), vector.digest) << vector.size << " bytes";
+
+        for (size_t firstPiece = 0; firstPiece < std::size(PIECE_SIZES); firstPiece++)
+        {
+            EXPECT_EQ(HashInPieces<hashing::Xxh3_128>(input, firstPiece), vector.digest)
+                << vector.size << " bytes, first piece " << firstPiece;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Backends,
+    ShaBackendTest,
+    testing::Values(ShaBackend::Portable, ShaBackend::ShaNi),
+    [](const testing::TestParamInfo<ShaBackend>& info)
+    {
+        return std::string(magic_enum::enum_name(info.param));
+    });
@@ -0,0 +1,331 @@
+#include "pch.h"
+#include "Hashing.h"
+#include "TempFile.h"
+
+#include <gtest/gtest.h>
+
+//
+// IncrementalHasher must produce exactly the digest of a one-shot read of the same bytes, no
+// matter how the data is split up, and only ever continue from a state it can verify.
+//
+
+namespace
+{
+    using models::ChecksumAlgorithm;
+
+    /** Spans several read blocks and doesn't end on a block boundary */
+    constexpr size_t PAYLOAD_SIZE = 2 * io::READ_BLOCK_SIZE + 12345;
+
+    const std::string& GetPayload()
+    {
+        static const std::string payload = test::MakeData(PAYLOAD_SIZE);
+        return payload;
+    }
+
+    /** hash-library keeps the MD5 state private, ExportState can't save it */
+    bool IsResumable(const ChecksumAlgorithm algorithm)
+    {
+        return algorithm != ChecksumAlgorithm::MD5;
+    }
+
+    class IncrementalHasherTest : public testing::TestWithParam<ChecksumAlgorithm>
+    {
+    protected:
+        static inline std::unique_ptr<test::TempFile> file{};
+
+        static void SetUpTestSuite()
+        {
+            file = std::make_unique<test::TempFile>(GetPayload());
+        }
+
+        static void TearDownTestSuite()
+        {
+            file.reset();
+        }
+
+        static std::string HashWholeFile(const ChecksumAlgorithm algorithm)
+        {
+            const auto digests = hashing::HashFile(file->GetPath(), {algorithm});
+            EXPECT_TRUE(digests.has_value()) << digests.error();
+            return digests.has_value() ? digests.value().front() : std::string{};
+        }
+
+        /** Feeds data in pieces of random size, including empty ones */
+        static void AddInPieces(hashing::IncrementalHasher& hasher, const std::string_view data, const uint64_t seed)
+        {
+            std::mt19937_64 generator(seed);
+            std::uniform_int_distribution<size_t> pieceSize(0, 200000);
+
+            for (size_t offset = 0; offset < data.size();)
+            {
+                const size_t length = std::min(pieceSize(generator), data.size() - offset);
+                hasher.Add(data.data() + offset, length);
+                offset += length;
+            }
+        }
+    };
+}
+
+TEST_P(IncrementalHasherTest, PiecesMatchOneShotFileHash)
+{
+    const auto expected = HashWholeFile(GetParam());
+    ASSERT_FALSE(expected.empty());
+
+    for (uint64_t seed = 1; seed <= 4; seed++)
+    {
+        hashing::IncrementalHasher hasher(GetParam());
+        AddInPieces(hasher, GetPayload(), seed);
+
+        EXPECT_EQ(hasher.GetBytesHashed(), PAYLOAD_SIZE);
+        EXPECT_EQ(hasher.GetHash(), expected) << "seed " << seed;
+    }
+}
+
+TEST_P(IncrementalHasherTest, GetHashDoesNotAlterState)
+{
+    hashing::IncrementalHasher hasher(GetParam());
+    const std::string_view payload = GetPayload();
+
+    for (size_t offset = 0; offset < payload.size(); offset += 777777)
+    {
+        const auto piece = payload.substr(offset, 777777);
+        hasher.Add(piece.data(), piece.size());
+        (void)hasher.GetHash();
+    }
+
+    EXPECT_EQ(hasher.GetHash(), HashWholeFile(GetParam()));
+}
+
+TEST_P(IncrementalHasherTest, CatchUpWithFileCompletesDigest)
+{
+    const std::string_view payload = GetPayload();
+
+    for (const size_t prefix : {size_t{0}, size_t{1}, io::READ_BLOCK_SIZE, PAYLOAD_SIZE - 1, PAYLOAD_SIZE})
+    {
+        hashing::IncrementalHasher hasher(GetParam());
+        hasher.Add(payload.data(), prefix);
+
+        EXPECT_TRUE(hasher.CatchUpWithFile(file->GetPath(), PAYLOAD_SIZE)) << "prefix " << prefix;
+        EXPECT_EQ(hasher.GetBytesHashed(), PAYLOAD_SIZE);
+        EXPECT_EQ(hasher.GetHash(), HashWholeFile(GetParam())) << "prefix " << prefix;
+    }
+
+    // the file can't provide more than it holds
+    hashing::IncrementalHasher hasher(GetParam());
+    EXPECT_FALSE(hasher.CatchUpWithFile(file->GetPath(), PAYLOAD_SIZE + 1));
+}
+
+TEST_P(IncrementalHasherTest, ExportedStateContinuesDigest)
+{
+    if (!IsResumable(GetParam()))
+    {
+        GTEST_SKIP() << "State can't be exported";
+    }
+
+    const std::string_view payload = GetPayload();
+
+    for (const size_t prefix : {size_t{0}, size_t{63}, size_t{64}, io::READ_BLOCK_SIZE + 5})
+    {
+        hashing::IncrementalHasher original(GetParam());
+        original.Add(payload.data(), prefix);
+
+        const auto exported = original.ExportState();
+        ASSERT_FALSE(exported.empty());
+
+        hashing::IncrementalHasher restored(GetParam());
+        ASSERT_TRUE(restored.ImportState(prefix, exported, original.GetHash())) << "prefix " << prefix;
+        EXPECT_EQ(restored.GetBytesHashed(), prefix);
+
+        restored.Add(payload.data() + prefix, payload.size() - prefix);
+        EXPECT_EQ(restored.GetHash(), HashWholeFile(GetParam())) << "prefix " << prefix;
+    }
+}
+
+TEST_P(IncrementalHasherTest, DamagedStateIsRejected)
+{
+    if (!IsResumable(GetParam()))
+    {
+        GTEST_SKIP() << "State can't be exported";
+    }
+
+    const std::string_view payload = GetPayload();
+
+    hashing::IncrementalHasher original(GetParam());
+    original.Add(payload.data(), 100000);
+    const auto exported = original.ExportState();
+    const auto digest = original.GetHash();
+
+    const auto empty = hashing::IncrementalHasher(GetParam()).GetHash();
+
+    // every bit inverted, including the buffered length and the byte count
+    auto inverted = exported;
+    for (auto& digit : inverted)
+    {
+        const int value = digit <= '9' ? digit - '0' : digit - 'a' + 10;
+        digit = "0123456789abcdef"[ 15 - value ];
+    }
+
+    const std::vector<std::string> damaged{
+        inverted,
+        exported.substr(0, exported.size() - 2),
+        exported + "00",
+        "zz" + exported.substr(2),
+        exported.substr(1),
+        "",
+    };
+
+    for (const auto& state : damaged)
+    {
+        hashing::IncrementalHasher restored(GetParam());
+        restored.Add(payload.data(), 10);
+
+        EXPECT_FALSE(restored.ImportState(100000, state, digest));
+        // a rejected import leaves a fresh hasher behind
+        EXPECT_EQ(restored.GetBytesHashed(), 0u);
+        EXPECT_EQ(restored.GetHash(), empty);
+    }
+
+    // an intact state claimed to produce another digest
+    hashing::IncrementalHasher other(GetParam());
+    other.Add(payload.data(), 99999);
+
+    hashing::IncrementalHasher restored(GetParam());
+    EXPECT_FALSE(restored.ImportState(100000, exported, other.GetHash()));
+
+    // an intact state claimed to cover another number of bytes
+    EXPECT_FALSE(restored.ImportState(100001, exported, digest));
+    EXPECT_FALSE(restored.ImportState(99999, exported, digest));
+    EXPECT_TRUE(restored.ImportState(100000, exported, digest));
+}
+
+TEST_P(IncrementalHasherTest, ForeignStateIsRejected)
+{
+    const std::string_view payload = GetPayload();
+
+    for (const auto foreign : {ChecksumAlgorithm::MD5, ChecksumAlgorithm::SHA1, ChecksumAlgorithm::SHA256,
+                               ChecksumAlgorithm::BLAKE3, ChecksumAlgorithm::XXH3_128})
+    {
+        if (foreign == GetParam())
+        {
+            continue;
+        }
+
+        hashing::IncrementalHasher original(foreign);
+        original.Add(payload.data(), 4096);
+
+        hashing::IncrementalHasher restored(GetParam());
+        EXPECT_FALSE(restored.ImportState(4096, original.ExportState(), original.GetHash()))
+            << magic_enum::enum_name(foreign);
+    }
+
+    // nothing can be restored without an algorithm
+    hashing::IncrementalHasher original(GetParam());
+    original.Add(payload.data(), 4096);
+
+    hashing::IncrementalHasher invalid{};
+    EXPECT_FALSE(invalid.ImportState(4096, original.ExportState(), original.GetHash()));
+}
+
+TEST(IncrementalHasherStateTest, Md5StateIsNotExported)
+{
+    hashing::IncrementalHasher hasher(ChecksumAlgorithm::MD5);
+    hasher.Add(GetPayload().data(), 4096);
+
+    EXPECT_TRUE(hasher.ExportState().empty());
+    EXPECT_FALSE(hasher.ImportState(4096, hasher.ExportState(), hasher.GetHash()));
+    EXPECT_EQ(hasher.GetBytesHashed(), 0u);
+}
+
+// journals outlive updates, the encoding must not change with the build or the CPU
+TEST(IncrementalHasherStateTest, StateEncodingIsStable)
+{
+    hashing::IncrementalHasher hasher(ChecksumAlgorithm::SHA256);
+    hasher.Add("abc", 3);
+
+    // version, algorithm, byte count, chaining words (little-endian), buffered bytes
+    const std::string expected =
+        "01"
+        "02"
+        "0300000000000000"
+        "67e6096a85ae67bb72f36e3c3af54fa57f520e518c68059babd9831f19cde05b"
+        "616263";
+    EXPECT_EQ(hasher.ExportState(), expected);
+
+    hashing::IncrementalHasher restored(ChecksumAlgorithm::SHA256);
+    ASSERT_TRUE(restored.ImportState(3, expected, hasher.GetHash()));
+    EXPECT_EQ(restored.GetHash(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+    // a state of a future format is rejected rather than misread
+    EXPECT_FALSE(restored.ImportState(3, "02" + expected.substr(2), hasher.GetHash()));
+}
+
+TEST(IncrementalHasherStateTest, Blake3StateEncodingIsStable)
+{
+    // three chunks and part of a fourth: a merged and an unmerged subtree on the stack
+    const std::string payload(3 * 1024 + 100, 'a');
+
+    // version, algorithm, chunk chaining value, chunk counter, compressed blocks, buffered length
+    // and bytes, subtree stack length and chaining values (words little-endian)
+    const std::string expected =
+        "01"
+        "03"
+        "ddf8537ae8bf0a8cf6c335dd395e6308c0a93c4d23e5a8ce721ed0e2d49c4517"
+        "0300000000000000"
+        "01"
+        "24"
+        "616161616161616161616161616161616161616161616161616161616161616161616161"
+        "02"
+        "272b0de2eaae3ca3ef4be1720ff3067d319d9e912a2b0fede7a9dea32652738d"
+        "aa49ca2ba689e4e8d8d5c77446a36714584404edb1e85834f59ada3585e33514";
+    const std::string digest = "2e688cb11545497b09da15aeaeae588da6490d156503df08607f9aca75c8cd8c";
+
+    // ending a piece on a subtree boundary leaves an unmerged pair behind until the next one
+    for (const size_t firstPiece : {payload.size(), size_t{1}, size_t{2048}, size_t{3000}})
+    {
+        hashing::IncrementalHasher hasher(ChecksumAlgorithm::BLAKE3);
+        hasher.Add(payload.data(), firstPiece);
+        hasher.Add(payload.data() + firstPiece, payload.size() - firstPiece);
+
+        EXPECT_EQ(hasher.ExportState(), expected) << "first piece " << firstPiece;
+        EXPECT_EQ(hasher.GetHash(), digest) << "first piece " << firstPiece;
+    }
+
+    hashing::IncrementalHasher restored(ChecksumAlgorithm::BLAKE3);
+    ASSERT_TRUE(restored.ImportState(payload.size(), expected, digest));
+
+    const std::string more(5000 - payload.size(), 'a');
+    restored.Add(more.data(), more.size());
+    EXPECT_EQ(restored.GetHash(), "09d0d29a5f2dc69dff0809823ca867836c3a3cfb00e12df06d92e3f0f70629e9");
+}
+
+TEST(HashFileTest, MatchesHashLibrary)
+{
+    const test::TempFile file(GetPayload());
+
+    const auto digests = hashing::HashFile(file.GetPath(),
+        {ChecksumAlgorithm::MD5, ChecksumAlgorithm::SHA1, ChecksumAlgorithm::SHA256});
+    ASSERT_TRUE(digests.has_value()) << digests.error();
+
+    MD5 md5;
+    SHA1 sha1;
+    SHA256 sha256;
+    EXPECT_EQ(digests.value()[ 0 ], md5(GetPayload()));
+    EXPECT_EQ(digests.value()[ 1 ], sha1(GetPayload()));
+    EXPECT_EQ(digests.value()[ 2 ], sha256(GetPayload()));
+}
+
+TEST(HashFileTest, MissingFileFails)
+{
+    EXPECT_FALSE(hashing::HashFile(std::filesystem::temp_directory_path() / "vicius-test-missing.bin",
+        {ChecksumAlgorithm::SHA256}).has_value());
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Algorithms,
+    IncrementalHasherTest,
+    testing::Values(ChecksumAlgorithm::MD5, ChecksumAlgorithm::SHA1, ChecksumAlgorithm::SHA256,
+        ChecksumAlgorithm::BLAKE3, ChecksumAlgorithm::XXH3_128),
+    [](const testing::TestParamInfo<ChecksumAlgorithm>& info)
+    {
+        return std::string(magic_enum::enum_name(info.param));
+    });
@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "Retry.h"
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+
+namespace
+{
+    /**
+     * \brief A clock that only advances when slept on.
+     */
+    class VirtualClock final : public retry::Clock
+    {
+        std::chrono::steady_clock::time_point now{};
+
+    public:
+        /** Wall-clock time at the start, Mon, 01 Jun 2026 00:00:00 GMT */
+        static constexpr std::chrono::sys_days EPOCH{std::chrono::year{2026} / 6 / 1};
+
+        [[nodiscard]] std::chrono::steady_clock::time_point Now() const override { return now; }
+
+        [[nodiscard]] std::chrono::system_clock::time_point WallNow() const override
+        {
+            return EPOCH + std::chrono::duration_cast<std::chrono::system_clock::duration>(now.time_since_epoch());
+        }
+
+        bool SleepFor(const std::chrono::milliseconds duration, const std::stop_token& stopToken) override
+        {
+            if (stopToken.stop_requested())
+            {
+                return false;
+            }
+            now += duration;
+            return true;
+        }
+
+        [[nodiscard]] std::chrono::milliseconds Elapsed() const
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
+        }
+    };
+
+    retry::RetryOptions SeededOptions(const uint64_t seed)
+    {
+        retry::RetryOptions options{};
+        options.maxAttempts = 50;
+        options.baseDelay = 100ms;
+        options.maxDelay = 5000ms;
+        options.seed = seed;
+        return options;
+    }
+}
+
+TEST(RetryPolicyTest, JitterStaysWithinBounds)
+{
+    for (uint64_t seed = 1; seed <= 100; seed++)
+    {
+        const auto options = SeededOptions(seed);
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+
+        auto previous = options.baseDelay;
+        while (const auto delay = policy.NextDelay({}))
+        {
+            const auto upper = std::max(options.baseDelay, std::min(options.maxDelay, previous * 3));
+
+            ASSERT_GE(delay.value(), options.baseDelay) << "seed " << seed;
+            ASSERT_LE(delay.value(), upper) << "seed " << seed;
+            previous = delay.value();
+        }
+    }
+}
+
+TEST(RetryPolicyTest, SameSeedGivesSameSchedule)
+{
+    VirtualClock firstClock, secondClock;
+    retry::RetryPolicy first(SeededOptions(42), firstClock);
+    retry::RetryPolicy second(SeededOptions(42), secondClock);
+
+    for (int i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(first.NextDelay({}), second.NextDelay({}));
+    }
+}
+
+TEST(RetryPolicyTest, StopsAfterMaxAttempts)
+{
+    auto options = SeededOptions(1);
+    options.maxAttempts = 3;
+
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+
+    EXPECT_TRUE(policy.NextDelay({}).has_value());
+    EXPECT_TRUE(policy.NextDelay({}).has_value());
+    EXPECT_FALSE(policy.NextDelay({}).has_value());
+    EXPECT_EQ(policy.GetAttemptsLeft(), 0);
+}
+
+TEST(RetryPolicyTest, StopsWhenBudgetIsUsedUp)
+{
+    auto options = SeededOptions(7);
+    options.maxAttempts = 1000;
+    options.budget = 20s;
+
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+
+    int retries = 0;
+    while (const auto delay = policy.NextDelay({}))
+    {
+        ASSERT_TRUE(policy.Sleep(delay.value()));
+        retries++;
+    }
+
+    EXPECT_GT(retries, 0);
+    EXPECT_LT(clock.Elapsed(), options.budget);
+    EXPECT_GT(policy.GetAttemptsLeft(), 0);
+}
+
+TEST(RetryPolicyTest, BudgetAccountsForRetryAfter)
+{
+    auto options = SeededOptions(7);
+    options.budget = 60s;
+
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+
+    // would end past the deadline, so it's not worth waiting for
+    EXPECT_FALSE(policy.NextDelay({.httpCode = 503, .retryAfter = "90"}).has_value());
+}
+
+TEST(RetryPolicyTest, RetryAfterReplacesJitter)
+{
+    VirtualClock clock;
+    retry::RetryPolicy policy(SeededOptions(1), clock);
+
+    EXPECT_EQ(policy.NextDelay({.httpCode = 429, .retryAfter = "120"}), 120s);
+    EXPECT_EQ(policy.NextDelay({.httpCode = 503, .retryAfter = "Mon, 01 Jun 2026 00:00:42 GMT"}), 42s);
+}
+
+TEST(RetryPolicyTest, RetryAfterIsIgnoredForOtherStatusCodes)
+{
+    const auto options = SeededOptions(1);
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+
+    const auto delay = policy.NextDelay({.httpCode = 500, .retryAfter = "120"});
+    ASSERT_TRUE(delay.has_value());
+    EXPECT_LE(delay.value(), options.maxDelay);
+}
+
+TEST(RetryPolicyTest, MalformedRetryAfterFallsBackToJitter)
+{
+    const auto options = SeededOptions(1);
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+
+    const auto delay = policy.NextDelay({.httpCode = 503, .retryAfter = "soon"});
+    ASSERT_TRUE(delay.has_value());
+    EXPECT_GE(delay.value(), options.baseDelay);
+    EXPECT_LE(delay.value(), options.maxDelay);
+}
+
+TEST(RetryPolicyTest, GivesUpOnRetryAfterBeyondCeiling)
+{
+    auto options = SeededOptions(1);
+    options.maxRetryAfter = 5min;
+
+    {
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+        EXPECT_EQ(policy.NextDelay({.httpCode = 503, .retryAfter = "300"}), 5min);
+    }
+    {
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+        EXPECT_FALSE(policy.NextDelay({.httpCode = 503, .retryAfter = "301"}).has_value());
+    }
+    {
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+        EXPECT_FALSE(policy.NextDelay({.httpCode = 429, .retryAfter = "86400"}).has_value());
+    }
+    {
+        VirtualClock clock;
+        retry::RetryPolicy policy(options, clock);
+        EXPECT_FALSE(policy.NextDelay({.httpCode = 429, .retryAfter = "Tue, 02 Jun 2026 00:00:00 GMT"}).has_value());
+    }
+}
+
+TEST(RetryPolicyTest, TimeoutGrowsUpToMaximum)
+{
+    auto options = SeededOptions(1);
+    options.initialTimeoutSecs = 100;
+    options.maxTimeoutSecs = 300;
+
+    VirtualClock clock;
+    retry::RetryPolicy policy(options, clock);
+    EXPECT_EQ(policy.GetTimeoutSecs(), 100);
+
+    ASSERT_TRUE(policy.NextDelay({.isTimeout = true}).has_value());
+    EXPECT_EQ(policy.GetTimeoutSecs(), 150);
+
+    ASSERT_TRUE(policy.NextDelay({}).has_value());
+    EXPECT_EQ(policy.GetTimeoutSecs(), 150);
+
+    ASSERT_TRUE(policy.NextDelay({.isTimeout = true}).has_value());
+    EXPECT_EQ(policy.GetTimeoutSecs(), 225);
+
+    ASSERT_TRUE(policy.NextDelay({.isTimeout = true}).has_value());
+    EXPECT_EQ(policy.GetTimeoutSecs(), 300);
+}
+
+TEST(RetryPolicyTest, CancelledSleepReportsIt)
+{
+    VirtualClock clock;
+    retry::RetryPolicy policy(SeededOptions(1), clock);
+
+    std::stop_source stop;
+    stop.request_stop();
+
+    EXPECT_FALSE(policy.Sleep(1s, stop.get_token()));
+}
+
+TEST(ParseRetryAfterTest, DelaySeconds)
+{
+    const auto now = std::chrono::system_clock::time_point{VirtualClock::EPOCH};
+
+    EXPECT_EQ(retry::ParseRetryAfter("0", now), 0s);
+    EXPECT_EQ(retry::ParseRetryAfter("120", now), 120s);
+    EXPECT_EQ(retry::ParseRetryAfter("  7\t", now), 7s);
+    // capped so the conversion can't overflow
+    EXPECT_EQ(retry::ParseRetryAfter("99999999999999999999", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("999999999", now), 24h);
+}
+
+TEST(ParseRetryAfterTest, HttpDate)
+{
+    const auto now = std::chrono::system_clock::time_point{VirtualClock::EPOCH};
+
+    EXPECT_EQ(retry::ParseRetryAfter("Mon, 01 Jun 2026 00:01:30 GMT", now), 90s);
+    EXPECT_EQ(retry::ParseRetryAfter("Tue, 02 Jun 2026 00:00:00 GMT", now), 24h);
+    // dates in the past mean right away
+    EXPECT_EQ(retry::ParseRetryAfter("Sun, 06 Nov 1994 08:49:37 GMT", now), 0s);
+    EXPECT_EQ(retry::ParseRetryAfter("Mon, 01 Jun 2026 00:00:00 GMT", now), 0s);
+}
+
+TEST(ParseRetryAfterTest, MalformedValues)
+{
+    const auto now = std::chrono::system_clock::time_point{VirtualClock::EPOCH};
+
+    EXPECT_EQ(retry::ParseRetryAfter("", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("   ", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("-5", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("1.5", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("soon", now), std::nullopt);
+    EXPECT_EQ(retry::ParseRetryAfter("Mon, 31 Feb 2026 00:00:00 GMT", now), std::nullopt);
+}
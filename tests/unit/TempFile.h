@@ -0,0 +1,62 @@
+#pragma once
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+
+namespace test
+{
+    /**
+     * \brief Generates size pseudo-random bytes, identical for the same size and seed.
+     */
+    inline std::string MakeData(const size_t size, const uint64_t seed = 0x5669636975730001)
+    {
+        std::mt19937_64 generator(seed);
+        std::string data(size, '\0');
+
+        for (auto& byte : data)
+        {
+            byte = static_cast<char>(generator() & 0xFF);
+        }
+
+        return data;
+    }
+
+    /**
+     * \brief A file in the temp directory that is deleted again when going out of scope.
+     */
+    class TempFile
+    {
+        std::filesystem::path path;
+
+    public:
+        explicit TempFile(const std::string& content)
+        {
+            static std::random_device seed;
+            path = std::filesystem::temp_directory_path() / std::format("vicius-test-{:016x}.bin",
+                std::uniform_int_distribution<uint64_t>{}(seed));
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!file)
+            {
+                throw std::runtime_error("Failed to write " + path.string());
+            }
+        }
+
+        TempFile(const TempFile&) = delete;
+        TempFile& operator=(const TempFile&) = delete;
+
+        ~TempFile()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+
+        [[nodiscard]] const std::filesystem::path& GetPath() const { return path; }
+    };
+}